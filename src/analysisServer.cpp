@@ -0,0 +1,320 @@
+#include "analysisServer.h"
+#include "uci.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <sstream>
+
+namespace AdiChess {
+
+struct AnalysisServer::Session {
+    explicit Session(int fd_) : fd{fd_}, board{std::make_unique<Board>()} {}
+    ~Session() { ::close(fd); }
+
+    // Lines from a worker and the poll loop may interleave, never their bytes
+    void send(std::string const &line) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::string data = line + "\n";
+        size_t written = 0;
+        while (written < data.size()) {
+            ssize_t n = ::send(fd, data.data() + written, data.size() - written,
+                               MSG_NOSIGNAL);
+            if (n <= 0) {
+                return;
+            }
+            written += n;
+        }
+    }
+
+    const int fd;
+    // Bytes received after the last complete line
+    std::string input;
+    std::unique_ptr<Board> board;
+    std::atomic<bool> closed{false};
+
+    // Guards the fields below, the board is only replaced while not busy
+    std::mutex mutex;
+    bool busy = false;
+    Search *search = nullptr;
+    // Stop received before the worker started the search
+    bool stopRequested = false;
+    int multiPV = 1;
+
+    std::mutex writeMutex;
+};
+
+AnalysisServer::AnalysisServer(Options const &options_)
+    : options{options_}, table{options_.hashMegabytes} {
+    for (int i = 0; i < std::max(options.workers, 1); ++i) {
+        workers.emplace_back(&AnalysisServer::work, this);
+    }
+}
+
+AnalysisServer::~AnalysisServer() {
+    for (auto &session : sessions) {
+        close(*session);
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        if (!options.socketPath.empty()) {
+            unlink(options.socketPath.c_str());
+        }
+    }
+    for (int fd : wakeFds) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+bool AnalysisServer::listen() {
+    if (pipe(wakeFds) != 0) {
+        return false;
+    }
+    if (!options.socketPath.empty()) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (options.socketPath.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        std::strcpy(address.sun_path, options.socketPath.c_str());
+        unlink(address.sun_path);
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0 ||
+            bind(listenFd, reinterpret_cast<sockaddr *>(&address),
+                 sizeof(address)) != 0) {
+            return false;
+        }
+    } else {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(options.port);
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        if (listenFd < 0 ||
+            setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse,
+                       sizeof(reuse)) != 0 ||
+            bind(listenFd, reinterpret_cast<sockaddr *>(&address),
+                 sizeof(address)) != 0) {
+            return false;
+        }
+        socklen_t length = sizeof(address);
+        getsockname(listenFd, reinterpret_cast<sockaddr *>(&address), &length);
+        boundPort = ntohs(address.sin_port);
+    }
+    running = ::listen(listenFd, SOMAXCONN) == 0;
+    return running;
+}
+
+void AnalysisServer::run() {
+    std::vector<pollfd> fds;
+    while (running) {
+        fds.clear();
+        fds.push_back({wakeFds[0], POLLIN, 0});
+        fds.push_back({listenFd, POLLIN, 0});
+        for (auto const &session : sessions) {
+            fds.push_back({session->fd, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            continue;
+        }
+        if (fds[1].revents & POLLIN) {
+            accept();
+        }
+        // Sessions accepted above are polled from the next round
+        std::vector<std::shared_ptr<Session>> open;
+        for (size_t i = 2; i < fds.size(); ++i) {
+            auto &session = sessions[i - 2];
+            if (!fds[i].revents || receive(session)) {
+                open.push_back(session);
+            } else {
+                close(*session);
+            }
+        }
+        open.insert(open.end(), sessions.begin() + (fds.size() - 2),
+                    sessions.end());
+        sessions = std::move(open);
+    }
+}
+
+void AnalysisServer::shutdown() {
+    running = false;
+    char wake = 0;
+    [[maybe_unused]] auto written = write(wakeFds[1], &wake, 1);
+}
+
+void AnalysisServer::accept() {
+    int fd = ::accept(listenFd, nullptr, nullptr);
+    if (fd >= 0) {
+        sessions.push_back(std::make_shared<Session>(fd));
+    }
+}
+
+bool AnalysisServer::receive(std::shared_ptr<Session> const &session) {
+    char buffer[4096];
+    ssize_t n = read(session->fd, buffer, sizeof(buffer));
+    if (n <= 0) {
+        return false;
+    }
+    session->input.append(buffer, n);
+    size_t end;
+    while ((end = session->input.find('\n')) != std::string::npos) {
+        std::string line = session->input.substr(0, end);
+        session->input.erase(0, end + 1);
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        handle(session, line);
+        if (session->closed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AnalysisServer::handle(std::shared_ptr<Session> const &session,
+                            std::string const &line) {
+    std::istringstream arguments(line);
+    std::string command;
+    if (!(arguments >> command)) {
+        return;
+    }
+
+    if (command == "isready") {
+        session->send("readyok");
+    } else if (command == "position") {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (session->busy) {
+            session->send("info string error search running");
+        } else if (auto board = UCI::parsePosition(arguments)) {
+            session->board = std::move(board);
+        } else {
+            session->send("info string error invalid position");
+        }
+    } else if (command == "setoption") {
+        std::string token, name;
+        int value = 0;
+        arguments >> token >> name >> token >> value;
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (name == "MultiPV" && value >= 1) {
+            session->multiPV = value;
+        } else {
+            session->send("info string error unknown option " + name);
+        }
+    } else if (command == "go") {
+        go(session, arguments);
+    } else if (command == "stop") {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (session->search) {
+            session->search->stop();
+        } else if (session->busy) {
+            session->stopRequested = true;
+        }
+    } else if (command == "ponderhit") {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        if (session->search) {
+            session->search->ponderHit();
+        }
+    } else if (command == "quit") {
+        session->closed = true;
+    } else {
+        session->send("info string error unknown command " + command);
+    }
+}
+
+void AnalysisServer::go(std::shared_ptr<Session> const &session,
+                        std::istream &arguments) {
+    std::lock_guard<std::mutex> lock(session->mutex);
+    if (session->busy) {
+        session->send("info string error search running");
+        return;
+    }
+    SearchLimits limits =
+        UCI::parseGo(arguments, session->board->getCurrentPlayer());
+    if (options.maxNodes) {
+        limits.nodes = std::min(limits.nodes, options.maxNodes);
+    }
+    if (options.maxTime) {
+        limits.time =
+            limits.time ? std::min(limits.time, options.maxTime) : options.maxTime;
+    }
+    session->busy = true;
+    session->stopRequested = false;
+    submit([this, session, limits] { analyse(session, limits); });
+}
+
+void AnalysisServer::analyse(std::shared_ptr<Session> const &session,
+                             SearchLimits limits) {
+    Board &board = *session->board;
+    const Side side = board.getCurrentPlayer();
+    Search search(board);
+    search.setTranspositionTable(&table);
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->search = &search;
+        search.setMultiPV(session->multiPV);
+        if (session->stopRequested || session->closed) {
+            search.stop();
+        }
+    }
+    search.search(limits, [&](SearchInfo const &info) {
+        session->send(UCI::formatInfo(info, side));
+    });
+
+    // Held while replying so the next command sees the search finished
+    std::lock_guard<std::mutex> lock(session->mutex);
+    session->search = nullptr;
+    session->send(UCI::formatBestMove(search, side));
+    session->busy = false;
+}
+
+void AnalysisServer::close(Session &session) {
+    session.closed = true;
+    std::lock_guard<std::mutex> lock(session.mutex);
+    if (session.search) {
+        session.search->stop();
+    }
+}
+
+void AnalysisServer::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        jobs.push_back(std::move(job));
+    }
+    jobReady.notify_one();
+}
+
+void AnalysisServer::work() {
+    std::unique_lock<std::mutex> lock(jobMutex);
+    const auto ready = [&] { return stopping || !jobs.empty(); };
+    while (true) {
+        // Woken by submit and by shutdown, the timeout only bounds each wait
+        while (!jobReady.wait_for(lock, std::chrono::hours(1), ready)) {
+        }
+        if (jobs.empty()) {
+            return;
+        }
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
+
+} // namespace AdiChess
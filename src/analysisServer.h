@@ -0,0 +1,89 @@
+#pragma once
+
+#include "search.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Long running analysis service. Clients connect over a Unix socket or TCP on
+// the loopback interface and speak a subset of UCI, one session per
+// connection:
+//
+//   position startpos|fen <fen> [moves <moves>]
+//   go [depth <plies>] [nodes <nodes>] [movetime <ms>]
+//   setoption name MultiPV value <lines>
+//   stop, isready, quit
+//
+// Every session has its own board. Searches run on a fixed pool of worker
+// threads, share one transposition table and stream their info lines back
+// before the bestmove.
+
+namespace AdiChess {
+
+class AnalysisServer {
+public:
+    struct Options {
+        // TCP port, 0 picks a free one
+        int port = 0;
+        // Listens on this Unix socket instead of TCP when set
+        std::string socketPath;
+        int workers = 1;
+        size_t hashMegabytes = 64;
+        // Caps on every search, 0 for none
+        uint64_t maxNodes = 0;
+        int64_t maxTime = 0;
+    };
+
+    explicit AnalysisServer(Options const &options_);
+    ~AnalysisServer();
+    AnalysisServer(AnalysisServer const &) = delete;
+    AnalysisServer &operator=(AnalysisServer const &) = delete;
+
+    // Binds the socket, false on failure
+    bool listen();
+    // TCP port bound by listen
+    int port() const { return boundPort; }
+    // Serves clients until shutdown is called
+    void run();
+    // Ends run, callable from any thread
+    void shutdown();
+
+private:
+    struct Session;
+
+    void accept();
+    // False once the session has ended
+    bool receive(std::shared_ptr<Session> const &session);
+    void handle(std::shared_ptr<Session> const &session,
+                std::string const &line);
+    void go(std::shared_ptr<Session> const &session, std::istream &arguments);
+    void analyse(std::shared_ptr<Session> const &session,
+                 SearchLimits limits);
+    void close(Session &session);
+    void submit(std::function<void()> job);
+    void work();
+
+    Options options;
+    TranspositionTable table;
+    int listenFd = -1;
+    int boundPort = 0;
+    // Written to by shutdown to wake the poll loop
+    int wakeFds[2] = {-1, -1};
+    std::atomic<bool> running{false};
+    std::vector<std::shared_ptr<Session>> sessions;
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    bool stopping = false;
+};
+
+} // namespace AdiChess
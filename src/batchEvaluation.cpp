@@ -0,0 +1,242 @@
+#include "batchEvaluation.h"
+#include "cpu.h"
+#include "evaluationParameters.h"
+#include "slidingAttacks.h"
+
+#include <algorithm>
+
+#if HAS_TARGETS
+#include <immintrin.h>
+#endif
+
+namespace Evaluation {
+
+namespace {
+
+using MoveGeneration::shift;
+
+// Positions evaluated together, sized so a block's attack maps stay in L1
+constexpr size_t BLOCK_SIZE = 64;
+
+constexpr uint64_t notFileA = ~static_cast<uint64_t>(MoveGeneration::fileA);
+constexpr uint64_t notFileH = ~static_cast<uint64_t>(MoveGeneration::fileH);
+constexpr uint64_t notFilesAB = ~static_cast<uint64_t>(MoveGeneration::fileA |
+                                                       MoveGeneration::fileB);
+constexpr uint64_t notFilesGH = ~static_cast<uint64_t>(MoveGeneration::fileG |
+                                                       MoveGeneration::fileH);
+
+// Knight attacks of every knight at once. West is towards the A file.
+uint64_t knightAttacks(uint64_t knights) {
+    return ((shift<17>(knights) | shift<-15>(knights)) & notFileH) |
+           ((shift<15>(knights) | shift<-17>(knights)) & notFileA) |
+           ((shift<10>(knights) | shift<-6>(knights)) & notFilesGH) |
+           ((shift<6>(knights) | shift<-10>(knights)) & notFilesAB);
+}
+
+uint64_t pawnAttacks(uint64_t pawns, int side) {
+    return side == Side::W
+               ? (shift<9>(pawns) & notFileH) | (shift<7>(pawns) & notFileA)
+               : (shift<-7>(pawns) & notFileH) | (shift<-9>(pawns) & notFileA);
+}
+
+// Counts the bits of count bitboards into counts
+KERNEL void popCountKernel(const uint64_t *bitboards, size_t count,
+                           int *counts) {
+    for (size_t i = 0; i < count; ++i) {
+        counts[i] = Utility::popCnt(bitboards[i]);
+    }
+}
+
+void popCountBaseline(const uint64_t *bitboards, size_t count, int *counts) {
+    popCountKernel(bitboards, count, counts);
+}
+
+#if HAS_TARGETS
+
+TARGET_POPCNT void popCountPopcnt(const uint64_t *bitboards, size_t count,
+                                  int *counts) {
+    popCountKernel(bitboards, count, counts);
+}
+
+// Nibble lookup popcount over four bitboards per register
+TARGET_AVX2 void popCountAvx2(const uint64_t *bitboards, size_t count,
+                              int *counts) {
+    size_t i = 0;
+    const __m256i lookup =
+        _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1,
+                         1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0F);
+    for (; i + 4 <= count; i += 4) {
+        __m256i values = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(bitboards + i));
+        __m256i low = _mm256_and_si256(values, lowMask);
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(values, 4), lowMask);
+        __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                        _mm256_shuffle_epi8(lookup, high));
+        __m256i sums = _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+        counts[i] = _mm256_extract_epi64(sums, 0);
+        counts[i + 1] = _mm256_extract_epi64(sums, 1);
+        counts[i + 2] = _mm256_extract_epi64(sums, 2);
+        counts[i + 3] = _mm256_extract_epi64(sums, 3);
+    }
+    popCountKernel(bitboards + i, count - i, counts + i);
+}
+
+// BMI2 adds nothing to counting bits, it shares the POPCNT variant
+void (*const POP_COUNT[AdiChess::Cpu::NUM_TARGETS])(const uint64_t *, size_t,
+                                                    int *) = {
+    popCountBaseline, popCountPopcnt, popCountPopcnt, popCountAvx2};
+
+#else
+
+void (*const POP_COUNT[AdiChess::Cpu::NUM_TARGETS])(const uint64_t *, size_t,
+                                                    int *) = {
+    popCountBaseline, popCountBaseline, popCountBaseline, popCountBaseline};
+
+#endif
+
+void popCount(const uint64_t *bitboards, size_t count, int *counts) {
+    POP_COUNT[AdiChess::Cpu::target()](bitboards, count, counts);
+}
+
+// Attacked squares not occupied by the attacking side for every piece kind of
+// one position, as computed by Board::computeAttackInfo
+void mobilityMaps(PositionBatch const &batch, size_t index,
+                  uint64_t (&maps)[Piece::Type::NUM_PIECES][Side::NUM_SIDES]) {
+    uint64_t pieces[Piece::Type::NUM_PIECES][Side::NUM_SIDES];
+    uint64_t sides[Side::NUM_SIDES] = {0, 0};
+    for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+        for (int side = Side::W; side < Side::NUM_SIDES; ++side) {
+            pieces[type][side] = batch.pieces[type][side][index];
+            sides[side] |= pieces[type][side];
+        }
+    }
+    const uint64_t occupied = sides[Side::W] | sides[Side::B];
+
+    for (int side = Side::W; side < Side::NUM_SIDES; ++side) {
+        // Opposing king is transparent to sliding attacks
+        uint64_t empty = ~occupied | pieces[Piece::Type::K][side ^ 1];
+        auto sliding = MoveGeneration::getSlidingAttacks(
+            pieces[Piece::Type::R][side], pieces[Piece::Type::B][side], empty);
+        auto queens = MoveGeneration::getSlidingAttacks(
+            pieces[Piece::Type::Q][side], pieces[Piece::Type::Q][side], empty);
+        uint64_t king = pieces[Piece::Type::K][side];
+
+        const uint64_t own = ~sides[side];
+        maps[Piece::Type::K][side] =
+            (king ? MoveGeneration::kingAttacks[Utility::bitScanForward(king)]
+                  : 0) &
+            own;
+        maps[Piece::Type::Q][side] =
+            (queens.rookLike | queens.bishopLike) & own;
+        maps[Piece::Type::R][side] = sliding.rookLike & own;
+        maps[Piece::Type::B][side] = sliding.bishopLike & own;
+        maps[Piece::Type::N][side] =
+            knightAttacks(pieces[Piece::Type::N][side]) & own;
+        maps[Piece::Type::P][side] =
+            pawnAttacks(pieces[Piece::Type::P][side], side) & own;
+    }
+}
+
+void evaluateBlock(PositionBatch const &batch, size_t begin, size_t count,
+                   int *scores) {
+    // Attack maps of the block laid out by piece kind, then position
+    uint64_t mobility[Piece::Type::NUM_PIECES][Side::NUM_SIDES][BLOCK_SIZE];
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t maps[Piece::Type::NUM_PIECES][Side::NUM_SIDES];
+        mobilityMaps(batch, begin + i, maps);
+        for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+            mobility[type][Side::W][i] = maps[type][Side::W];
+            mobility[type][Side::B][i] = maps[type][Side::B];
+        }
+    }
+
+    // Opening and endgame scores and the phase from white's point of view
+    int opening[BLOCK_SIZE] = {0};
+    int endgame[BLOCK_SIZE] = {0};
+    int phases[BLOCK_SIZE];
+    static constexpr int TOTAL_PHASE_SUM =
+        PIECE_PHASES[Piece::Type::P] * 16 + PIECE_PHASES[Piece::Type::N] * 4 +
+        PIECE_PHASES[Piece::Type::B] * 4 + PIECE_PHASES[Piece::Type::R] * 4 +
+        PIECE_PHASES[Piece::Type::Q] * 2;
+    std::fill(phases, phases + count, TOTAL_PHASE_SUM);
+
+    int pieceCounts[Side::NUM_SIDES][BLOCK_SIZE];
+    int mobilityCounts[Side::NUM_SIDES][BLOCK_SIZE];
+    for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+        for (int side = Side::W; side < Side::NUM_SIDES; ++side) {
+            popCount(batch.pieces[type][side].data() + begin, count,
+                     pieceCounts[side]);
+            popCount(mobility[type][side], count, mobilityCounts[side]);
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            int material = pieceCounts[Side::W][i] - pieceCounts[Side::B][i];
+            int moves = mobilityCounts[Side::W][i] - mobilityCounts[Side::B][i];
+            opening[i] += MATERIAL_VALUES[Phase::OPENING][type] * material +
+                          MOBILITY_VALUES[Phase::OPENING][type] * moves;
+            endgame[i] += MATERIAL_VALUES[Phase::ENDGAME][type] * material +
+                          MOBILITY_VALUES[Phase::ENDGAME][type] * moves;
+            phases[i] -= PIECE_PHASES[type] *
+                         (pieceCounts[Side::W][i] + pieceCounts[Side::B][i]);
+        }
+
+        if (type == Piece::Type::B) {
+            for (size_t i = 0; i < count; ++i) {
+                int pairs = (pieceCounts[Side::W][i] == 2) -
+                            (pieceCounts[Side::B][i] == 2);
+                opening[i] += BISHOP_PAIR_VALUES[Phase::OPENING] * pairs;
+                endgame[i] += BISHOP_PAIR_VALUES[Phase::ENDGAME] * pairs;
+            }
+        }
+    }
+
+    const uint8_t *sideToMove = batch.sideToMove.data() + begin;
+    for (size_t i = 0; i < count; ++i) {
+        int phase = (phases[i] * 256 + (TOTAL_PHASE_SUM / 2)) / TOTAL_PHASE_SUM;
+        int sign = sideToMove[i] == Side::W ? 1 : -1;
+        scores[i] =
+            (sign * opening[i] * (256 - phase) + sign * endgame[i] * phase) /
+            256;
+    }
+}
+
+} // namespace
+
+void PositionBatch::add(Board const &board) {
+    for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+        for (Side side : {Side::W, Side::B}) {
+            pieces[type][side].push_back(
+                board.getPositions(static_cast<Piece::Type>(type), side));
+        }
+    }
+    sideToMove.push_back(board.getCurrentPlayer());
+}
+
+void PositionBatch::clear() {
+    for (auto &bitboards : pieces) {
+        bitboards[Side::W].clear();
+        bitboards[Side::B].clear();
+    }
+    sideToMove.clear();
+}
+
+void evaluate(PositionBatch const &batch, int *scores) {
+    for (size_t begin = 0; begin < batch.size(); begin += BLOCK_SIZE) {
+        evaluateBlock(batch, begin, std::min(BLOCK_SIZE, batch.size() - begin),
+                      scores + begin);
+    }
+}
+
+std::vector<int> evaluate(PositionBatch const &batch) {
+    std::vector<int> scores(batch.size());
+    evaluate(batch, scores.data());
+    return scores;
+}
+
+const char *batchEvaluationImplementation() {
+    return AdiChess::Cpu::target() == AdiChess::Cpu::AVX2 ? "AVX2 batch"
+                                                          : "Scalar batch";
+}
+
+} // namespace Evaluation
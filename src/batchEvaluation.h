@@ -0,0 +1,30 @@
+#pragma once
+
+#include "evaluation.h"
+
+#include <vector>
+
+// Evaluation of many positions at once. Positions are stored as structure of
+// arrays, one bitboard array per piece kind, so every stage of the evaluation
+// runs as a loop across positions. Scores match Evaluation::evaluate.
+
+namespace Evaluation {
+
+struct PositionBatch {
+    void add(Board const &board);
+    void clear();
+    size_t size() const { return sideToMove.size(); }
+
+    std::vector<uint64_t> pieces[Piece::Type::NUM_PIECES][Side::NUM_SIDES];
+    std::vector<uint8_t> sideToMove;
+};
+
+// Writes a score for every position in the batch to scores, from the side to
+// move's point of view
+void evaluate(PositionBatch const &batch, int *scores);
+std::vector<int> evaluate(PositionBatch const &batch);
+
+// Name of the popcount implementation selected for this CPU
+const char *batchEvaluationImplementation();
+
+} // namespace Evaluation
@@ -0,0 +1,65 @@
+#include "bench.h"
+#include "cpu.h"
+#include "perfCounters.h"
+#include "perft.h"
+#include "search.h"
+
+#include <chrono>
+
+namespace AdiChess::Bench {
+
+namespace {
+
+const char *POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 8",
+    "2r3k1/5pp1/p3p2p/1p1rP3/3P4/P4P2/1P3KPP/2R1R3 b - - 0 27",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+    "6k1/5p1p/6p1/8/8/6P1/5PKP/4R3 w - - 0 1",
+    "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+};
+
+} // namespace
+
+Result run(int depth, std::ostream &output) {
+    Result result;
+    TranspositionTable table(16);
+    SearchLimits limits;
+    limits.depth = depth;
+    Profile::enable();
+    auto start = std::chrono::steady_clock::now();
+    int index = 0;
+    for (auto fen : POSITIONS) {
+        Board board(fen);
+        Search search(board);
+        search.setTranspositionTable(&table);
+        search.search(limits);
+        result.nodes += search.getNodes();
+        output << "Position " << ++index << ": "
+               << moveToString(search.getPrincipalMove(),
+                               board.getCurrentPlayer())
+               << " nodes " << search.getNodes() << "\n";
+    }
+    result.milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+
+    output << "Nodes: " << result.nodes << "\n"
+           << "Time (ms): " << result.milliseconds << "\n"
+           << "Nodes/s: " << result.nodesPerSecond() << "\n"
+           << "CPU target: " << Cpu::name(Cpu::target()) << std::endl;
+    Profile::report(output);
+    return result;
+}
+
+std::vector<const char *> positions() {
+    return {std::begin(POSITIONS), std::end(POSITIONS)};
+}
+
+} // namespace AdiChess::Bench
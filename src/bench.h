@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Fixed depth searches of built-in positions with one thread and a fresh
+// transposition table. The node total is a signature of the search: it only
+// changes when the search does, so a build that keeps the nodes and raises
+// the nodes per second is a pure speed up.
+
+namespace AdiChess::Bench {
+
+constexpr int DEFAULT_DEPTH = 5;
+
+struct Result {
+    uint64_t nodes = 0;
+    int64_t milliseconds = 0;
+    uint64_t nodesPerSecond() const {
+        return nodes * 1000 / (milliseconds ? milliseconds : 1);
+    }
+};
+
+// Writes one line per position and a summary to output
+Result run(int depth, std::ostream &output);
+
+// FENs of the bench positions
+std::vector<const char *> positions();
+
+} // namespace AdiChess::Bench
@@ -1,18 +1,91 @@
 #include "board.h"
 #include "moveGenerator.h"
+#include "perfCounters.h"
+#include "slidingAttacks.h"
+#include "zobrist.h"
 #include <algorithm>
+#include <array>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 namespace AdiChess {
 
+namespace {
+
+// Cuckoo tables of the key change made by every reversible move of a non-pawn
+// piece between two squares, used to spot moves returning to an earlier
+// position without generating them
+constexpr int CUCKOO_SIZE = 8192;
+std::array<uint64_t, CUCKOO_SIZE> cuckooKeys;
+std::array<std::pair<uint8_t, uint8_t>, CUCKOO_SIZE> cuckooMoves;
+
+constexpr int cuckooHash1(uint64_t key) { return key & (CUCKOO_SIZE - 1); }
+constexpr int cuckooHash2(uint64_t key) {
+    return (key >> 16) & (CUCKOO_SIZE - 1);
+}
+
+void initCuckooTables() {
+    for (int type = Piece::Type::K; type < Piece::Type::P; ++type) {
+        for (int side = Side::W; side < Side::NUM_SIDES; ++side) {
+            for (int from = 0; from < 64; ++from) {
+                uint64_t targets;
+                if (type == Piece::Type::K) {
+                    targets = MoveGeneration::kingAttacks[from];
+                } else if (type == Piece::Type::N) {
+                    targets = MoveGeneration::knightAttacks[from];
+                } else {
+                    uint64_t slider = 1ULL << from;
+                    auto attacks = MoveGeneration::getSlidingAttacks(
+                        type != Piece::Type::B ? slider : 0,
+                        type != Piece::Type::R ? slider : 0, ~0ULL);
+                    targets = attacks.rookLike | attacks.bishopLike;
+                }
+
+                for (int to = from + 1; to < 64; ++to) {
+                    if (!(targets & (1ULL << to))) {
+                        continue;
+                    }
+                    uint64_t key = ZOBRIST.pieces[type][side][from] ^
+                                   ZOBRIST.pieces[type][side][to] ^
+                                   ZOBRIST.side;
+                    std::pair<uint8_t, uint8_t> move(from, to);
+                    // Evict and reinsert until an empty slot is found
+                    int slot = cuckooHash1(key);
+                    while (true) {
+                        std::swap(cuckooKeys[slot], key);
+                        std::swap(cuckooMoves[slot], move);
+                        if (!key) {
+                            break;
+                        }
+                        slot = slot == cuckooHash1(key) ? cuckooHash2(key)
+                                                        : cuckooHash1(key);
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
 Board::Board(std::string const &fenString) {
-    parseFenString(fenString);
     MoveGeneration::init();
+    static std::once_flag cuckooInitialised;
+    std::call_once(cuckooInitialised, initCuckooTables);
+    parseFenString(fenString);
 }
 
 Board &Board::makeMove(Move const &move) {
+    return currentPlayer == Side::W ? makeMove<Side::W>(move)
+                                    : makeMove<Side::B>(move);
+}
+
+template <Side Us> Board &Board::makeMove(Move const &move) {
+    PROFILE_REGION(MAKE_UNMAKE);
+    assert(currentPlayer == Us);
 
+    keyHistory.push_back(getKey());
     // Clone irreversible state
     updateState();
 
@@ -28,63 +101,70 @@ Board &Board::makeMove(Move const &move) {
 
     // Update en passant target square if double pawn push
     if (flag == Move::DOUBLE_PAWN_PUSH) {
-        if (currentPlayer == Side::W) {
-            state->enPassantTarget = target - 8;
-        } else {
-            state->enPassantTarget = target + 8;
-        }
+        state->enPassantTarget = Us == Side::W ? target - 8 : target + 8;
     } else {
         state->enPassantTarget = -1;
     }
 
     if (move.isCapture()) {
-        makeCapture(move);
+        makeCapture<Us>(move);
     } else if (flag == Move::KING_CASTLE) {
-        makeKingSideCastle();
+        makeKingSideCastle<Us>();
     } else if (flag == Move::QUEEN_CASTLE) {
-        makeQueenSideCastle();
+        makeQueenSideCastle<Us>();
     } else {
         movePiece(source, target);
     }
 
-    makePromotion(move);
+    makePromotion<Us>(move);
 
-    if (currentPlayer == Side::B) {
+    if (Us == Side::B) {
         ++(state->fullMoveNumber);
     }
-    std::swap(currentPlayer, opponent);
-    assert(currentPlayer < Side::NUM_SIDES);
+    currentPlayer = ~Us;
+    opponent = Us;
+    if (prefetcher) {
+        prefetcher->prefetch(getKey());
+    }
     return *this;
 }
 
 // Must be move corresponding to the current state
 void Board::unmakeMove(Move const &move) {
+    opponent == Side::W ? unmakeMove<Side::W>(move)
+                        : unmakeMove<Side::B>(move);
+}
+
+// Us is the side that made the move being rolled back
+template <Side Us> void Board::unmakeMove(Move const &move) {
+    PROFILE_REGION(MAKE_UNMAKE);
     auto flag = move.getFlag();
     uint64_t toPosition = move.getTo();
     uint64_t fromPosition = move.getFrom();
-    std::swap(currentPlayer, opponent);
-    assert(currentPlayer <= 1 && currentPlayer >= 0);
+    assert(opponent == Us);
+    currentPlayer = Us;
+    opponent = ~Us;
     // Rollback promotions on bitboards
     if (move.isPromotion()) {
         switch (flag) {
         case Move::BISHOP_PROMO_CAPTURE:
         case Move::BISHOP_PROMOTION:
-            clearPiece(toPosition, Piece(Piece::Type::B, currentPlayer));
+            clearPiece(toPosition, Piece(Piece::Type::B, Us));
             break;
         case Move::ROOK_PROMO_CAPTURE:
         case Move::ROOK_PROMOTION:
-            clearPiece(toPosition, Piece(Piece::Type::R, currentPlayer));
+            clearPiece(toPosition, Piece(Piece::Type::R, Us));
             break;
         case Move::KNIGHT_PROMO_CAPTURE:
         case Move::KNIGHT_PROMOTION:
-            clearPiece(toPosition, Piece(Piece::Type::N, currentPlayer));
+            clearPiece(toPosition, Piece(Piece::Type::N, Us));
             break;
         case Move::QUEEN_PROMO_CAPTURE:
         case Move::QUEEN_PROMOTION:
-            clearPiece(toPosition, Piece(Piece::Type::Q, currentPlayer));
+            clearPiece(toPosition, Piece(Piece::Type::Q, Us));
             break;
         }
-        (*this)(fromPosition, Piece(Piece::Type::P, currentPlayer));
+        (*this)(fromPosition, Piece(Piece::Type::P, Us));
     }
 
     // Rollback captures on bitboards
@@ -95,17 +175,19 @@ void Board::unmakeMove(Move const &move) {
             (*this)(fromPosition, movedPiece);
         }
 
-        uint64_t restorePosition = flag == Move::EN_PASSANT_CAPTURE
-                                       ? state->enPassantTarget
-                                       : toPosition;
+        uint64_t restorePosition = toPosition;
+        if (flag == Move::EN_PASSANT_CAPTURE) {
+            restorePosition =
+                Us == Side::W ? toPosition - 8 : toPosition + 8;
+        }
         (*this)(restorePosition, state->capturedPiece);
     }
 
     // Rollback castling move on bitboards
     if (flag == Move::KING_CASTLE) {
-        unmakeKingSideCastle();
+        unmakeKingSideCastle<Us>();
     } else if (flag == Move::QUEEN_CASTLE) {
-        unmakeQueenSideCastle();
+        unmakeQueenSideCastle<Us>();
     }
 
     // Rollback null moves
@@ -117,165 +199,298 @@ void Board::unmakeMove(Move const &move) {
     assert(state != nullptr);
     // Reload old state information
     state = state->prev;
+    keyHistory.pop_back();
 }
 
 bool Board::legalMove(Move const &move) {
-    const uint64_t friendlyPositions = getPositions(currentPlayer);
-    uint64_t oppositionPositions = getPositions(opponent);
-    uint64_t oppositionAttacks = 0;
-    while (oppositionPositions) {
-        uint64_t pos = Utility::bitScanPop(oppositionPositions);
-        auto piece = (*this)(pos);
-        // Kingless so we get attack rays "through" king as well, evasion of
-        // sliding attacks by moving away from attacker along sliding path
-        oppositionAttacks |= getAttackMap(
-            pos, piece.type, getPositions(opponent),
-            friendlyPositions & ~bitboards[Piece::Type::K][currentPlayer],
-            piece.side);
-        if (piece.type == Piece::Type::P) {
-            oppositionAttacks |= MoveGeneration::pawnAttacks[opponent][pos];
-        }
-    }
-
-    return legalMove(move, oppositionAttacks, getPositions(opponent),
-                     friendlyPositions);
+    return currentPlayer == Side::W ? legalMove<Side::W>(move)
+                                    : legalMove<Side::B>(move);
 }
 
-// oppositionAttacks has attacks including pawn attacked squares and excluding
-// king (so if king moves back along ray or toward queen that is not legal)
-bool Board::legalMove(Move const &move, uint64_t oppositionAttacks,
-                      uint64_t oppositionPositions,
-                      uint64_t friendlyPositions) {
+template <Side Us> bool Board::legalMove(Move const &move) {
+    PROFILE_REGION(LEGALITY);
+    // King and the squares it passes through must not be attacked
+    constexpr uint64_t kingSideCastlePath =
+        Us == Side::W ? 0xE : 0x0E00000000000000;
+    constexpr uint64_t queenSideCastlePath =
+        Us == Side::W ? 0x38 : 0x3800000000000000;
 
-    uint64_t kingPosition = bitboards[Piece::Type::K][currentPlayer];
+    assert(currentPlayer == Us);
+    AttackInfo const &attacks = getAttackInfo();
+    const uint64_t oppositionAttacks = attacks.attacked[~Us];
 
-    auto flag = move.getFlag();
-
-    switch (flag) {
+    switch (move.getFlag()) {
     case Move::EN_PASSANT_CAPTURE:
-        return legalEnPassantMove(move);
+        return legalEnPassantMove<Us>(move);
     case Move::KING_CASTLE:
-        return !(oppositionAttacks &
-                 (currentPlayer == Side::W ? 0x6 : 0x0600000000000000));
+        return !(oppositionAttacks & kingSideCastlePath);
     case Move::QUEEN_CASTLE:
-        return !(oppositionAttacks &
-                 (currentPlayer == Side::W ? 0x38 : 0x3800000000000000));
+        return !(oppositionAttacks & queenSideCastlePath);
     }
 
     uint64_t fromPosition = 1ULL << move.getFrom();
     uint64_t toPosition = 1ULL << move.getTo();
+    uint64_t kingPosition = bitboards[Piece::Type::K][Us];
 
-    assert((fromPosition & getPositions(currentPlayer)) &&
-           fromPosition != toPosition);
+    assert((fromPosition & getPositions(Us)) && fromPosition != toPosition);
 
+    // A king move is legal if and only if it does not move into check.
     if (kingPosition == fromPosition) {
-        // A king move is legal if and only if it does not move into check.
         return !(oppositionAttacks & toPosition);
-    } else {
-        // Compute checking pieces
-        uint64_t checkingPieces = 0;
-        const uint64_t oppositions = oppositionPositions;
-        const uint64_t friendlies = friendlyPositions;
-
-        while (oppositionPositions) {
-            uint64_t pos = Utility::bitScanPop(oppositionPositions);
-            uint64_t attacks = getAttackMap(pos, (*this)(pos).type, oppositions,
-                                            friendlies, opponent);
-            if (attacks & kingPosition) {
-                // Piece gives check
-                checkingPieces |= 1ULL << pos;
-            }
-        }
+    }
 
-        int checkCount = Utility::popCnt(checkingPieces);
+    uint64_t king = Utility::bitScanForward(kingPosition);
 
+    if (attacks.checkers) {
         // If in double check only a king move would have been valid
-        if (checkCount >= 2) {
+        if (attacks.checkers & (attacks.checkers - 1)) {
+            return false;
+        }
+        // One check, non king move. Legal move must capture the checking
+        // piece or block it if it is a sliding piece.
+        uint64_t checker = Utility::bitScanForward(attacks.checkers);
+        if (!(toPosition & (attacks.checkers |
+                            MoveGeneration::squaresBetween[king][checker]))) {
             return false;
         }
+    }
 
-        if (checkCount == 1) {
-            uint64_t checkingPiecePosition =
-                Utility::bitScanForward(checkingPieces);
-            uint64_t updatedFriendlies =
-                (friendlies ^ fromPosition) | toPosition;
-
-            // One check, non king move. Legal move must be to capture or if
-            // sliding piece attack block the piece giving check
-            if (toPosition == checkingPieces) {
-                return !getAbsolutePinRay(oppositions ^ checkingPieces,
-                                          fromPosition);
-            } else if ((getAttackMap(checkingPiecePosition,
-                                     (*this)(checkingPiecePosition).type,
-                                     oppositions, updatedFriendlies, opponent) &
-                        kingPosition) == 0) {
-                return !getAbsolutePinRay(oppositions ^ checkingPieces,
-                                          fromPosition);
-            } else {
-                return false;
-            }
+    // A pinned piece may only move along the ray between king and pinner
+    if (attacks.pinned & fromPosition) {
+        return toPosition & MoveGeneration::rayThrough[king][move.getFrom()];
+    }
 
-        } else {
-            uint64_t attackRay = getAbsolutePinRay(oppositions, fromPosition);
-            return !attackRay || (attackRay & toPosition);
-        }
+    return true;
+}
+
+AttackInfo const &Board::getAttackInfo() const {
+    if (!state->attacks.valid) {
+        computeAttackInfo(state->attacks);
     }
+    return state->attacks;
 }
 
-// Returns attack ray or 0 if not present
-uint64_t Board::getAbsolutePinRay(uint64_t sourceAttackPositions,
-                                  uint64_t defenderPosition) {
-    uint64_t friendlies = getPositions(currentPlayer) ^ defenderPosition;
-    uint64_t attackers = getPositions(opponent);
-    uint64_t kingPosition = bitboards[Piece::Type::K][currentPlayer];
-    while (sourceAttackPositions) {
-        uint64_t pos = Utility::bitScanPop(sourceAttackPositions);
-        Piece::Type pt = (*this)(pos).type;
-        uint64_t attacks =
-            getAttackMap(pos, pt, attackers, friendlies, opponent);
-        if (attacks & kingPosition) {
-            uint64_t attackRay =
-                getAttackMap(Utility::bitScanForward(kingPosition), pt,
-                             attackers, friendlies, opponent) &
-                attacks;
-            return attackRay | (1ULL << pos);
+void Board::computeAttackInfo(AttackInfo &attacks) const {
+    const uint64_t occupied = aggregateBitboards[Side::W] |
+                              aggregateBitboards[Side::B];
+    const uint64_t king = bitboards[Piece::Type::K][currentPlayer];
+
+    attacks = AttackInfo();
+    for (int side = Side::W; side < Side::NUM_SIDES; ++side) {
+        auto (&pieceAttacks)[Piece::Type::NUM_PIECES][Side::NUM_SIDES] =
+            attacks.pieceAttacks;
+
+        // Opposing king is transparent to sliding attacks
+        uint64_t empty =
+            ~occupied | bitboards[Piece::Type::K][~static_cast<Side>(side)];
+
+        // Sliders are filled set-wise, queens separately to keep their
+        // attacks apart from rooks and bishops
+        auto sliding = MoveGeneration::getSlidingAttacks(
+            bitboards[Piece::Type::R][side], bitboards[Piece::Type::B][side],
+            empty);
+        auto queens = MoveGeneration::getSlidingAttacks(
+            bitboards[Piece::Type::Q][side], bitboards[Piece::Type::Q][side],
+            empty);
+        pieceAttacks[Piece::Type::R][side] = sliding.rookLike;
+        pieceAttacks[Piece::Type::B][side] = sliding.bishopLike;
+        pieceAttacks[Piece::Type::Q][side] = queens.rookLike | queens.bishopLike;
+
+        uint64_t kings = bitboards[Piece::Type::K][side];
+        if (kings) {
+            pieceAttacks[Piece::Type::K][side] =
+                MoveGeneration::kingAttacks[Utility::bitScanForward(kings)];
+        }
+
+        uint64_t knights = bitboards[Piece::Type::N][side];
+        while (knights) {
+            pieceAttacks[Piece::Type::N][side] |=
+                MoveGeneration::knightAttacks[Utility::bitScanPop(knights)];
+        }
+
+        uint64_t pawns = bitboards[Piece::Type::P][side];
+        while (pawns) {
+            pieceAttacks[Piece::Type::P][side] |=
+                MoveGeneration::pawnAttacks[side][Utility::bitScanPop(pawns)];
+        }
+
+        for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+            attacks.attacked[side] |= pieceAttacks[type][side];
         }
     }
 
-    return 0;
+    // Checking pieces are found by looking outwards from the king
+    uint64_t kingPosition = Utility::bitScanForward(king);
+    uint64_t rookSliders = bitboards[Piece::Type::R][opponent] |
+                           bitboards[Piece::Type::Q][opponent];
+    uint64_t bishopSliders = bitboards[Piece::Type::B][opponent] |
+                             bitboards[Piece::Type::Q][opponent];
+    attacks.checkers =
+        (getAttackMap(kingPosition, Piece::Type::R, 0, occupied,
+                      currentPlayer) &
+         rookSliders) |
+        (getAttackMap(kingPosition, Piece::Type::B, 0, occupied,
+                      currentPlayer) &
+         bishopSliders) |
+        (MoveGeneration::knightAttacks[kingPosition] &
+         bitboards[Piece::Type::N][opponent]) |
+        (MoveGeneration::pawnAttacks[currentPlayer][kingPosition] &
+         bitboards[Piece::Type::P][opponent]);
+
+    // A friendly piece is pinned if it is the only piece between the king and
+    // an opposition slider moving along that line
+    uint64_t pinners =
+        ((MoveGeneration::rayAttacks[MoveGeneration::N][kingPosition] |
+          MoveGeneration::rayAttacks[MoveGeneration::E][kingPosition] |
+          MoveGeneration::rayAttacks[MoveGeneration::S][kingPosition] |
+          MoveGeneration::rayAttacks[MoveGeneration::W][kingPosition]) &
+         rookSliders) |
+        ((MoveGeneration::rayAttacks[MoveGeneration::NE][kingPosition] |
+          MoveGeneration::rayAttacks[MoveGeneration::SE][kingPosition] |
+          MoveGeneration::rayAttacks[MoveGeneration::SW][kingPosition] |
+          MoveGeneration::rayAttacks[MoveGeneration::NW][kingPosition]) &
+         bishopSliders);
+    while (pinners) {
+        uint64_t pinner = Utility::bitScanPop(pinners);
+        uint64_t between =
+            MoveGeneration::squaresBetween[kingPosition][pinner] & occupied;
+        if (between && !(between & (between - 1)) &&
+            (between & aggregateBitboards[currentPlayer])) {
+            attacks.pinned |= between;
+        }
+    }
+
+    attacks.valid = true;
 }
 
-bool Board::inCheck(Side const &side) const {
-    Side other = side == Side::W ? Side::B : Side::W;
-    uint64_t enemyPos = getPositions(side);
-    for (int piece = 0; piece < Piece::Type::NUM_PIECES; ++piece) {
-        auto type = static_cast<Piece::Type>(piece);
-
-        // Positions of side checking
-        uint64_t positions = getPositions(type, other);
-
-        // Friendly is side attacking (other)
-        uint64_t friendly = getPositions(other);
-
-        while (positions) {
-            uint64_t position = Utility::bitScanPop(positions);
-            uint64_t attack =
-                getAttackMap(position, type, friendly, enemyPos, other);
-            if (attack & bitboards[Piece::Type::K][side]) {
-                return true;
-            }
+CheckInfo const &Board::getCheckInfo() const {
+    if (!state->checks.valid) {
+        computeCheckInfo(state->checks);
+    }
+    return state->checks;
+}
+
+void Board::computeCheckInfo(CheckInfo &checks) const {
+    const uint64_t occupied = aggregateBitboards[Side::W] |
+                              aggregateBitboards[Side::B];
+    const uint64_t king = Utility::bitScanForward(
+        bitboards[Piece::Type::K][opponent]);
+
+    checks = CheckInfo();
+    checks.kingPosition = king;
+    // Attacks are symmetric, a piece checks from where it would be attacked
+    // by the same piece on the king's position
+    checks.checkSquares[Piece::Type::P] =
+        MoveGeneration::pawnAttacks[opponent][king];
+    checks.checkSquares[Piece::Type::N] = MoveGeneration::knightAttacks[king];
+    checks.checkSquares[Piece::Type::B] =
+        getAttackMap(king, Piece::Type::B, 0, occupied, opponent);
+    checks.checkSquares[Piece::Type::R] =
+        getAttackMap(king, Piece::Type::R, 0, occupied, opponent);
+    checks.checkSquares[Piece::Type::Q] = checks.checkSquares[Piece::Type::B] |
+                                          checks.checkSquares[Piece::Type::R];
+
+    // Our sliders lined up with the king behind exactly one of our pieces
+    const uint64_t rookSliders = bitboards[Piece::Type::R][currentPlayer] |
+                                 bitboards[Piece::Type::Q][currentPlayer];
+    const uint64_t bishopSliders = bitboards[Piece::Type::B][currentPlayer] |
+                                   bitboards[Piece::Type::Q][currentPlayer];
+    uint64_t sliders =
+        ((MoveGeneration::rayAttacks[MoveGeneration::N][king] |
+          MoveGeneration::rayAttacks[MoveGeneration::E][king] |
+          MoveGeneration::rayAttacks[MoveGeneration::S][king] |
+          MoveGeneration::rayAttacks[MoveGeneration::W][king]) &
+         rookSliders) |
+        ((MoveGeneration::rayAttacks[MoveGeneration::NE][king] |
+          MoveGeneration::rayAttacks[MoveGeneration::SE][king] |
+          MoveGeneration::rayAttacks[MoveGeneration::SW][king] |
+          MoveGeneration::rayAttacks[MoveGeneration::NW][king]) &
+         bishopSliders);
+    while (sliders) {
+        uint64_t slider = Utility::bitScanPop(sliders);
+        uint64_t between =
+            MoveGeneration::squaresBetween[king][slider] & occupied;
+        if (between && !(between & (between - 1)) &&
+            (between & aggregateBitboards[currentPlayer])) {
+            checks.discoverers |= between;
+        }
+    }
+    checks.valid = true;
+}
+
+bool Board::givesCheck(Move const &move) const {
+    CheckInfo const &checks = getCheckInfo();
+    const uint64_t from = move.getFrom();
+    const uint64_t to = move.getTo();
+    const uint64_t flag = move.getFlag();
+    const uint64_t king = checks.kingPosition;
+
+    if (flag != Move::KING_CASTLE && flag != Move::QUEEN_CASTLE) {
+        Piece::Type type = Piece::Type::P;
+        while (!Utility::checkBit(bitboards[type][currentPlayer], from)) {
+            type = static_cast<Piece::Type>(type - 1);
+        }
+        if (checks.checkSquares[type] & (1ULL << to) && !move.isPromotion()) {
+            return true;
+        }
+        if ((checks.discoverers & (1ULL << from)) &&
+            !(MoveGeneration::rayThrough[king][from] & (1ULL << to))) {
+            return true;
+        }
+        if (flag < Move::EN_PASSANT_CAPTURE) {
+            return false;
         }
     }
 
-    return false;
+    // Castling, en passant and promotions change the board in more than one
+    // place, so the lines to the king are recomputed after the move
+    uint64_t occupied =
+        aggregateBitboards[Side::W] | aggregateBitboards[Side::B];
+    uint64_t rooks = bitboards[Piece::Type::R][currentPlayer] |
+                     bitboards[Piece::Type::Q][currentPlayer];
+    uint64_t bishops = bitboards[Piece::Type::B][currentPlayer] |
+                       bitboards[Piece::Type::Q][currentPlayer];
+    if (flag == Move::KING_CASTLE || flag == Move::QUEEN_CASTLE) {
+        const uint64_t base = currentPlayer == Side::W ? 0 : 56;
+        const bool kingSide = flag == Move::KING_CASTLE;
+        const uint64_t rookFrom = base + (kingSide ? 0 : 7);
+        const uint64_t rookTo = base + (kingSide ? 2 : 4);
+        const uint64_t kingTo = base + (kingSide ? 1 : 5);
+        occupied ^= (1ULL << (base + 3)) | (1ULL << kingTo) |
+                    (1ULL << rookFrom) | (1ULL << rookTo);
+        return getAttackMap(rookTo, Piece::Type::R, 0, occupied,
+                            currentPlayer) &
+               (1ULL << king);
+    }
+    occupied = (occupied & ~(1ULL << from)) | (1ULL << to);
+    if (flag == Move::EN_PASSANT_CAPTURE) {
+        occupied &= ~(1ULL << (currentPlayer == Side::W ? to - 8 : to + 8));
+    } else {
+        // The promoted piece replaces the pawn
+        static constexpr Piece::Type PROMOTIONS[4] = {
+            Piece::Type::N, Piece::Type::B, Piece::Type::R, Piece::Type::Q};
+        const Piece::Type promoted = PROMOTIONS[(flag - 6) % 4];
+        if (getAttackMap(to, promoted, 0, occupied, currentPlayer) &
+            (1ULL << king)) {
+            return true;
+        }
+    }
+    return (getAttackMap(king, Piece::Type::R, 0, occupied, opponent) &
+            rooks) |
+           (getAttackMap(king, Piece::Type::B, 0, occupied, opponent) &
+            bishops);
+}
+
+bool Board::inCheck(Side const &side) const {
+    return getAttackInfo().attacked[~side] & bitboards[Piece::Type::K][side];
 }
 
-bool Board::legalEnPassantMove(Move const &move) {
+template <Side Us> bool Board::legalEnPassantMove(Move const &move) {
     // En passant captures are infrequent enough that we can check their
     // legality by making the move and seeing if king is left in check
-    makeMove(move);
-    bool legal = !inCheck(opponent);
-    unmakeMove(move);
+    makeMove<Us>(move);
+    bool legal = !inCheck(Us);
+    unmakeMove<Us>(move);
     return legal;
 }
 
@@ -290,57 +505,63 @@ uint64_t Board::getPositions(Side const &side) const {
     return aggregateBitboards[side];
 }
 
-void Board::makeQueenSideCastle() {
-    uint64_t kingLocation = currentPlayer == Side::B ? 59 : 3;
+// The rook half of a castle, which the king move already counted on the
+// clock and for the castling rights
+template <Side Us> void Board::moveRook(uint64_t from, uint64_t to) {
+    const Piece rook(Piece::Type::R, Us);
+    clearPiece(from, rook);
+    (*this)(to, rook);
+}
+
+template <Side Us> void Board::makeQueenSideCastle() {
+    constexpr uint64_t kingLocation = Us == Side::B ? 59 : 3;
     movePiece(kingLocation, kingLocation + 2);
-    movePiece(kingLocation + 4, kingLocation + 1);
-    ++(state->halfMoveClock);
+    moveRook<Us>(kingLocation + 4, kingLocation + 1);
 }
 
-void Board::makeKingSideCastle() {
-    uint64_t kingLocation = currentPlayer == Side::B ? 59 : 3;
+template <Side Us> void Board::makeKingSideCastle() {
+    constexpr uint64_t kingLocation = Us == Side::B ? 59 : 3;
     movePiece(kingLocation, kingLocation - 2);
-    movePiece(kingLocation - 3, kingLocation - 1);
-    ++(state->halfMoveClock);
+    moveRook<Us>(kingLocation - 3, kingLocation - 1);
 }
 
-void Board::unmakeQueenSideCastle() {
-    uint64_t kingLocation = currentPlayer == Side::B ? 61 : 5;
+template <Side Us> void Board::unmakeQueenSideCastle() {
+    constexpr uint64_t kingLocation = Us == Side::B ? 61 : 5;
     movePiece(kingLocation, kingLocation - 2);
     movePiece(kingLocation - 1, kingLocation + 2);
-    ++(state->halfMoveClock);
 }
 
-void Board::unmakeKingSideCastle() {
-    uint64_t kingLocation = currentPlayer == Side::B ? 57 : 1;
+template <Side Us> void Board::unmakeKingSideCastle() {
+    constexpr uint64_t kingLocation = Us == Side::B ? 57 : 1;
     movePiece(kingLocation, kingLocation + 2);
     movePiece(kingLocation + 1, kingLocation - 1);
-    ++(state->halfMoveClock);
 }
 
+template <Side Us>
 bool Board::canKingSideCastle(uint64_t occupiedPositions) const {
     // Check if castling flags permit castling
-    bool castleLegal = (state->castlingRights >> (2 * currentPlayer)) & 0b10;
+    bool castleLegal = (state->castlingRights >> (2 * Us)) & 0b10;
     if (!castleLegal)
         return false;
 
     // Check if path for castling is clear. Attacks checked during legality of
     // move check.
-    uint64_t clearPiecesMask =
-        currentPlayer == Side::W ? 0x0000000000000006 : 0x0600000000000000;
+    constexpr uint64_t clearPiecesMask =
+        Us == Side::W ? 0x0000000000000006 : 0x0600000000000000;
     return !(occupiedPositions & clearPiecesMask);
 }
 
+template <Side Us>
 bool Board::canQueenSideCastle(uint64_t occupiedPositions) const {
     // Check if castling flags permit castling
-    bool castleLegal = (state->castlingRights >> (2 * currentPlayer)) & 0b1;
+    bool castleLegal = (state->castlingRights >> (2 * Us)) & 0b1;
     if (!castleLegal)
         return false;
 
     // Check if path for castling is clear. Attacks checked during legality of
     // move check.
-    uint64_t clearPiecesMask =
-        currentPlayer == Side::W ? 0x0000000000000070 : 0x7000000000000000;
+    constexpr uint64_t clearPiecesMask =
+        Us == Side::W ? 0x0000000000000070 : 0x7000000000000000;
     return !(occupiedPositions & clearPiecesMask);
 }
 
@@ -408,22 +629,18 @@ void Board::updateCastlingBits(Piece const &piece, uint64_t moveSource) {
     } else if (piece.type == Piece::Type::R) {
         // Moved rook
 
-        // King side
-        if ((1ULL << moveSource) & MoveGeneration::fileH) {
-            if (piece.side == Side::W) {
-                state->castlingRights &= 0b1101;
-            } else {
-                state->castlingRights &= 0b0111;
-            }
+        // King side, only the rook on its starting corner holds the right
+        if (moveSource == MoveGeneration::h1 && piece.side == Side::W) {
+            state->castlingRights &= 0b1101;
+        } else if (moveSource == MoveGeneration::h8 && piece.side == Side::B) {
+            state->castlingRights &= 0b0111;
         }
 
         // Queen side
-        if ((1ULL << moveSource) & MoveGeneration::fileA) {
-            if (piece.side == Side::W) {
-                state->castlingRights &= 0b1110;
-            } else {
-                state->castlingRights &= 0b1011;
-            }
+        if (moveSource == MoveGeneration::a1 && piece.side == Side::W) {
+            state->castlingRights &= 0b1110;
+        } else if (moveSource == MoveGeneration::a8 && piece.side == Side::B) {
+            state->castlingRights &= 0b1011;
         }
     }
 }
@@ -450,13 +667,15 @@ void Board::movePiece(uint64_t from, uint64_t to) {
     (*this)(to, piece);
 }
 
-void Board::makeCapture(Move const &move) {
+template <Side Us> void Board::makeCapture(Move const &move) {
     auto moveFlag = move.getFlag();
     uint64_t source = move.getFrom();
     uint64_t target = move.getTo();
     if (moveFlag == Move::EN_PASSANT_CAPTURE) {
-        Piece capturePiece = (*this)(state->enPassantTarget);
-        clearPiece(state->enPassantTarget, capturePiece);
+        // Captured pawn sits behind the en passant target square
+        uint64_t capturePosition = Us == Side::W ? target - 8 : target + 8;
+        Piece capturePiece = (*this)(capturePosition);
+        clearPiece(capturePosition, capturePiece);
         state->capturedPiece = capturePiece;
     } else {
         updateCastlingBits((*this)(source), source);
@@ -473,35 +692,112 @@ void Board::makeCapture(Move const &move) {
     state->halfMoveClock = 0;
 }
 
-void Board::makePromotion(Move const &move) {
+template <Side Us> void Board::makePromotion(Move const &move) {
     switch (move.getFlag()) {
     case Move::BISHOP_PROMOTION:
     case Move::BISHOP_PROMO_CAPTURE:
-        (*this)(move.getTo(), Piece(Piece::Type::B, currentPlayer));
+        clearPiece(move.getTo(), Piece(Piece::Type::P, Us));
+        (*this)(move.getTo(), Piece(Piece::Type::B, Us));
         break;
     case Move::KNIGHT_PROMOTION:
     case Move::KNIGHT_PROMO_CAPTURE:
-        clearPiece(move.getTo(), Piece(Piece::Type::P, currentPlayer));
-        (*this)(move.getTo(), Piece(Piece::Type::N, currentPlayer));
+        clearPiece(move.getTo(), Piece(Piece::Type::P, Us));
+        (*this)(move.getTo(), Piece(Piece::Type::N, Us));
         break;
     case Move::QUEEN_PROMOTION:
     case Move::QUEEN_PROMO_CAPTURE:
-        clearPiece(move.getTo(), Piece(Piece::Type::P, currentPlayer));
-        (*this)(move.getTo(), Piece(Piece::Type::Q, currentPlayer));
+        clearPiece(move.getTo(), Piece(Piece::Type::P, Us));
+        (*this)(move.getTo(), Piece(Piece::Type::Q, Us));
         break;
     case Move::ROOK_PROMOTION:
     case Move::ROOK_PROMO_CAPTURE:
-        clearPiece(move.getTo(), Piece(Piece::Type::P, currentPlayer));
-        (*this)(move.getTo(), Piece(Piece::Type::R, currentPlayer));
+        clearPiece(move.getTo(), Piece(Piece::Type::P, Us));
+        (*this)(move.getTo(), Piece(Piece::Type::R, Us));
         break;
     }
 }
 
-bool Board::fiftyMoves() const { return state->halfMoveClock >= 50; }
+// The clock counts plies, fifty moves by each side
+bool Board::fiftyMoves() const { return state->halfMoveClock >= 100; }
+
+void Board::setPrefetcher(Memory::Prefetcher const *prefetcher_) {
+    prefetcher = prefetcher_;
+}
+
+Memory::Prefetcher const *Board::getPrefetcher() const { return prefetcher; }
+
+uint64_t Board::getKey() const {
+    uint64_t key = pieceKey ^ ZOBRIST.castlingRights[state->castlingRights];
+    if (state->enPassantTarget < 64) {
+        key ^= ZOBRIST.enPassantFiles[state->enPassantTarget % 8];
+    }
+    return currentPlayer == Side::B ? key ^ ZOBRIST.side : key;
+}
+
+bool Board::isRepetition() const {
+    // Only positions since the last capture or pawn move can repeat, and only
+    // with the same side to move
+    int plies = std::min<int>(state->halfMoveClock, keyHistory.size());
+    uint64_t key = getKey();
+    for (int back = 4; back <= plies; back += 2) {
+        if (keyHistory[keyHistory.size() - back] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Board::hasUpcomingRepetition() const {
+    int plies = std::min<int>(state->halfMoveClock, keyHistory.size());
+    uint64_t key = getKey();
+    uint64_t occupied =
+        aggregateBitboards[Side::W] | aggregateBitboards[Side::B];
+    for (int back = 3; back <= plies; back += 2) {
+        uint64_t moveKey = key ^ keyHistory[keyHistory.size() - back];
+        int slot = cuckooHash1(moveKey);
+        if (cuckooKeys[slot] != moveKey) {
+            slot = cuckooHash2(moveKey);
+            if (cuckooKeys[slot] != moveKey) {
+                continue;
+            }
+        }
+
+        // The move must be unobstructed and made by a piece of the side to
+        // move
+        auto [from, to] = cuckooMoves[slot];
+        if (MoveGeneration::squaresBetween[from][to] & occupied) {
+            continue;
+        }
+        uint64_t moved = occupied & (1ULL << from) ? 1ULL << from : 1ULL << to;
+        if (aggregateBitboards[currentPlayer] & moved) {
+            return true;
+        }
+    }
+    return false;
+}
 
 void Board::operator()(int position, Piece const &piece) {
     Utility::setBit(bitboards[piece.type][piece.side], position);
     Utility::setBit(aggregateBitboards[piece.side], position);
+    pieceKey ^= ZOBRIST.pieces[piece.type][piece.side][position];
+    state->attacks.valid = false;
+    state->checks.valid = false;
+}
+
+void Board::clear(Side const &sideToMove, uint8_t castlingRights,
+                  uint64_t enPassantTarget, int halfMoveClock,
+                  int fullMoveNumber) {
+    for (auto &pieceBitboards : bitboards) {
+        pieceBitboards[Side::W] = pieceBitboards[Side::B] = 0;
+    }
+    aggregateBitboards[Side::W] = aggregateBitboards[Side::B] = 0;
+    pieceKey = 0;
+    keyHistory.clear();
+    currentPlayer = sideToMove;
+    opponent = ~sideToMove;
+    state = std::make_shared<StateInfo>(halfMoveClock, fullMoveNumber,
+                                        enPassantTarget, castlingRights,
+                                        nullptr);
 }
 
 Piece Board::operator()(int i, int j) const {
@@ -515,6 +811,39 @@ void Board::operator()(int i, int j, Piece const &piece) {
 void Board::clearPiece(int position, Piece const &piece) {
     Utility::clearBit(bitboards[piece.type][piece.side], position);
     Utility::clearBit(aggregateBitboards[piece.side], position);
+    pieceKey ^= ZOBRIST.pieces[piece.type][piece.side][position];
+}
+
+bool Board::validFen(std::string const &fenString) {
+    std::istringstream fields(fenString);
+    std::string placement, side;
+    if (!(fields >> placement >> side) || (side != "w" && side != "b")) {
+        return false;
+    }
+    int ranks = 1;
+    int files = 0;
+    int kings[2] = {0, 0};
+    for (char c : placement) {
+        if (c == '/') {
+            if (files != 8) {
+                return false;
+            }
+            ++ranks;
+            files = 0;
+        } else if (c >= '1' && c <= '8') {
+            files += c - '0';
+        } else if (std::string("KQRBNPkqrbnp").find(c) != std::string::npos) {
+            kings[0] += c == 'K';
+            kings[1] += c == 'k';
+            ++files;
+        } else {
+            return false;
+        }
+        if (files > 8) {
+            return false;
+        }
+    }
+    return ranks == 8 && files == 8 && kings[0] == 1 && kings[1] == 1;
 }
 
 void Board::parseFenString(std::string const &fenString) {
@@ -621,8 +950,7 @@ void Board::parseFenString(std::string const &fenString) {
 
     // En passant target square
     if (token != "-") {
-        enPassantTarget =
-            Utility::flattenCoordinates(token[0] - 'a', token[1] - '0');
+        enPassantTarget = (token[1] - '1') * 8 + ('h' - token[0]);
     }
 
     ss >> token;
@@ -633,5 +961,27 @@ void Board::parseFenString(std::string const &fenString) {
     state =
         std::make_shared<StateInfo>(halfMoveClock, fullMoveNumber,
                                     enPassantTarget, castlingRights, nullptr);
+
+    pieceKey = 0;
+    for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+        for (int side = Side::W; side < Side::NUM_SIDES; ++side) {
+            uint64_t positions = bitboards[type][side];
+            while (positions) {
+                pieceKey ^=
+                    ZOBRIST.pieces[type][side][Utility::bitScanPop(positions)];
+            }
+        }
+    }
 }
-} // namespace AdiChess
\ No newline at end of file
+template Board &Board::makeMove<Side::W>(Move const &move);
+template Board &Board::makeMove<Side::B>(Move const &move);
+template void Board::unmakeMove<Side::W>(Move const &move);
+template void Board::unmakeMove<Side::B>(Move const &move);
+template bool Board::legalMove<Side::W>(Move const &move);
+template bool Board::legalMove<Side::B>(Move const &move);
+template bool Board::canKingSideCastle<Side::W>(uint64_t) const;
+template bool Board::canKingSideCastle<Side::B>(uint64_t) const;
+template bool Board::canQueenSideCastle<Side::W>(uint64_t) const;
+template bool Board::canQueenSideCastle<Side::B>(uint64_t) const;
+
+} // namespace AdiChess
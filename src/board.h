@@ -1,14 +1,42 @@
 #pragma once
 
+#include "largePages.h"
 #include "piece.h"
 
 #include <stack>
 #include <memory>
+#include <vector>
 
-#define DEBUG 1
+#define DEBUG 0
 
 namespace AdiChess {
 
+// Attack information for a position, computed lazily on first use and shared
+// by legality, check detection and evaluation.
+struct AttackInfo {
+    // Squares attacked by each side, defended pieces included. Rays pass
+    // through the opposing king so it cannot retreat along a checking ray.
+    uint64_t attacked[2] = {0};
+    uint64_t pieceAttacks[6][2] = {{0}};
+    // Opposition pieces checking the side to move
+    uint64_t checkers = 0;
+    // Side to move pieces absolutely pinned to their king
+    uint64_t pinned = 0;
+    bool valid = false;
+};
+
+// Where the side to move gives check from, computed lazily like AttackInfo
+// and used to test moves for check without making them.
+struct CheckInfo {
+    // Positions from which a piece of each type attacks the opposing king
+    uint64_t checkSquares[6] = {0};
+    // Side to move pieces that are the only blocker between one of its
+    // sliders and the opposing king, moving them off that line checks
+    uint64_t discoverers = 0;
+    uint64_t kingPosition = 0;
+    bool valid = false;
+};
+
 struct StateInfo {
 
     StateInfo(int halfMoveClock_, int fullMoveNumber_, uint64_t enPassantTarget_, uint8_t castlingRights_, std::shared_ptr<StateInfo> prev_, std::string descr_= ""): 
@@ -21,6 +49,9 @@ struct StateInfo {
     std::shared_ptr<StateInfo> prev;
     Piece capturedPiece{Piece::Type::NONE, Side::NONE};
     std::string descr;
+    // Cached with the state so unmaking a move restores the parent's attacks
+    AttackInfo attacks;
+    CheckInfo checks;
 };
 
 class Board {
@@ -29,26 +60,55 @@ public:
     explicit Board(std::string const &fenString = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
     Board(const Board &) = delete;
     Board& operator=(const Board &) = delete;
+
+    // The FEN parser trusts its input, this rejects anything it cannot place
+    static bool validFen(std::string const &fenString);
     
     Piece operator()(int position) const;
     void operator()(int position, Piece const &piece);
 
+    // Empties the board, by default with no castling rights or en passant
+    // target. Pieces are then placed with operator()
+    void clear(Side const &sideToMove, uint8_t castlingRights = 0,
+               uint64_t enPassantTarget = -1, int halfMoveClock = 0,
+               int fullMoveNumber = 1);
+
     Board& makeMove(Move const &move);
     void unmakeMove(Move const &move);
     bool legalMove(Move const &move);
+
+    // Side to move known at compile time, used by the search and perft hot
+    // paths to avoid branching on the current player for every move.
+    template <Side Us> Board& makeMove(Move const &move);
+    template <Side Us> void unmakeMove(Move const &move);
+    template <Side Us> bool legalMove(Move const &move);
+
     bool inCheck(Side const &side) const;
+    AttackInfo const &getAttackInfo() const;
+    CheckInfo const &getCheckInfo() const;
+    // The move, pseudo legal for the side to move, checks the opposing king
+    bool givesCheck(Move const &move) const;
     bool fiftyMoves() const;
+    // Told the key of every position makeMove reaches, may be null
+    void setPrefetcher(Memory::Prefetcher const *prefetcher_);
+    Memory::Prefetcher const *getPrefetcher() const;
+
+    // Zobrist key of the position
+    uint64_t getKey() const;
+    // The position occurred before since the last irreversible move
+    bool isRepetition() const;
+    // A reversible move by the side to move returns to a position that
+    // occurred before since the last irreversible move
+    bool hasUpcomingRepetition() const;
 
     uint64_t getPositions(Piece::Type const &pieceType, Side const &side) const;
     uint64_t getPositions(Side const &side) const;
 
-    bool canQueenSideCastle(uint64_t occupiedPositions) const;
-    bool canKingSideCastle(uint64_t occupiedPositions) const;
+    template <Side Us> bool canQueenSideCastle(uint64_t occupiedPositions) const;
+    template <Side Us> bool canKingSideCastle(uint64_t occupiedPositions) const;
 
     uint64_t getAttackMap(uint64_t position, Piece::Type const &pieceType, uint64_t friendlyOccupied, uint64_t oppositionOccupied, Side const &side) const;
 
-    bool legalMove(Move const &move, uint64_t oppositionAttacks, uint64_t oppositionPositions, uint64_t friendlyPositions);
-
     Side getCurrentPlayer() const {
         return currentPlayer;
     }
@@ -61,6 +121,25 @@ public:
         return position == state->enPassantTarget;
     }
 
+    // Castling rights [Black King Side, Black Queen Side, White King Side,
+    // White Queen Side]
+    uint8_t getCastlingRights() const {
+        return state->castlingRights;
+    }
+
+    // Out of range (greater than 63) when there is no en passant target
+    uint64_t getEnPassantTarget() const {
+        return state->enPassantTarget;
+    }
+
+    int getHalfMoveClock() const {
+        return state->halfMoveClock;
+    }
+
+    int getFullMoveNumber() const {
+        return state->fullMoveNumber;
+    }
+
     friend std::ostream &operator<<(std::ostream &os, Board const &board) {
 #if DEBUG
         os << std::string("Description: ") << board.state->descr << std::string("\n");
@@ -93,16 +172,18 @@ private:
     void clearPiece(int position, Piece const &piece);
     void movePiece(uint64_t from, uint64_t to);
 
-    void makeCapture(Move const &move);
-    void makePromotion(Move const &move);
-    void makeQueenSideCastle();
-    void makeKingSideCastle();
-    void unmakeQueenSideCastle();
-    void unmakeKingSideCastle();
+    template <Side Us> void makeCapture(Move const &move);
+    template <Side Us> void makePromotion(Move const &move);
+    template <Side Us> void makeQueenSideCastle();
+    template <Side Us> void makeKingSideCastle();
+    template <Side Us> void unmakeQueenSideCastle();
+    template <Side Us> void unmakeKingSideCastle();
+    template <Side Us> void moveRook(uint64_t from, uint64_t to);
 
-    uint64_t getAbsolutePinRay(uint64_t attackSources, uint64_t defenderPosition);
+    void computeAttackInfo(AttackInfo &attacks) const;
+    void computeCheckInfo(CheckInfo &checks) const;
 
-    bool legalEnPassantMove(Move const &move);
+    template <Side Us> bool legalEnPassantMove(Move const &move);
 
     void updateState();
     void updateCastlingBits(Piece const &piece, uint64_t moveSource);
@@ -115,6 +196,13 @@ private:
     uint64_t bitboards[6][2] = {0};
     uint64_t aggregateBitboards[2] = {0};
 
+    // Zobrist key of the pieces alone, updated as pieces are placed and
+    // cleared
+    uint64_t pieceKey = 0;
+    // Keys of the positions before each move made, popped on unmake
+    std::vector<uint64_t> keyHistory;
+    Memory::Prefetcher const *prefetcher = nullptr;
+
     Side currentPlayer;
     Side opponent;
 
@@ -0,0 +1,51 @@
+#include "cpu.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace AdiChess::Cpu {
+
+namespace {
+
+const char *NAMES[NUM_TARGETS] = {"baseline", "popcnt", "bmi2", "avx2"};
+
+Target startupTarget() {
+    Target best = detect();
+    if (const char *cap = std::getenv("ADICHESS_CPU")) {
+        for (int target = BASELINE; target < NUM_TARGETS; ++target) {
+            if (std::strcmp(cap, NAMES[target]) == 0 && target < best) {
+                best = static_cast<Target>(target);
+            }
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+Target selected = startupTarget();
+
+Target detect() {
+#if HAS_TARGETS
+    // Selection may run from static initialisers, before libgcc's own
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("popcnt")) {
+        return BASELINE;
+    }
+    if (!__builtin_cpu_supports("bmi") || !__builtin_cpu_supports("bmi2")) {
+        return POPCNT;
+    }
+    return __builtin_cpu_supports("avx2") ? AVX2 : BMI2;
+#else
+    return BASELINE;
+#endif
+}
+
+Target select(Target target) {
+    selected = target < detect() ? target : detect();
+    return selected;
+}
+
+const char *name(Target target) { return NAMES[target]; }
+
+} // namespace AdiChess::Cpu
@@ -0,0 +1,42 @@
+#pragma once
+
+// Instruction set targets of the hot kernels. The engine is built for
+// baseline x86-64 and each kernel is compiled once more per target with
+// GCC target attributes, its body inlined so the bit operations of bitOps.h
+// use the target's instructions. The best target the CPU supports is picked
+// through cpuid at startup, ADICHESS_CPU=<name> caps it.
+
+namespace AdiChess::Cpu {
+
+// Every target includes the instructions of the ones before it
+enum Target { BASELINE, POPCNT, BMI2, AVX2, NUM_TARGETS };
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TARGET_POPCNT __attribute__((target("popcnt")))
+#define TARGET_BMI2 __attribute__((target("popcnt,bmi,bmi2")))
+#define TARGET_AVX2 __attribute__((target("popcnt,bmi,bmi2,avx2")))
+#define HAS_TARGETS 1
+#else
+#define TARGET_POPCNT
+#define TARGET_BMI2
+#define TARGET_AVX2
+#define HAS_TARGETS 0
+#endif
+
+// Kernel bodies inlined into every target's variant
+#define KERNEL inline __attribute__((always_inline))
+
+// Best target of this CPU
+Target detect();
+
+// Target the kernels run, BASELINE until startup selection
+extern Target selected;
+inline Target target() { return selected; }
+
+// Selects a target capped at the best the CPU supports, returns the target
+// selected
+Target select(Target target);
+
+const char *name(Target target);
+
+} // namespace AdiChess::Cpu
@@ -1,36 +1,23 @@
 #include "evaluation.h"
+#include "evaluationParameters.h"
+#include "cpu.h"
+#include "perfCounters.h"
 
 namespace Evaluation {
 
-constexpr int MATERIAL_VALUES[2][6] = {
-    [Phase::OPENING] = {[Piece::Type::K] = 0,
-                        [Piece::Type::Q] = 2538,
-                        [Piece::Type::B] = 825,
-                        [Piece::Type::R] = 1276,
-                        [Piece::Type::N] = 781,
-                        [Piece::Type::P] = 126},
-    [Phase::ENDGAME] = {[Piece::Type::K] = 0,
-                        [Piece::Type::Q] = 2682,
-                        [Piece::Type::B] = 915,
-                        [Piece::Type::R] = 1380,
-                        [Piece::Type::N] = 854,
-                        [Piece::Type::P] = 208},
-};
-
-constexpr int PIECE_PHASES[6] = {[Piece::Type::K] = 0, [Piece::Type::Q] = 4,
-                                 [Piece::Type::B] = 1, [Piece::Type::R] = 2,
-                                 [Piece::Type::N] = 1, [Piece::Type::P] = 0};
+namespace {
 
-int evaluate(Board const &board, Phase const &phase) {
+KERNEL int evaluatePhase(Board const &board, Phase const &phase) {
     int materialValue = 0;
+    AttackInfo const &attacks = board.getAttackInfo();
+    const Side friendly = board.getCurrentPlayer();
+    const Side opposition = board.getOpponent();
 
     for (Piece::Type pieceType = Piece::Type::K;
          pieceType < Piece::Type::NUM_PIECES;
          pieceType = Piece::Type(pieceType + 1)) {
-        int friendlyPositions =
-            board.getPositions(pieceType, board.getCurrentPlayer());
-        int opponentPositions =
-            board.getPositions(pieceType, board.getOpponent());
+        uint64_t friendlyPositions = board.getPositions(pieceType, friendly);
+        uint64_t opponentPositions = board.getPositions(pieceType, opposition);
         int friendlyPopCnt = Utility::popCnt(friendlyPositions);
         int opponentPopCnt = Utility::popCnt(opponentPositions);
 
@@ -40,16 +27,26 @@ int evaluate(Board const &board, Phase const &phase) {
         // Bishop synergy bonus
         if (pieceType == Piece::Type::B) {
             if (friendlyPopCnt == 2)
-                materialValue += 100;
+                materialValue += BISHOP_PAIR_VALUES[phase];
             if (opponentPopCnt == 2)
-                materialValue += 100;
+                materialValue -= BISHOP_PAIR_VALUES[phase];
         }
+
+        // Mobility over squares not occupied by own pieces
+        int friendlyMobility =
+            Utility::popCnt(attacks.pieceAttacks[pieceType][friendly] &
+                            ~board.getPositions(friendly));
+        int opponentMobility =
+            Utility::popCnt(attacks.pieceAttacks[pieceType][opposition] &
+                            ~board.getPositions(opposition));
+        materialValue += MOBILITY_VALUES[phase][pieceType] *
+                         (friendlyMobility - opponentMobility);
     }
 
     return materialValue;
 }
 
-int computePhase(Board const &board) {
+KERNEL int phaseOf(Board const &board) {
     static constexpr int TOTAL_PHASE_SUM =
         PIECE_PHASES[Piece::Type::P] * 16 + PIECE_PHASES[Piece::Type::N] * 4 +
         PIECE_PHASES[Piece::Type::B] * 4 + PIECE_PHASES[Piece::Type::R] * 4 +
@@ -58,17 +55,46 @@ int computePhase(Board const &board) {
     for (Piece::Type pieceType = Piece::Type::K;
          pieceType < Piece::Type::NUM_PIECES;
          pieceType = Piece::Type(pieceType + 1)) {
-        phase -= Utility::popCnt(board.getPositions(pieceType, Side::W));
-        phase -= Utility::popCnt(board.getPositions(pieceType, Side::B));
+        phase -= PIECE_PHASES[pieceType] *
+                 Utility::popCnt(board.getPositions(pieceType, Side::W));
+        phase -= PIECE_PHASES[pieceType] *
+                 Utility::popCnt(board.getPositions(pieceType, Side::B));
     }
     return (phase * 256 + (TOTAL_PHASE_SUM / 2)) / TOTAL_PHASE_SUM;
 }
 
-int evaluate(Board const &board) {
-    int phase = computePhase(board);
-    int opening = evaluate(board, Phase::OPENING);
-    int endgame = evaluate(board, Phase::ENDGAME);
+KERNEL int evaluateKernel(Board const &board) {
+    int phase = phaseOf(board);
+    int opening = evaluatePhase(board, Phase::OPENING);
+    int endgame = evaluatePhase(board, Phase::ENDGAME);
     return ((opening * (256 - phase)) + (endgame * phase)) / 256;
 }
 
+int evaluateBaseline(Board const &board) { return evaluateKernel(board); }
+TARGET_POPCNT int evaluatePopcnt(Board const &board) {
+    return evaluateKernel(board);
+}
+TARGET_BMI2 int evaluateBmi2(Board const &board) {
+    return evaluateKernel(board);
+}
+TARGET_AVX2 int evaluateAvx2(Board const &board) {
+    return evaluateKernel(board);
+}
+
+int (*const EVALUATE[AdiChess::Cpu::NUM_TARGETS])(Board const &) = {
+    evaluateBaseline, evaluatePopcnt, evaluateBmi2, evaluateAvx2};
+
+} // namespace
+
+int evaluate(Board const &board, Phase const &phase) {
+    return evaluatePhase(board, phase);
+}
+
+int computePhase(Board const &board) { return phaseOf(board); }
+
+int evaluate(Board const &board) {
+    PROFILE_REGION(EVALUATION);
+    return EVALUATE[AdiChess::Cpu::target()](board);
+}
+
 } // namespace Evaluation
\ No newline at end of file
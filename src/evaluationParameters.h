@@ -0,0 +1,50 @@
+#pragma once
+
+#include "evaluation.h"
+
+// Evaluation weights indexed by phase and piece type. Regenerated by the tune
+// tool, PIECE_PHASES is carried over unchanged.
+
+namespace Evaluation {
+
+constexpr int MATERIAL_VALUES[2][6] = {
+    [Phase::OPENING] = {[Piece::Type::K] = 0,
+                        [Piece::Type::Q] = 2538,
+                        [Piece::Type::B] = 825,
+                        [Piece::Type::R] = 1276,
+                        [Piece::Type::N] = 781,
+                        [Piece::Type::P] = 126},
+    [Phase::ENDGAME] = {[Piece::Type::K] = 0,
+                        [Piece::Type::Q] = 2682,
+                        [Piece::Type::B] = 915,
+                        [Piece::Type::R] = 1380,
+                        [Piece::Type::N] = 854,
+                        [Piece::Type::P] = 208},
+};
+
+// Bonus per square attacked by each piece type, read from the cached attack
+// maps of the position
+constexpr int MOBILITY_VALUES[2][6] = {
+    [Phase::OPENING] = {[Piece::Type::K] = 0,
+                        [Piece::Type::Q] = 2,
+                        [Piece::Type::B] = 6,
+                        [Piece::Type::R] = 3,
+                        [Piece::Type::N] = 6,
+                        [Piece::Type::P] = 0},
+    [Phase::ENDGAME] = {[Piece::Type::K] = 0,
+                        [Piece::Type::Q] = 4,
+                        [Piece::Type::B] = 6,
+                        [Piece::Type::R] = 6,
+                        [Piece::Type::N] = 5,
+                        [Piece::Type::P] = 0},
+};
+
+// Bishop synergy bonus for holding both bishops
+constexpr int BISHOP_PAIR_VALUES[2] = {[Phase::OPENING] = 100,
+                                       [Phase::ENDGAME] = 100};
+
+constexpr int PIECE_PHASES[6] = {[Piece::Type::K] = 0, [Piece::Type::Q] = 4,
+                                 [Piece::Type::B] = 1, [Piece::Type::R] = 2,
+                                 [Piece::Type::N] = 1, [Piece::Type::P] = 0};
+
+} // namespace Evaluation
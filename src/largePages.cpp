@@ -0,0 +1,79 @@
+#include "largePages.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace AdiChess::Memory {
+
+namespace {
+
+size_t roundUp(size_t bytes, size_t multiple) {
+    return (bytes + multiple - 1) / multiple * multiple;
+}
+
+#ifdef __linux__
+// Maps a huge page more than needed and trims the ends to align the rest
+void *mapAligned(size_t bytes) {
+    const size_t padded = bytes + HUGE_PAGE_SIZE;
+    void *mapping = mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    const auto start = reinterpret_cast<uintptr_t>(mapping);
+    const uintptr_t aligned = roundUp(start, HUGE_PAGE_SIZE);
+    if (aligned > start) {
+        munmap(mapping, aligned - start);
+    }
+    const uintptr_t end = start + padded;
+    if (end > aligned + bytes) {
+        munmap(reinterpret_cast<void *>(aligned + bytes),
+               end - (aligned + bytes));
+    }
+    // Only a hint, the mapping works in small pages without it
+    madvise(reinterpret_cast<void *>(aligned), bytes, MADV_HUGEPAGE);
+    return reinterpret_cast<void *>(aligned);
+}
+#endif
+
+} // namespace
+
+void LargeDeleter::operator()(void *memory) const {
+    if (!memory) {
+        return;
+    }
+#ifdef __linux__
+    if (mapped) {
+        munmap(memory, bytes);
+        return;
+    }
+#endif
+    std::free(memory);
+}
+
+std::unique_ptr<void, LargeDeleter> allocate(size_t bytes) {
+    bytes = std::max<size_t>(bytes, 1);
+#ifdef __linux__
+    if (bytes >= HUGE_PAGE_SIZE) {
+        const size_t rounded = roundUp(bytes, HUGE_PAGE_SIZE);
+        if (void *memory = mapAligned(rounded)) {
+            // Anonymous mappings start zeroed
+            return {memory, LargeDeleter(rounded, true)};
+        }
+    }
+#endif
+    const size_t rounded = roundUp(bytes, CACHE_LINE_SIZE);
+    void *memory = std::aligned_alloc(CACHE_LINE_SIZE, rounded);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    std::memset(memory, 0, rounded);
+    return {memory, LargeDeleter(rounded, false)};
+}
+
+} // namespace AdiChess::Memory
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+// Allocation of the engine's large tables. Each table gets its own mapping,
+// aligned to a 2MB huge page and advised to be backed by transparent huge
+// pages where the system has them, so random probes miss the TLB far less
+// often than in 4KB pages. Small tables and systems without mmap fall back
+// to cache line aligned heap memory.
+
+namespace AdiChess::Memory {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Releases memory from allocate, by unmapping it or freeing it
+class LargeDeleter {
+public:
+    LargeDeleter() = default;
+    LargeDeleter(size_t bytes_, bool mapped_)
+        : bytes{bytes_}, mapped{mapped_} {}
+
+    void operator()(void *memory) const;
+
+    // Whether the memory is a huge page aligned mapping
+    bool isMapped() const { return mapped; }
+
+private:
+    size_t bytes = 0;
+    bool mapped = false;
+};
+
+template <typename T> using LargeArray = std::unique_ptr<T[], LargeDeleter>;
+
+// Zeroed memory for at least bytes
+std::unique_ptr<void, LargeDeleter> allocate(size_t bytes);
+
+// count value initialised elements, which are released without running
+// their destructors. Trivial types value initialise to zero, which the
+// memory already is, so only types with constructors are built in place.
+template <typename T> LargeArray<T> makeLargeArray(size_t count) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "Elements are never destroyed");
+    static_assert(alignof(T) <= CACHE_LINE_SIZE);
+    auto memory = allocate(count * sizeof(T));
+    T *elements = static_cast<T *>(memory.get());
+    if constexpr (!std::is_trivially_default_constructible_v<T>) {
+        for (size_t i = 0; i < count; ++i) {
+            new (elements + i) T();
+        }
+    }
+    const LargeDeleter deleter = memory.get_deleter();
+    memory.release();
+    return LargeArray<T>(elements, deleter);
+}
+
+// A table told the key of every position a Board reaches, so it can start
+// loading the entry the search will probe before the probe happens
+class Prefetcher {
+public:
+    virtual ~Prefetcher() = default;
+    virtual void prefetch(uint64_t key) const = 0;
+};
+
+// Starts loading the cache line holding address
+inline void prefetch(void const *address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+} // namespace AdiChess::Memory
@@ -1 +1,68 @@
-int main() { return 0; }
+#include "analysisServer.h"
+#include "bench.h"
+#include "uciEngine.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace AdiChess;
+
+namespace {
+
+int serve(int argc, char **argv) {
+    AnalysisServer::Options options;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--port") {
+            options.port = std::stoi(value);
+        } else if (option == "--socket") {
+            options.socketPath = value;
+        } else if (option == "--workers") {
+            options.workers = std::stoi(value);
+        } else if (option == "--hash") {
+            options.hashMegabytes = std::stoul(value);
+        } else if (option == "--nodes") {
+            options.maxNodes = std::stoull(value);
+        } else if (option == "--movetime") {
+            options.maxTime = std::stoll(value);
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+
+    AnalysisServer server(options);
+    if (!server.listen()) {
+        std::cerr << "Cannot listen: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    std::cerr << "Listening on "
+              << (options.socketPath.empty() ? std::to_string(server.port())
+                                             : options.socketPath)
+              << std::endl;
+    server.run();
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc > 1 && std::string(argv[1]) == "server") {
+        return serve(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        Bench::run(argc > 2 ? std::stoi(argv[2]) : Bench::DEFAULT_DEPTH,
+                   std::cout);
+        return 0;
+    }
+
+    UCI::Engine engine([](std::string const &line) {
+        std::cout << line << std::endl;
+    });
+    std::string line;
+    while (std::getline(std::cin, line) && engine.command(line)) {
+    }
+    return 0;
+}
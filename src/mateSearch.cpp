@@ -0,0 +1,246 @@
+#include "mateSearch.h"
+#include "perfCounters.h"
+
+#include <algorithm>
+
+namespace AdiChess::Mate {
+
+namespace {
+
+// Nodes searched between checks of the limits
+constexpr uint64_t CHECK_INTERVAL = 1024;
+
+constexpr uint8_t EMPTY = UINT8_MAX;
+
+uint32_t saturate(uint64_t number) {
+    return static_cast<uint32_t>(std::min<uint64_t>(number, INFINITE_NUMBER));
+}
+
+} // namespace
+
+Table::Table(size_t megabytes) { resize(megabytes); }
+
+void Table::resize(size_t megabytes) {
+    // Largest power of two number of entries that fits
+    size_t wanted = std::max<size_t>(megabytes, 1) * 1024 * 1024 / sizeof(Entry);
+    count = 1;
+    while (count * 2 <= wanted) {
+        count *= 2;
+    }
+    entries.reset();
+    entries = Memory::makeLargeArray<Entry>(count);
+    clear();
+}
+
+void Table::clear() {
+    for (size_t i = 0; i < count; ++i) {
+        entries[i].moves = EMPTY;
+    }
+}
+
+size_t Table::index(uint64_t key, int moves) const {
+    return (key ^ (moves * 0x9E3779B97F4A7C15ull)) & (count - 1);
+}
+
+Table::Entry const *Table::probe(uint64_t key, int moves) const {
+    Entry const &entry = entries[index(key, moves)];
+    return entry.key == key && entry.moves == moves ? &entry : nullptr;
+}
+
+void Table::store(uint64_t key, int moves, uint32_t phi, uint32_t delta,
+                  Move move) {
+    entries[index(key, moves)] = {key, phi, delta, move,
+                                  static_cast<uint8_t>(moves)};
+}
+
+Solver::Solver(Board &board_, Table &table_) : board{board_}, table{table_} {}
+
+Result Solver::solve(int moves, SearchLimits const &limits_) {
+    PROFILE_REGION(SEARCH);
+    limits = limits_;
+    start = std::chrono::steady_clock::now();
+    nodes = 0;
+    aborted = false;
+    Result result;
+    moves = std::min(moves, EMPTY - 1);
+    for (int tried = 1; tried <= moves && !aborted; ++tried) {
+        uint32_t phi, delta;
+        search(tried, true, INFINITE_NUMBER, INFINITE_NUMBER, phi, delta);
+        if (!aborted && phi == 0) {
+            result.moves = tried;
+            result.principalVariation = principalVariation(tried);
+            break;
+        }
+    }
+    result.nodes = nodes;
+    result.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    stopRequested = false;
+    return result;
+}
+
+void Solver::stop() { stopRequested = true; }
+
+void Solver::checkLimits() {
+    if (stopRequested || nodes >= limits.nodes ||
+        (limits.time &&
+         std::chrono::steady_clock::now() - start >=
+             std::chrono::milliseconds(limits.time))) {
+        aborted = true;
+    }
+}
+
+void Solver::search(int moves, bool attacker, uint32_t phiThreshold,
+                    uint32_t deltaThreshold, uint32_t &phi, uint32_t &delta) {
+    if (++nodes % CHECK_INTERVAL == 0) {
+        checkLimits();
+    }
+    const uint64_t key = board.getKey();
+    std::vector<Child> children;
+    generate(moves, attacker, children);
+
+    if (children.empty()) {
+        // No check to give or checkmate lose for the side to move, stalemate
+        // saves the defender
+        const bool lost = attacker || board.inCheck(board.getCurrentPlayer());
+        phi = lost ? INFINITE_NUMBER : 0;
+        delta = lost ? 0 : INFINITE_NUMBER;
+        table.store(key, moves, phi, delta, NO_MOVE);
+        return;
+    }
+    if (!attacker && moves == 0) {
+        // The defender has a move and the attacker none left
+        phi = 0;
+        delta = INFINITE_NUMBER;
+        table.store(key, moves, phi, delta, NO_MOVE);
+        return;
+    }
+
+    size_t best = 0;
+    while (true) {
+        // The node is won through its best child and lost only when every
+        // child is won
+        phi = INFINITE_NUMBER;
+        uint32_t secondDelta = INFINITE_NUMBER;
+        uint64_t sum = 0;
+        bool lostChild = false;
+        for (size_t i = 0; i < children.size(); ++i) {
+            auto const &child = children[i];
+            if (child.delta < phi) {
+                secondDelta = phi;
+                phi = child.delta;
+                best = i;
+            } else if (child.delta < secondDelta) {
+                secondDelta = child.delta;
+            }
+            sum += child.phi;
+            lostChild = lostChild || child.phi == INFINITE_NUMBER;
+        }
+        delta = lostChild ? INFINITE_NUMBER
+                          : std::min<uint64_t>(sum, INFINITE_NUMBER - 1);
+        if (phi >= phiThreshold || delta >= deltaThreshold || aborted) {
+            break;
+        }
+
+        Child &child = children[best];
+        const uint32_t childPhiThreshold =
+            saturate(static_cast<uint64_t>(deltaThreshold) - delta + child.phi);
+        const uint32_t childDeltaThreshold =
+            std::min(phiThreshold, saturate(secondDelta + 1ull));
+        board.makeMove(child.move);
+        search(attacker ? moves - 1 : moves, !attacker, childPhiThreshold,
+               childDeltaThreshold, child.phi, child.delta);
+        board.unmakeMove(child.move);
+    }
+    table.store(key, moves, phi, delta, children[best].move);
+}
+
+void Solver::generate(int moves, bool attacker, std::vector<Child> &children) {
+    const int childMoves = attacker ? moves - 1 : moves;
+    auto add = [&](Move const &move) {
+        board.makeMove(move);
+        Child child{move, board.getKey(), 1, 1};
+        board.unmakeMove(move);
+        if (auto entry = table.probe(child.key, childMoves)) {
+            child.phi = entry->phi;
+            child.delta = entry->delta;
+        }
+        children.push_back(child);
+    };
+
+    if (attacker) {
+        // Captures and promotions that check, then the quiet checks
+        MoveGeneration::MoveGenerator captures(
+            board, MoveGeneration::GenType::CAPTURES);
+        for (auto const &move : captures) {
+            if (board.givesCheck(move) && board.legalMove(move)) {
+                add(move);
+            }
+        }
+        MoveGeneration::MoveGenerator checks(board,
+                                             MoveGeneration::GenType::CHECKS);
+        for (auto const &move : checks) {
+            if (board.legalMove(move)) {
+                add(move);
+            }
+        }
+        return;
+    }
+    MoveGeneration::MoveGenerator moveGen(board);
+    for (auto const &move : moveGen) {
+        if (board.legalMove(move)) {
+            add(move);
+            // One reply is enough when the attacker has no moves left
+            if (moves == 0) {
+                return;
+            }
+        }
+    }
+}
+
+std::vector<Move> Solver::principalVariation(int moves) {
+    std::vector<Move> line;
+    bool attacker = true;
+    while (true) {
+        auto entry = table.probe(board.getKey(), moves);
+        if (!entry || entry->phi != (attacker ? 0 : INFINITE_NUMBER) ||
+            entry->move == NO_MOVE) {
+            break;
+        }
+        Move move = entry->move;
+        int left = moves;
+        if (!attacker) {
+            // The defence that puts the mate furthest off among those known
+            left = 0;
+            MoveGeneration::MoveGenerator moveGen(board);
+            for (auto const &reply : moveGen) {
+                if (!board.legalMove(reply)) {
+                    continue;
+                }
+                board.makeMove(reply);
+                int shortest = 1;
+                while (shortest < moves &&
+                       !((entry = table.probe(board.getKey(), shortest)) &&
+                         entry->phi == 0)) {
+                    ++shortest;
+                }
+                board.unmakeMove(reply);
+                if (shortest > left) {
+                    left = shortest;
+                    move = reply;
+                }
+            }
+        }
+        line.push_back(move);
+        board.makeMove(move);
+        moves = attacker ? moves - 1 : left;
+        attacker = !attacker;
+    }
+    for (auto it = line.rbegin(); it != line.rend(); ++it) {
+        board.unmakeMove(*it);
+    }
+    return line;
+}
+
+} // namespace AdiChess::Mate
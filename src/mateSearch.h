@@ -0,0 +1,102 @@
+#pragma once
+
+#include "largePages.h"
+#include "search.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Forced mate search by depth-first proof-number search (df-pn). Attacker
+// nodes try only moves that give check, found with GenType::CHECKS and
+// Board::givesCheck without making the others, and defender nodes every legal
+// move, so mates that need a quiet attacking move are left to the regular
+// search. Proof and disproof numbers live in a table of their own, keyed by the
+// position and the attacker moves left, which keeps the searched graph free
+// of cycles.
+
+namespace AdiChess::Mate {
+
+// Proof or disproof number of a settled node
+constexpr uint32_t INFINITE_NUMBER = 1u << 30;
+
+class Table {
+public:
+    struct Entry {
+        uint64_t key;
+        // Numbers from the point of view of the side to move at the entry,
+        // phi is the proof number at attacker nodes and the disproof number
+        // at defender nodes, delta the other
+        uint32_t phi;
+        uint32_t delta;
+        // Child with the smallest delta, the mating move once proven
+        Move move;
+        uint8_t moves;
+    };
+
+    explicit Table(size_t megabytes = 16);
+
+    // Drops every entry, the table must not be in use
+    void resize(size_t megabytes);
+    void clear();
+
+    Entry const *probe(uint64_t key, int moves) const;
+    void store(uint64_t key, int moves, uint32_t phi, uint32_t delta,
+               Move move);
+
+    size_t size() const { return count; }
+
+private:
+    size_t index(uint64_t key, int moves) const;
+
+    Memory::LargeArray<Entry> entries;
+    size_t count = 0;
+};
+
+struct Result {
+    // Attacker moves to mate, 0 when no mate was proven
+    int moves = 0;
+    std::vector<Move> principalVariation;
+    uint64_t nodes = 0;
+    // Milliseconds
+    int64_t time = 0;
+};
+
+class Solver {
+public:
+    Solver(Board &board_, Table &table_);
+
+    // Shortest checking mate in at most moves attacker moves for the side to
+    // move, trying one more move at a time. Stops early at the node and time
+    // limits of limits.
+    Result solve(int moves, SearchLimits const &limits = {});
+    // Ends a running solve from another thread at its next check
+    void stop();
+
+private:
+    struct Child {
+        Move move;
+        uint64_t key;
+        uint32_t phi;
+        uint32_t delta;
+    };
+
+    // Expands the node until phi or delta reaches its threshold, attacker
+    // nodes have moves left including their own
+    void search(int moves, bool attacker, uint32_t phiThreshold,
+                uint32_t deltaThreshold, uint32_t &phi, uint32_t &delta);
+    void generate(int moves, bool attacker, std::vector<Child> &children);
+    std::vector<Move> principalVariation(int moves);
+    void checkLimits();
+
+    Board &board;
+    Table &table;
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point start;
+    uint64_t nodes = 0;
+    std::atomic<bool> stopRequested{false};
+    bool aborted = false;
+};
+
+} // namespace AdiChess::Mate
@@ -0,0 +1,340 @@
+#include "mcts.h"
+#include "packedPosition.h"
+#include "perfCounters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace AdiChess::Mcts {
+
+namespace {
+
+// Fixed point results, one win is worth VALUE_SCALE
+constexpr double VALUE_SCALE = 1 << 16;
+
+// Playouts of the calling thread between checks of the clock
+constexpr uint64_t CHECK_INTERVAL = 256;
+
+// A LEAF found the pool full when it was expanded and is evaluated on every
+// visit from then on
+enum State : uint8_t { UNEXPANDED, EXPANDING, EXPANDED, LEAF };
+
+// Expected result for the side to move of a search score
+double winProbability(int score) {
+    if (score > MATE_BOUND) {
+        return 1;
+    }
+    if (score < -MATE_BOUND) {
+        return 0;
+    }
+    return 1 / (1 + std::pow(10.0, -score / 400.0));
+}
+
+int centipawns(double probability) {
+    probability = std::clamp(probability, 1e-6, 1 - 1e-6);
+    return static_cast<int>(
+        std::lround(400 * std::log10(probability / (1 - probability))));
+}
+
+} // namespace
+
+struct Searcher::Node {
+    std::atomic<uint32_t> visits{0};
+    // Playouts through the node not backed up yet, each counts as a loss
+    std::atomic<uint32_t> virtualLosses{0};
+    // Results for the side that moved into the node
+    std::atomic<uint64_t> value{0};
+    // Children are a block of the pool, published by the release store of
+    // state
+    uint32_t firstChild = 0;
+    Move move = NO_MOVE;
+    uint8_t children = 0;
+    std::atomic<uint8_t> state{UNEXPANDED};
+
+    void reset(Move move_) {
+        visits.store(0, std::memory_order_relaxed);
+        virtualLosses.store(0, std::memory_order_relaxed);
+        value.store(0, std::memory_order_relaxed);
+        firstChild = 0;
+        move = move_;
+        children = 0;
+        state.store(UNEXPANDED, std::memory_order_relaxed);
+    }
+
+    double meanValue(uint32_t playouts) const {
+        return value.load(std::memory_order_relaxed) / VALUE_SCALE / playouts;
+    }
+};
+
+// Runs playouts on its own board
+class Searcher::Worker {
+public:
+    Worker(Searcher &searcher_, Board &board_)
+        : searcher{searcher_}, board{board_}, rollout{board_} {}
+
+    void playout();
+
+private:
+    Node &select(Node const &node);
+    void expand(Node &node);
+    // Expected result for the side to move
+    double evaluate();
+
+    Searcher &searcher;
+    Board &board;
+    Search rollout;
+};
+
+void Searcher::Worker::playout() {
+    Node *path[MAX_PLY + 1];
+    Node *node = &searcher.pool[0];
+    int length = 0;
+    path[length++] = node;
+    node->virtualLosses.fetch_add(1, std::memory_order_relaxed);
+
+    double result = -1;
+    while (true) {
+        uint8_t state = node->state.load(std::memory_order_acquire);
+        if (state == UNEXPANDED &&
+            node->state.compare_exchange_strong(state, EXPANDING,
+                                                std::memory_order_acquire)) {
+            expand(*node);
+            state = node->state.load(std::memory_order_relaxed);
+        }
+        // Being expanded by another thread or a leaf
+        if (state != EXPANDED) {
+            break;
+        }
+        if (!node->children) {
+            // Checkmate or stalemate
+            result = board.inCheck(board.getCurrentPlayer()) ? 0 : 0.5;
+            break;
+        }
+        if (length >= MAX_PLY) {
+            break;
+        }
+        node = &select(*node);
+        node->virtualLosses.fetch_add(1, std::memory_order_relaxed);
+        board.makeMove(node->move);
+        path[length++] = node;
+        if (board.fiftyMoves() || board.isRepetition()) {
+            result = 0.5;
+            break;
+        }
+    }
+    if (result < 0) {
+        result = evaluate();
+    }
+
+    // Each node keeps the results of the side that moved into it
+    double value = 1 - result;
+    for (int i = length - 1; i >= 0; --i) {
+        Node &visited = *path[i];
+        visited.value.fetch_add(std::lround(value * VALUE_SCALE),
+                                std::memory_order_relaxed);
+        visited.visits.fetch_add(1, std::memory_order_relaxed);
+        visited.virtualLosses.fetch_sub(1, std::memory_order_relaxed);
+        if (i > 0) {
+            board.unmakeMove(visited.move);
+        }
+        value = 1 - value;
+    }
+    searcher.playouts.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Highest upper confidence bound, unvisited children first
+Searcher::Node &Searcher::Worker::select(Node const &node) {
+    Node *children = &searcher.pool[node.firstChild];
+    const uint32_t parentVisits =
+        node.visits.load(std::memory_order_relaxed) +
+        node.virtualLosses.load(std::memory_order_relaxed);
+    const double logVisits = std::log(std::max<uint32_t>(parentVisits, 1));
+    Node *best = children;
+    double bestBound = -1;
+    for (int i = 0; i < node.children; ++i) {
+        Node &child = children[i];
+        const uint32_t visits =
+            child.visits.load(std::memory_order_relaxed) +
+            child.virtualLosses.load(std::memory_order_relaxed);
+        if (!visits) {
+            return child;
+        }
+        const double bound =
+            child.meanValue(visits) +
+            searcher.options.exploration * std::sqrt(logVisits / visits);
+        if (bound > bestBound) {
+            bestBound = bound;
+            best = &child;
+        }
+    }
+    return *best;
+}
+
+void Searcher::Worker::expand(Node &node) {
+    Move moves[256];
+    int count = 0;
+    MoveGeneration::MoveGenerator moveGen(board);
+    for (auto const &move : moveGen) {
+        if (board.legalMove(move)) {
+            moves[count++] = move;
+        }
+    }
+    if (count) {
+        const uint32_t first =
+            searcher.allocated.fetch_add(count, std::memory_order_relaxed);
+        if (first + count > searcher.options.poolSize) {
+            // The pool is full, the node stays a leaf
+            searcher.allocated.store(searcher.options.poolSize,
+                                     std::memory_order_relaxed);
+            node.state.store(LEAF, std::memory_order_release);
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            searcher.pool[first + i].reset(moves[i]);
+        }
+        node.firstChild = first;
+    }
+    node.children = count;
+    node.state.store(EXPANDED, std::memory_order_release);
+}
+
+double Searcher::Worker::evaluate() {
+    if (searcher.options.rolloutDepth > 0) {
+        return winProbability(rollout.negamax(searcher.options.rolloutDepth,
+                                              -INFINITE_SCORE, INFINITE_SCORE));
+    }
+    return winProbability(Evaluation::evaluate(board));
+}
+
+Searcher::Searcher(Board &board_, Options const &options_)
+    : board{board_}, options{options_},
+      pool{Memory::makeLargeArray<Node>(options.poolSize)} {
+    // Node is private, so its size is checked here
+    static_assert(sizeof(Node) == 24, "Nodes are 24 bytes");
+    options.threads = std::max(options.threads, 1);
+}
+
+Searcher::~Searcher() = default;
+
+int Searcher::search(SearchLimits const &limits_,
+                     std::function<void(SearchInfo const &)> const &report) {
+    PROFILE_REGION(SEARCH);
+    limits = limits_;
+    pondering = limits.ponder;
+    start = std::chrono::steady_clock::now();
+    playouts = 0;
+    finished = false;
+    allocated = 1;
+    pool[0].reset(NO_MOVE);
+
+    // Helpers play out on copies of the board
+    std::vector<std::unique_ptr<Board>> boards;
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < options.threads; ++i) {
+        boards.push_back(std::make_unique<Board>());
+        unpack(pack(board), *boards.back());
+        helpers.emplace_back([this, &helperBoard = *boards.back()] {
+            Worker worker(*this, helperBoard);
+            while (!finished.load(std::memory_order_relaxed) &&
+                   (pondering || playouts.load(std::memory_order_relaxed) <
+                                     limits.nodes)) {
+                worker.playout();
+            }
+        });
+    }
+
+    Worker worker(*this, board);
+    int64_t nextReport = 1000;
+    for (uint64_t played = 1;; ++played) {
+        worker.playout();
+        if (playouts.load(std::memory_order_relaxed) >= limits.nodes &&
+            !pondering) {
+            break;
+        }
+        if (played % CHECK_INTERVAL == 0) {
+            if (limitReached()) {
+                break;
+            }
+            if (report && elapsed() >= nextReport) {
+                report(info());
+                nextReport += 1000;
+            }
+        }
+    }
+    finished = true;
+    for (auto &helper : helpers) {
+        helper.join();
+    }
+
+    SearchInfo result = info();
+    principalVariation = result.principalVariation;
+    if (report) {
+        report(result);
+    }
+    stopRequested = false;
+    ponderHitRequested = false;
+    return result.score;
+}
+
+void Searcher::stop() { stopRequested = true; }
+
+void Searcher::ponderHit() { ponderHitRequested = true; }
+
+bool Searcher::limitReached() {
+    if (ponderHitRequested.exchange(false)) {
+        pondering = false;
+        start = std::chrono::steady_clock::now();
+    }
+    if (stopRequested) {
+        return true;
+    }
+    return !pondering && limits.time && elapsed() >= limits.time;
+}
+
+int64_t Searcher::elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// The line of most visited children
+SearchInfo Searcher::info() const {
+    SearchInfo result{0, 0, playouts.load(std::memory_order_relaxed),
+                      elapsed(), {}};
+    Node const *node = &pool[0];
+    while (node->state.load(std::memory_order_acquire) == EXPANDED &&
+           node->children) {
+        Node const *children = &pool[node->firstChild];
+        Node const *best = children;
+        for (int i = 1; i < node->children; ++i) {
+            if (children[i].visits.load(std::memory_order_relaxed) >
+                best->visits.load(std::memory_order_relaxed)) {
+                best = &children[i];
+            }
+        }
+        const uint32_t visits = best->visits.load(std::memory_order_relaxed);
+        if (!visits) {
+            break;
+        }
+        if (result.principalVariation.empty()) {
+            result.score = centipawns(best->meanValue(visits));
+        }
+        result.principalVariation.push_back(best->move);
+        node = best;
+    }
+    result.depth = std::max<int>(result.principalVariation.size(), 1);
+    return result;
+}
+
+Move Searcher::getPrincipalMove() const {
+    return principalVariation.empty() ? NO_MOVE : principalVariation.front();
+}
+
+std::vector<Move> const &Searcher::getPrincipalVariation() const {
+    return principalVariation;
+}
+
+uint64_t Searcher::getNodes() const { return playouts; }
+
+} // namespace AdiChess::Mcts
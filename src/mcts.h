@@ -0,0 +1,76 @@
+#pragma once
+
+#include "largePages.h"
+#include "search.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Best-first Monte Carlo tree search (UCT) as an alternative to Search. Every
+// thread descends the shared tree without locks: nodes live in a preallocated
+// pool with the children of a node in one contiguous block, statistics are
+// atomics and a thread passing through a node adds a virtual loss to it until
+// its result is backed up, which steers the other threads elsewhere. Leaves
+// are scored by the evaluation, or by a short alpha-beta search when a
+// rollout depth is set.
+
+namespace AdiChess::Mcts {
+
+struct Options {
+    int threads = 1;
+    // Plies of the alpha-beta rollout at leaves, 0 scores them statically
+    int rolloutDepth = 0;
+    double exploration = 1.0;
+    // Nodes in the pool, the tree stops growing when it is full
+    size_t poolSize = 1 << 20;
+};
+
+class Searcher {
+public:
+    Searcher(Board &board_, Options const &options_ = {});
+    ~Searcher();
+    Searcher(Searcher const &) = delete;
+    Searcher &operator=(Searcher const &) = delete;
+
+    // Runs playouts until the node (playout) or time limit, the depth limit
+    // is ignored. report is called about once a second and when the search
+    // ends. Returns the score of the most visited root move in centipawns.
+    int search(SearchLimits const &limits_,
+               std::function<void(SearchInfo const &)> const &report = {});
+    // Ends a running search from another thread
+    void stop();
+    // The expected move was played, the search continues under its limits
+    void ponderHit();
+
+    Move getPrincipalMove() const;
+    std::vector<Move> const &getPrincipalVariation() const;
+    // Playouts of the last search
+    uint64_t getNodes() const;
+
+private:
+    struct Node;
+    class Worker;
+
+    SearchInfo info() const;
+    bool limitReached();
+    int64_t elapsed() const;
+
+    Board &board;
+    Options options;
+    Memory::LargeArray<Node> pool;
+    std::atomic<uint32_t> allocated{0};
+    std::atomic<uint64_t> playouts{0};
+    std::vector<Move> principalVariation;
+
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point start;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> ponderHitRequested{false};
+    std::atomic<bool> finished{false};
+    std::atomic<bool> pondering{false};
+};
+
+} // namespace AdiChess::Mcts
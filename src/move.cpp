@@ -20,4 +20,12 @@ bool Move::isCapture() const {
 
 bool Move::isPromotion() const { return getFlag() >= KNIGHT_PROMOTION; }
 
+uint16_t Move::raw() const { return move; }
+
+Move Move::fromRaw(uint16_t raw) {
+    Move result;
+    result.move = raw;
+    return result;
+}
+
 } // namespace AdiChess
\ No newline at end of file
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "bitOps.h"
 
 namespace AdiChess {
@@ -5,6 +7,8 @@ namespace AdiChess {
 class Move {
 
 public:
+    // Uninitialised, for fixed size move lists
+    Move() = default;
     Move(uint16_t from, uint16_t to, uint8_t flags);
 
     enum Flag {
@@ -30,10 +34,14 @@ public:
     bool isCapture() const;
     bool isPromotion() const;
 
-    bool operator==(Move const &other) {
+    // The 16 bits below, as tables and files store moves
+    uint16_t raw() const;
+    static Move fromRaw(uint16_t raw);
+
+    bool operator==(Move const &other) const {
         return move == other.move;
     }
-    bool operator!=(Move const &other) {
+    bool operator!=(Move const &other) const {
         return !(*this == other);
     }
 
@@ -48,4 +56,7 @@ private:
 
 };
 
+// Placeholder where there is no move, a quiet move from h1 to h1
+inline const Move NO_MOVE(0, 0, Move::QUIET_MOVE);
+
 }
\ No newline at end of file
@@ -1,32 +1,50 @@
 #include "moveGenerator.h"
+#include "perfCounters.h"
 #include <iostream>
 namespace MoveGeneration {
 
-MoveGenerator::MoveGenerator(AdiChess::Board const &board_)
+MoveGenerator::MoveGenerator(AdiChess::Board const &board_, GenType type)
     : board{board_}, currentPlayer{board_.getCurrentPlayer()},
       friendlyOccupied{board.getPositions(currentPlayer)},
       oppositionOccupied{board.getPositions(board_.getOpponent())} {
-    generatePseudoLegalMoves();
+    PROFILE_REGION(MOVE_GENERATION);
+    switch (type) {
+    case GenType::PSEUDO_LEGAL:
+        currentPlayer == Side::W ? generatePseudoLegalMoves<Side::W>()
+                                 : generatePseudoLegalMoves<Side::B>();
+        break;
+    case GenType::CAPTURES:
+        currentPlayer == Side::W ? generateCaptures<Side::W>()
+                                 : generateCaptures<Side::B>();
+        break;
+    case GenType::CHECKS:
+        currentPlayer == Side::W ? generateQuietChecks<Side::W>()
+                                 : generateQuietChecks<Side::B>();
+        break;
+    }
 }
 
-// Sliding piece pseudo legal moves
-template <Piece::Type pieceType> void MoveGenerator::generateMoves() {
+// Sliding piece pseudo legal moves to the targets
+template <Side Us, Piece::Type pieceType>
+void MoveGenerator::generateMoves(uint64_t targets) {
 
-    uint64_t positions = board.getPositions(pieceType, currentPlayer);
+    uint64_t positions = board.getPositions(pieceType, Us);
 
     while (positions) {
         uint64_t position = Utility::bitScanForward(positions);
-        generateAttackMoves<pieceType>(position);
+        generateAttackMoves<pieceType>(position, Us, targets);
         Utility::clearBit(positions, position);
     }
 }
 
 template <Piece::Type pieceType>
-void MoveGenerator::generateAttackMoves(uint64_t position) {
+void MoveGenerator::generateAttackMoves(uint64_t position, Side const &side,
+                                        uint64_t targets) {
     assert(position <= 63);
     uint64_t attackedPositions =
         board.getAttackMap(position, pieceType, friendlyOccupied,
-                           oppositionOccupied, currentPlayer);
+                           oppositionOccupied, side) &
+        targets;
     while (attackedPositions) {
         uint64_t attackedPosition = Utility::bitScanPop(attackedPositions);
         assert(attackedPosition != position);
@@ -38,9 +56,9 @@ void MoveGenerator::generateAttackMoves(uint64_t position) {
     }
 }
 
-// Specialisation for King to add consideration for castling
-template <> void MoveGenerator::generateMoves<Piece::Type::K>() {
-    uint64_t position = board.getPositions(Piece::Type::K, currentPlayer);
+// King moves other than castling
+template <Side Us> void MoveGenerator::generateKingMoves(uint64_t targets) {
+    uint64_t position = board.getPositions(Piece::Type::K, Us);
 
     if (position == 0)
         std::cerr << "No king error\n" << board << '\n';
@@ -48,133 +66,171 @@ template <> void MoveGenerator::generateMoves<Piece::Type::K>() {
     assert(position != 0);
 
     position = Utility::bitScanForward(position);
-    // Generates all non-castling moves
-    generateAttackMoves<Piece::Type::K>(position);
+    generateAttackMoves<Piece::Type::K>(position, Us, targets);
+}
 
-    // Generates pseudo legal castling moves
-    if (board.canKingSideCastle(oppositionOccupied | friendlyOccupied)) {
+// Pseudo legal castling moves
+template <Side Us> void MoveGenerator::generateCastling() {
+    if (board.canKingSideCastle<Us>(oppositionOccupied | friendlyOccupied)) {
         moves.emplace_back(0, 0, Move::KING_CASTLE);
     }
 
-    if (board.canQueenSideCastle(oppositionOccupied | friendlyOccupied)) {
+    if (board.canQueenSideCastle<Us>(oppositionOccupied | friendlyOccupied)) {
         moves.emplace_back(0, 0, Move::QUEEN_CASTLE);
     }
 }
 
-template <>
-void MoveGenerator::generatePawnPushMove<Side::B>(uint64_t pawnPosition,
-                                                  uint64_t freePositions) {
-    // Single pawn push
-    uint64_t singlePawnPushPosition = pawnPosition - 8;
-    uint64_t singlePawnPush = (1ULL << singlePawnPushPosition) & freePositions;
-    if (singlePawnPush & rank1) {
-        moves.emplace_back(pawnPosition, singlePawnPushPosition,
-                           Move::KNIGHT_PROMOTION);
-        moves.emplace_back(pawnPosition, singlePawnPushPosition,
-                           Move::BISHOP_PROMOTION);
-        moves.emplace_back(pawnPosition, singlePawnPushPosition,
-                           Move::ROOK_PROMOTION);
-        moves.emplace_back(pawnPosition, singlePawnPushPosition,
-                           Move::QUEEN_PROMOTION);
-    } else if (singlePawnPush) {
-        uint64_t singlePawnPushPosition = pawnPosition - 8;
-        moves.emplace_back(pawnPosition, singlePawnPushPosition,
-                           Move::QUIET_MOVE);
-        // Double pawn push
-        uint64_t doublePawnPush = (singlePawnPush >> 8) & rank5 & freePositions;
-        if (doublePawnPush) {
-            moves.emplace_back(pawnPosition, singlePawnPushPosition - 8,
-                               Move::DOUBLE_PAWN_PUSH);
-        }
+// Adds a move for every target, with the source square a fixed offset behind
+template <int Offset>
+void MoveGenerator::serializePawnMoves(uint64_t targets, Move::Flag flag) {
+    while (targets) {
+        uint64_t target = Utility::bitScanPop(targets);
+        moves.emplace_back(target - Offset, target, flag);
     }
 }
 
-template <>
-void MoveGenerator::generatePawnPushMove<Side::W>(uint64_t pawnPosition,
-                                                  uint64_t freePositions) {
-    // Single pawn push
-    uint64_t singlePawnPushPosition = pawnPosition + 8;
-    uint64_t singlePawnPush = (1ULL << singlePawnPushPosition) & freePositions;
-    if (singlePawnPush & rank8) {
-        moves.emplace_back(pawnPosition, singlePawnPushPosition,
-                           Move::KNIGHT_PROMOTION);
-        moves.emplace_back(pawnPosition, singlePawnPushPosition,
-                           Move::BISHOP_PROMOTION);
-        moves.emplace_back(pawnPosition, singlePawnPushPosition,
-                           Move::ROOK_PROMOTION);
-        moves.emplace_back(pawnPosition, singlePawnPushPosition,
-                           Move::QUEEN_PROMOTION);
-    } else if (singlePawnPush) {
-        moves.emplace_back(pawnPosition, singlePawnPushPosition,
-                           Move::QUIET_MOVE);
-        // Double pawn push
-        uint64_t doublePawnPush = (singlePawnPush << 8) & rank4 & freePositions;
-        if (doublePawnPush) {
-            moves.emplace_back(pawnPosition, singlePawnPushPosition + 8,
-                               Move::DOUBLE_PAWN_PUSH);
+// Adds knight, bishop, rook and queen promotions for every target, flag is the
+// knight promotion (capture) flag which the others follow
+template <int Offset>
+void MoveGenerator::serializePromotions(uint64_t targets, Move::Flag flag) {
+    while (targets) {
+        uint64_t target = Utility::bitScanPop(targets);
+        for (int promotion = 0; promotion < 4; ++promotion) {
+            moves.emplace_back(target - Offset, target, flag + promotion);
         }
     }
 }
 
-// Specialisation for pawns to add consideration for promotions, push moves and
-// en passant captures
-template <> void MoveGenerator::generateMoves<Piece::Type::P>() {
-    uint64_t positions = board.getPositions(Piece::Type::P, currentPlayer);
-    uint64_t oppositionOccupied = board.getPositions(board.getOpponent());
+// Pawn moves generated set-wise for all pawns at once, including promotions,
+// push moves and en passant captures. Captures leave out the quiet pushes and
+// checks keep only the quiet pushes that check.
+template <Side Us, GenType Type> void MoveGenerator::generatePawnMoves() {
+    // Colour dependent shifts and ranks resolved at compile time. West is
+    // towards the A file.
+    constexpr int up = Us == Side::W ? 8 : -8;
+    constexpr int upWest = Us == Side::W ? 9 : -7;
+    constexpr int upEast = Us == Side::W ? 7 : -9;
+    constexpr uint64_t promotionRank = Us == Side::W ? rank8 : rank1;
+    constexpr uint64_t doublePushRank = Us == Side::W ? rank4 : rank5;
+
+    uint64_t pawns = board.getPositions(Piece::Type::P, Us);
     uint64_t freePositions = ~(friendlyOccupied | oppositionOccupied);
 
-    while (positions) {
-        uint64_t position = Utility::bitScanPop(positions);
-        // Generates diagonal (non en-passant attacks from position)
-        uint64_t attackedPositions =
-            board.getAttackMap(position, Piece::Type::P, friendlyOccupied,
-                               oppositionOccupied, currentPlayer);
-        while (attackedPositions) {
-            uint64_t attackedPosition = Utility::bitScanPop(attackedPositions);
-            if ((1ULL << attackedPosition) & promotionRank[currentPlayer]) {
-                // Promotion capture
-                moves.emplace_back(position, attackedPosition,
-                                   Move::KNIGHT_PROMO_CAPTURE);
-                moves.emplace_back(position, attackedPosition,
-                                   Move::BISHOP_PROMO_CAPTURE);
-                moves.emplace_back(position, attackedPosition,
-                                   Move::ROOK_PROMO_CAPTURE);
-                moves.emplace_back(position, attackedPosition,
-                                   Move::QUEEN_PROMO_CAPTURE);
-            } else {
-                // Standard capture
-                moves.emplace_back(position, attackedPosition, Move::CAPTURE);
-            }
+    // Push moves
+    uint64_t singlePushes = shift<up>(pawns) & freePositions;
+    uint64_t doublePushes =
+        shift<up>(singlePushes) & freePositions & doublePushRank;
+
+    if constexpr (Type == GenType::CHECKS) {
+        // Pushes to where the pawn attacks the king, and any push of a pawn
+        // uncovering a slider unless it stays on the king's file
+        CheckInfo const &checks = board.getCheckInfo();
+        const uint64_t kingFile = fileH << (checks.kingPosition & 7);
+        const uint64_t discovering =
+            shift<up>(checks.discoverers & pawns & ~kingFile);
+        const uint64_t checking = checks.checkSquares[Piece::Type::P];
+        serializePawnMoves<up>(singlePushes & ~promotionRank &
+                                   (checking | discovering),
+                               Move::QUIET_MOVE);
+        serializePawnMoves<2 * up>(
+            doublePushes & (checking | shift<up>(discovering)),
+            Move::DOUBLE_PAWN_PUSH);
+        return;
+    }
+    if constexpr (Type == GenType::PSEUDO_LEGAL) {
+        serializePawnMoves<up>(singlePushes & ~promotionRank,
+                               Move::QUIET_MOVE);
+        serializePawnMoves<2 * up>(doublePushes, Move::DOUBLE_PAWN_PUSH);
+    }
+    serializePromotions<up>(singlePushes & promotionRank,
+                            Move::KNIGHT_PROMOTION);
+
+    // Diagonal captures, masking out pawns that wrapped around the board edge
+    uint64_t westCaptures = shift<upWest>(pawns) & ~fileH & oppositionOccupied;
+    uint64_t eastCaptures = shift<upEast>(pawns) & ~fileA & oppositionOccupied;
+
+    serializePawnMoves<upWest>(westCaptures & ~promotionRank, Move::CAPTURE);
+    serializePawnMoves<upEast>(eastCaptures & ~promotionRank, Move::CAPTURE);
+    serializePromotions<upWest>(westCaptures & promotionRank,
+                                Move::KNIGHT_PROMO_CAPTURE);
+    serializePromotions<upEast>(eastCaptures & promotionRank,
+                                Move::KNIGHT_PROMO_CAPTURE);
+
+    // En passant, pawns attacking the target are those a reverse pawn attack
+    // from the target reaches
+    uint64_t enPassantTarget = board.getEnPassantTarget();
+    if (enPassantTarget < 64) {
+        uint64_t attackers =
+            MoveGeneration::pawnAttacks[~Us][enPassantTarget] & pawns;
+        while (attackers) {
+            moves.emplace_back(Utility::bitScanPop(attackers), enPassantTarget,
+                               Move::EN_PASSANT_CAPTURE);
         }
+    }
+}
 
-        // Generates push moves
-        if (currentPlayer == Side::W) {
-            generatePawnPushMove<Side::W>(position, freePositions);
-        } else if (currentPlayer == Side::B) {
-            generatePawnPushMove<Side::B>(position, freePositions);
+template <Side Us> void MoveGenerator::generatePseudoLegalMoves() {
+    generateKingMoves<Us>(~0ULL);
+    generateCastling<Us>();
+    generateMoves<Us, Piece::Type::Q>(~0ULL);
+    generateMoves<Us, Piece::Type::R>(~0ULL);
+    generateMoves<Us, Piece::Type::B>(~0ULL);
+    generateMoves<Us, Piece::Type::N>(~0ULL);
+    generatePawnMoves<Us, GenType::PSEUDO_LEGAL>();
+}
+
+template <Side Us> void MoveGenerator::generateCaptures() {
+    generateKingMoves<Us>(oppositionOccupied);
+    generateMoves<Us, Piece::Type::Q>(oppositionOccupied);
+    generateMoves<Us, Piece::Type::R>(oppositionOccupied);
+    generateMoves<Us, Piece::Type::B>(oppositionOccupied);
+    generateMoves<Us, Piece::Type::N>(oppositionOccupied);
+    generatePawnMoves<Us, GenType::CAPTURES>();
+}
+
+// A piece checks by moving to a check square of its type, or by leaving the
+// line between the opposing king and a slider it was blocking
+template <Side Us> void MoveGenerator::generateQuietChecks() {
+    CheckInfo const &checks = board.getCheckInfo();
+    const uint64_t empty = ~(friendlyOccupied | oppositionOccupied);
+    auto targets = [&](uint64_t position, Piece::Type type) {
+        uint64_t squares = checks.checkSquares[type];
+        if (checks.discoverers & (1ULL << position)) {
+            squares |= ~rayThrough[checks.kingPosition][position];
         }
+        return squares & empty;
+    };
 
-        // Generates en passant moves
-        uint64_t pawnAttacks =
-            MoveGeneration::pawnAttacks[currentPlayer][position];
-        while (pawnAttacks) {
-            uint64_t pawnAttack = Utility::bitScanPop(pawnAttacks);
-            if (board.validEnPassant(pawnAttack)) {
-                moves.emplace_back(position, pawnAttack,
-                                   Move::EN_PASSANT_CAPTURE);
-                break;
+    uint64_t king = board.getPositions(Piece::Type::K, Us);
+    if (king & checks.discoverers) {
+        generateKingMoves<Us>(
+            targets(Utility::bitScanForward(king), Piece::Type::K));
+    }
+    const size_t first = moves.size();
+    generateCastling<Us>();
+    for (size_t i = first; i < moves.size();) {
+        if (board.givesCheck(moves[i])) {
+            ++i;
+        } else {
+            moves.erase(moves.begin() + i);
+        }
+    }
+    for (Piece::Type type : {Piece::Type::Q, Piece::Type::R, Piece::Type::B,
+                             Piece::Type::N}) {
+        uint64_t positions = board.getPositions(type, Us);
+        while (positions) {
+            uint64_t position = Utility::bitScanPop(positions);
+            uint64_t attacked =
+                board.getAttackMap(position, type, friendlyOccupied,
+                                   oppositionOccupied, Us) &
+                targets(position, type);
+            while (attacked) {
+                moves.emplace_back(position, Utility::bitScanPop(attacked),
+                                   Move::QUIET_MOVE);
             }
         }
     }
+    generatePawnMoves<Us, GenType::CHECKS>();
 }
 
-void MoveGenerator::generatePseudoLegalMoves() {
-    generateMoves<Piece::Type::K>();
-    generateMoves<Piece::Type::Q>();
-    generateMoves<Piece::Type::R>();
-    generateMoves<Piece::Type::B>();
-    generateMoves<Piece::Type::N>();
-    generateMoves<Piece::Type::P>();
-}
-
-} // namespace MoveGeneration
\ No newline at end of file
+} // namespace MoveGeneration
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "board.h"
 #include <vector>
 using namespace AdiChess;
@@ -6,14 +8,19 @@ namespace MoveGeneration {
 
 enum class GenType {
     PSEUDO_LEGAL,
-    CAPTURES
+    // Captures, en passant and every promotion
+    CAPTURES,
+    // Quiet moves that give check, castling included and promotions left to
+    // CAPTURES
+    CHECKS
 };
 
 class MoveGenerator {
     using const_iterator = std::vector<Move>::const_iterator;
     using iterator = std::vector<Move>::iterator;
 public:
-    explicit MoveGenerator(Board const &);
+    explicit MoveGenerator(Board const &,
+                           GenType type = GenType::PSEUDO_LEGAL);
     size_t size() const {
         return moves.size();
     }
@@ -34,17 +41,22 @@ public:
         return moves.end();
     }
 private:
-    template<Piece::Type> void generateMoves();
-    template<Piece::Type> void generateAttackMoves(uint64_t position);
-    template<Side> void generatePawnPushMove(uint64_t position, uint64_t freePositions);
-
-    void generatePseudoLegalMoves();
+    template<Side Us, Piece::Type> void generateMoves(uint64_t targets);
+    template<Side Us> void generateKingMoves(uint64_t targets);
+    template<Side Us> void generateCastling();
+    template<Side Us, GenType Type> void generatePawnMoves();
+    template<Piece::Type> void generateAttackMoves(uint64_t position, Side const &side, uint64_t targets);
+    template<int Offset> void serializePawnMoves(uint64_t targets, Move::Flag flag);
+    template<int Offset> void serializePromotions(uint64_t targets, Move::Flag flag);
+
+    template<Side Us> void generatePseudoLegalMoves();
+    template<Side Us> void generateCaptures();
+    template<Side Us> void generateQuietChecks();
 
     const Board &board;
     const Side currentPlayer;
     const uint64_t friendlyOccupied;
     const uint64_t oppositionOccupied;
-    const uint64_t promotionRank[2] = {rank8, rank1};
     std::vector<Move> moves;
 };
 
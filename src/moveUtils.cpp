@@ -1,5 +1,6 @@
 #include "moveUtils.h"
 #include <iostream>
+#include <mutex>
 
 namespace MoveGeneration {
 
@@ -7,6 +8,8 @@ uint64_t rayAttacks[Direction::NUM_DIRECTIONS][64] = {0};
 uint64_t pawnAttacks[2][64] = {0};
 uint64_t knightAttacks[64] = {0};
 uint64_t kingAttacks[64] = {0};
+uint64_t squaresBetween[64][64] = {{0}};
+uint64_t rayThrough[64][64] = {{0}};
 
 std::string positionToString(uint64_t position) {
     return (static_cast<char>('h' - (position % 8))) +
@@ -89,9 +92,8 @@ uint64_t getAntiDiagonalAttacks(uint64_t friendlyOccupied,
                          position);
 }
 
-// Initialises rays, pawn and knight attack maps. Invoked once at engine start
-// up.
-void init() {
+// Initialises rays, pawn and knight attack maps.
+static void initTables() {
     for (uint64_t position = 0; position < 64; ++position) {
         rayAttacks[Direction::N][position] = 0x0101010101010100ULL << position;
         rayAttacks[Direction::S][position] =
@@ -152,6 +154,27 @@ void init() {
             kingAttacks[position] |= 1ULL << (position + 1);
         }
     }
+
+    for (uint64_t source = 0; source < 64; ++source) {
+        for (int direction = 0; direction < Direction::NUM_DIRECTIONS;
+             ++direction) {
+            uint64_t ray = rayAttacks[direction][source];
+            uint64_t targets = ray;
+            while (targets) {
+                uint64_t target = Utility::bitScanPop(targets);
+                rayThrough[source][target] = ray;
+                squaresBetween[source][target] =
+                    ray & ~rayAttacks[direction][target] & ~(1ULL << target);
+            }
+        }
+    }
+}
+
+// Invoked by every Board but only initialises the tables once, safe to call
+// from several threads.
+void init() {
+    static std::once_flag initialised;
+    std::call_once(initialised, initTables);
 }
 
 uint64_t eastN(uint64_t board, int n) {
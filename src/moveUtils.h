@@ -17,6 +17,11 @@ extern uint64_t pawnAttacks[2][64];
 extern uint64_t knightAttacks[64];
 extern uint64_t kingAttacks[64];
 
+// Squares strictly between two aligned positions, 0 when not aligned
+extern uint64_t squaresBetween[64][64];
+// Ray from the first position passing through the second, 0 when not aligned
+extern uint64_t rayThrough[64][64];
+
 void init();
 
 uint64_t getRankAttacks(uint64_t friendlyOccupied, uint64_t oppositionOccupied, uint64_t position);
@@ -26,6 +31,11 @@ uint64_t getAntiDiagonalAttacks(uint64_t friendlyOccupied, uint64_t oppositionOc
 
 std::string positionToString(uint64_t position);
 
+// Shifts a whole bitboard, positive offsets towards the eighth rank
+template <int Offset> constexpr uint64_t shift(uint64_t bitboard) {
+    return Offset > 0 ? bitboard << Offset : bitboard >> -Offset;
+}
+
 enum: uint64_t {
     rank1 = 0x00000000000000FF,
     rank2 = 0x000000000000FF00,
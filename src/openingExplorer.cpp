@@ -0,0 +1,216 @@
+#include "openingExplorer.h"
+#include "pgn.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace AdiChess::Explorer {
+
+/* FILE LAYOUT:
+|-- 4 --|-- 4 --|-- 8 --|-- 24 * count --|
+  Magic   Unused  Count   Entries sorted by key, then move */
+
+struct Index::Entry {
+    uint64_t key;
+    uint16_t move;
+    uint16_t unused;
+    uint32_t results[3];
+};
+
+namespace {
+
+using Entry = Index::Entry;
+
+constexpr char MAGIC[4] = {'A', 'O', 'X', '1'};
+constexpr size_t HEADER_SIZE = 16;
+
+static_assert(sizeof(Entry) == 24, "Index entries are 24 bytes on disk");
+
+const char *START_FEN =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Results are stored as white wins, draws and black wins
+int resultIndex(Pgn::Result result) { return 1 - result; }
+
+// Sorts the entries by key and move and sums the results of duplicates
+void compact(std::vector<Entry> &entries) {
+    std::sort(entries.begin(), entries.end(),
+              [](Entry const &a, Entry const &b) {
+                  return a.key != b.key ? a.key < b.key : a.move < b.move;
+              });
+    size_t merged = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (merged && entries[merged - 1].key == entries[i].key &&
+            entries[merged - 1].move == entries[i].move) {
+            for (int result = 0; result < 3; ++result) {
+                entries[merged - 1].results[result] += entries[i].results[result];
+            }
+        } else {
+            entries[merged++] = entries[i];
+        }
+    }
+    entries.resize(merged);
+}
+
+// One entry per move played, compacted whenever the entries double so
+// positions common to many games do not grow the memory
+void indexGames(std::string_view text, int maxPlies, std::vector<Entry> &entries,
+                BuildStats &stats) {
+    size_t compactAt = 1 << 20;
+    Pgn::Game game;
+    while (Pgn::nextGame(text, game)) {
+        if (game.result == Pgn::UNKNOWN) {
+            ++stats.skipped;
+            continue;
+        }
+        const auto tag = Pgn::tag(game, "FEN");
+        const std::string fen = tag.empty() ? START_FEN : std::string(tag);
+        if (!Board::validFen(fen)) {
+            ++stats.skipped;
+            continue;
+        }
+        Board board(fen);
+        const int result = resultIndex(game.result);
+        const size_t gameStart = entries.size();
+        bool complete = Pgn::replay(
+            board, game.movetext, maxPlies,
+            [&](Board const &position, Move const &move) {
+                Entry entry{position.getKey(), move.raw(), 0, {0, 0, 0}};
+                entry.results[result] = 1;
+                entries.push_back(entry);
+            });
+        // A game with a move that does not parse is dropped whole
+        if (!complete) {
+            entries.resize(gameStart);
+        }
+        ++(complete ? stats.games : stats.skipped);
+        if (entries.size() >= compactAt) {
+            compact(entries);
+            compactAt = std::max(compactAt, 2 * entries.size());
+        }
+    }
+}
+
+} // namespace
+
+double MoveStats::score(Side side) const {
+    double wins = side == Side::W ? whiteWins : blackWins;
+    return games() ? (wins + draws / 2.0) / games() : 0;
+}
+
+BuildStats build(std::string const &pgnPath, std::string const &indexPath,
+                 BuildOptions const &options) {
+    auto start = std::chrono::steady_clock::now();
+    BuildStats total;
+    Pgn::Reader reader(pgnPath);
+    auto parts = reader.split(std::max(options.threads, 1));
+
+    std::vector<std::vector<Entry>> partEntries(parts.size());
+    std::vector<BuildStats> stats(parts.size());
+    std::vector<std::thread> workers;
+    for (size_t part = 1; part < parts.size(); ++part) {
+        workers.emplace_back(indexGames, parts[part], options.maxPlies,
+                             std::ref(partEntries[part]), std::ref(stats[part]));
+    }
+    if (!parts.empty()) {
+        indexGames(parts[0], options.maxPlies, partEntries[0], stats[0]);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    std::vector<Entry> entries;
+    for (size_t part = 0; part < parts.size(); ++part) {
+        total.games += stats[part].games;
+        total.skipped += stats[part].skipped;
+        entries.insert(entries.end(), partEntries[part].begin(),
+                       partEntries[part].end());
+        std::vector<Entry>().swap(partEntries[part]);
+    }
+    compact(entries);
+    const size_t merged = entries.size();
+    total.entries = merged;
+
+    std::ofstream file(indexPath, std::ios::binary);
+    uint32_t unused = 0;
+    uint64_t count = merged;
+    file.write(MAGIC, sizeof(MAGIC));
+    file.write(reinterpret_cast<const char *>(&unused), sizeof(unused));
+    file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    file.write(reinterpret_cast<const char *>(entries.data()),
+               entries.size() * sizeof(Entry));
+
+    total.seconds = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    return total;
+}
+
+Index::Index(std::string const &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat fileStat;
+    void *mapped = MAP_FAILED;
+    if (fstat(fd, &fileStat) == 0 &&
+        static_cast<size_t>(fileStat.st_size) >= HEADER_SIZE) {
+        mapped = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return;
+    }
+
+    auto bytes = static_cast<const char *>(mapped);
+    uint64_t entryCount;
+    std::memcpy(&entryCount, bytes + 8, sizeof(entryCount));
+    if (std::memcmp(bytes, MAGIC, sizeof(MAGIC)) != 0 ||
+        static_cast<size_t>(fileStat.st_size) !=
+            HEADER_SIZE + entryCount * sizeof(Entry)) {
+        munmap(mapped, fileStat.st_size);
+        return;
+    }
+    entries = reinterpret_cast<const Entry *>(bytes + HEADER_SIZE);
+    count = entryCount;
+    mappedSize = fileStat.st_size;
+}
+
+Index::~Index() {
+    if (mappedSize) {
+        munmap(const_cast<char *>(reinterpret_cast<const char *>(entries)) -
+                   HEADER_SIZE,
+               mappedSize);
+    }
+}
+
+std::vector<MoveStats> Index::lookup(Board const &board) const {
+    std::vector<MoveStats> moves;
+    const uint64_t key = board.getKey();
+    auto first = std::lower_bound(
+        entries, entries + count, key,
+        [](Entry const &entry, uint64_t key) { return entry.key < key; });
+    for (auto entry = first; entry != entries + count && entry->key == key;
+         ++entry) {
+        MoveStats stats{Move::fromRaw(entry->move)};
+        stats.whiteWins = entry->results[0];
+        stats.draws = entry->results[1];
+        stats.blackWins = entry->results[2];
+        moves.push_back(stats);
+    }
+    std::stable_sort(moves.begin(), moves.end(),
+                     [](MoveStats const &a, MoveStats const &b) {
+                         return a.games() > b.games();
+                     });
+    return moves;
+}
+
+} // namespace AdiChess::Explorer
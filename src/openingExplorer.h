@@ -0,0 +1,71 @@
+#pragma once
+
+#include "board.h"
+
+#include <string>
+#include <vector>
+
+// Move statistics of every position reached in a game database. Games are
+// replayed across threads, the statistics are aggregated by position key and
+// move and written as an array sorted by key, which is memory mapped and
+// binary searched to answer a lookup.
+
+namespace AdiChess::Explorer {
+
+// Games with one move played from one position
+struct MoveStats {
+    Move move;
+    // Results from white's point of view
+    uint32_t whiteWins = 0;
+    uint32_t draws = 0;
+    uint32_t blackWins = 0;
+
+    uint32_t games() const { return whiteWins + draws + blackWins; }
+    // Points per game of the side playing the move
+    double score(Side side) const;
+};
+
+struct BuildOptions {
+    int threads = 1;
+    // Moves indexed per game
+    int maxPlies = 40;
+};
+
+struct BuildStats {
+    uint64_t games = 0;
+    // Games not indexed: unfinished, with a FEN tag that does not parse or
+    // with a move that does not parse
+    uint64_t skipped = 0;
+    // Distinct position and move pairs
+    uint64_t entries = 0;
+    double seconds = 0;
+
+    double gamesPerSecond() const { return seconds > 0 ? games / seconds : 0; }
+};
+
+// Indexes the finished games of a PGN file into indexPath
+BuildStats build(std::string const &pgnPath, std::string const &indexPath,
+                 BuildOptions const &options);
+
+class Index {
+public:
+    explicit Index(std::string const &path);
+    ~Index();
+    Index(Index const &) = delete;
+    Index &operator=(Index const &) = delete;
+
+    bool isOpen() const { return entries != nullptr; }
+    size_t size() const { return count; }
+    // Moves played from the position, most frequent first
+    std::vector<MoveStats> lookup(Board const &board) const;
+
+    // Record of one position and move in the file
+    struct Entry;
+
+private:
+    const Entry *entries = nullptr;
+    size_t count = 0;
+    size_t mappedSize = 0;
+};
+
+} // namespace AdiChess::Explorer
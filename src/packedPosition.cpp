@@ -0,0 +1,183 @@
+#include "packedPosition.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace AdiChess {
+
+namespace {
+
+constexpr uint8_t SIDE_BIT = 0b1;
+constexpr int CASTLING_SHIFT = 1;
+constexpr uint8_t SCORE_BIT = 0b100000;
+constexpr uint8_t NO_EN_PASSANT = 64;
+
+// Records per buffer, 1 MiB of positions
+constexpr size_t BUFFER_RECORDS = 1 << 15;
+
+// Reads or writes the whole range, retrying short transfers
+template <typename Transfer>
+size_t transferAll(Transfer transfer, int fd, char *bytes, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t result = transfer(fd, bytes + done, size - done);
+        if (result <= 0) {
+            break;
+        }
+        done += result;
+    }
+    return done;
+}
+
+} // namespace
+
+void PackedPosition::setScore(int score_, int result_) {
+    score = static_cast<int16_t>(
+        std::clamp(score_, INT16_MIN + 0, INT16_MAX + 0));
+    result = static_cast<int8_t>(result_);
+    flags |= SCORE_BIT;
+}
+
+PackedPosition pack(Board const &board) {
+    PackedPosition packed;
+
+    uint64_t pieceCodes[Piece::Type::NUM_PIECES][Side::NUM_SIDES];
+    for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+        for (int side = Side::W; side < Side::NUM_SIDES; ++side) {
+            uint64_t positions = board.getPositions(
+                static_cast<Piece::Type>(type), static_cast<Side>(side));
+            pieceCodes[type][side] = positions;
+            packed.occupied |= positions;
+        }
+    }
+
+    // Piece codes follow the occupancy in ascending square order
+    assert(Utility::popCnt(packed.occupied) <= 32);
+    uint64_t occupied = packed.occupied;
+    for (int i = 0; occupied && i < 32; ++i) {
+        uint64_t bit = 1ULL << Utility::bitScanPop(occupied);
+        uint8_t code = 0;
+        for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+            if (pieceCodes[type][Side::W] & bit) {
+                code = type;
+            } else if (pieceCodes[type][Side::B] & bit) {
+                code = type | 0b1000;
+            }
+        }
+        packed.pieces[i / 2] |= code << (4 * (i % 2));
+    }
+
+    packed.flags = (board.getCurrentPlayer() == Side::B ? SIDE_BIT : 0) |
+                   board.getCastlingRights() << CASTLING_SHIFT;
+    uint64_t enPassantTarget = board.getEnPassantTarget();
+    packed.enPassant = enPassantTarget < 64 ? enPassantTarget : NO_EN_PASSANT;
+    packed.halfMoveClock = std::min(board.getHalfMoveClock(), 255);
+    packed.fullMoveNumber = std::min(board.getFullMoveNumber(), 65535);
+    return packed;
+}
+
+void unpack(PackedPosition const &packed, Board &board) {
+    board.clear(packed.flags & SIDE_BIT ? Side::B : Side::W,
+                (packed.flags >> CASTLING_SHIFT) & 0b1111,
+                packed.enPassant < 64 ? packed.enPassant : -1,
+                packed.halfMoveClock, packed.fullMoveNumber);
+
+    uint64_t occupied = packed.occupied;
+    for (int i = 0; occupied && i < 32; ++i) {
+        uint64_t position = Utility::bitScanPop(occupied);
+        uint8_t code = (packed.pieces[i / 2] >> (4 * (i % 2))) & 0b1111;
+        board(position, Piece(static_cast<Piece::Type>(code & 0b111),
+                              code & 0b1000 ? Side::B : Side::W));
+    }
+}
+
+PackedWriter::PackedWriter(std::string const &path, bool append) {
+    fd = ::open(path.c_str(),
+                O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+    buffer.reserve(BUFFER_RECORDS);
+}
+
+PackedWriter::~PackedWriter() {
+    if (fd >= 0) {
+        flush();
+        ::close(fd);
+    }
+}
+
+bool PackedWriter::write(PackedPosition const &position) {
+    buffer.push_back(position);
+    ++count;
+    return buffer.size() < BUFFER_RECORDS || flush();
+}
+
+bool PackedWriter::write(PackedPosition const *positions, size_t count_) {
+    for (size_t i = 0; i < count_; ++i) {
+        if (!write(positions[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PackedWriter::flush() {
+    if (fd < 0) {
+        return false;
+    }
+    size_t size = buffer.size() * sizeof(PackedPosition);
+    size_t written = transferAll(::write, fd,
+                                 reinterpret_cast<char *>(buffer.data()), size);
+    buffer.clear();
+    return written == size;
+}
+
+PackedReader::PackedReader(std::string const &path) {
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        // Records are only ever read front to back
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    buffer.resize(BUFFER_RECORDS);
+}
+
+PackedReader::~PackedReader() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+bool PackedReader::refill() {
+    if (fd < 0) {
+        return false;
+    }
+    size_t read = transferAll(::read, fd,
+                              reinterpret_cast<char *>(buffer.data()),
+                              buffer.size() * sizeof(PackedPosition));
+    // A truncated trailing record is dropped
+    begin = 0;
+    end = read / sizeof(PackedPosition);
+    return end > 0;
+}
+
+bool PackedReader::next(PackedPosition &position) {
+    if (begin == end && !refill()) {
+        return false;
+    }
+    position = buffer[begin++];
+    return true;
+}
+
+size_t PackedReader::read(PackedPosition *positions, size_t count) {
+    size_t done = 0;
+    while (done < count && (begin < end || refill())) {
+        size_t available = std::min(count - done, end - begin);
+        std::memcpy(positions + done, buffer.data() + begin,
+                    available * sizeof(PackedPosition));
+        begin += available;
+        done += available;
+    }
+    return done;
+}
+
+} // namespace AdiChess
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "board.h"
+
+#include <string>
+#include <vector>
+
+// Fixed size binary positions for training data. Each record is 32 bytes: the
+// occupancy bitboard, a 4 bit code for every occupied square in ascending
+// square order, the irreversible state and an optional score and game result.
+// Records are stored in host (little endian) byte order.
+
+namespace AdiChess {
+
+struct PackedPosition {
+    uint64_t occupied = 0;
+    // Two piece codes per byte, low nibble first. Codes are the piece type
+    // with the side in bit 3.
+    uint8_t pieces[16] = {0};
+    // Side to move in bit 0, castling rights in bits 1 to 4 and whether the
+    // score and result are set in bit 5
+    uint8_t flags = 0;
+    // En passant target square, 64 when there is none
+    uint8_t enPassant = 64;
+    uint8_t halfMoveClock = 0;
+    // Game result from white's point of view: 1 win, 0 draw, -1 loss
+    int8_t result = 0;
+    uint16_t fullMoveNumber = 1;
+    // Centipawns from the side to move's point of view
+    int16_t score = 0;
+
+    bool hasScore() const { return flags & 0b100000; }
+    void setScore(int score_, int result_);
+};
+
+static_assert(sizeof(PackedPosition) == 32, "Packed positions are 32 bytes");
+
+PackedPosition pack(Board const &board);
+// Replaces the contents of board with the packed position
+void unpack(PackedPosition const &packed, Board &board);
+
+// Appends positions to a file through a large buffer, written sequentially
+class PackedWriter {
+public:
+    explicit PackedWriter(std::string const &path, bool append = false);
+    ~PackedWriter();
+    PackedWriter(const PackedWriter &) = delete;
+    PackedWriter &operator=(const PackedWriter &) = delete;
+
+    bool isOpen() const { return fd >= 0; }
+    bool write(PackedPosition const &position);
+    bool write(PackedPosition const *positions, size_t count);
+    bool flush();
+    size_t written() const { return count; }
+
+private:
+    int fd = -1;
+    std::vector<PackedPosition> buffer;
+    size_t count = 0;
+};
+
+// Reads positions back in order, a buffer at a time
+class PackedReader {
+public:
+    explicit PackedReader(std::string const &path);
+    ~PackedReader();
+    PackedReader(const PackedReader &) = delete;
+    PackedReader &operator=(const PackedReader &) = delete;
+
+    bool isOpen() const { return fd >= 0; }
+    // Fills position with the next record, false at end of file
+    bool next(PackedPosition &position);
+    // Reads up to count records, returns the number read
+    size_t read(PackedPosition *positions, size_t count);
+
+private:
+    bool refill();
+
+    int fd = -1;
+    std::vector<PackedPosition> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+} // namespace AdiChess
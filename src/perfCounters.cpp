@@ -0,0 +1,223 @@
+#include "perfCounters.h"
+
+#include <iomanip>
+
+#if PERF_COUNTERS
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#endif
+
+namespace AdiChess::Profile {
+
+namespace {
+
+const char *REGION_NAMES[NUM_REGIONS] = {"Move generation", "Make/unmake",
+                                         "Legality", "Evaluation", "Search"};
+const char *COUNTER_NAMES[NUM_COUNTERS] = {"Cycles", "Instructions",
+                                           "Branch misses", "Cache misses"};
+
+#if PERF_COUNTERS
+
+constexpr Region NO_REGION = NUM_REGIONS;
+
+constexpr uint64_t EVENTS[NUM_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+
+// Reads a counter from user space with rdpmc, false when the kernel does not
+// allow it or the counter is not on the PMU at the moment
+bool readUserCounter(perf_event_mmap_page const *page, uint64_t &value) {
+#if defined(__x86_64__)
+    uint32_t sequence;
+    do {
+        sequence = page->lock;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        const uint32_t index = page->index;
+        if (!page->cap_user_rdpmc || !index) {
+            return false;
+        }
+        int64_t count = __builtin_ia32_rdpmc(index - 1);
+        const unsigned shift = 64 - page->pmc_width;
+        count = static_cast<int64_t>(static_cast<uint64_t>(count) << shift) >>
+                shift;
+        value = page->offset + count;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    } while (page->lock != sequence);
+    return true;
+#else
+    (void)page;
+    (void)value;
+    return false;
+#endif
+}
+
+struct ThreadCounters {
+    int fds[NUM_COUNTERS] = {-1, -1, -1, -1};
+    perf_event_mmap_page *pages[NUM_COUNTERS] = {nullptr};
+    // Counter values at the last region boundary
+    uint64_t last[NUM_COUNTERS] = {0};
+    Region current = NO_REGION;
+    Totals totals;
+
+    ~ThreadCounters() { close(); }
+
+    bool open() {
+        close();
+        totals = Totals();
+        bool any = false;
+        const long pageSize = sysconf(_SC_PAGESIZE);
+        for (int counter = 0; counter < NUM_COUNTERS; ++counter) {
+            perf_event_attr attributes;
+            std::memset(&attributes, 0, sizeof(attributes));
+            attributes.size = sizeof(attributes);
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.config = EVENTS[counter];
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            fds[counter] = syscall(SYS_perf_event_open, &attributes, 0, -1, -1,
+                                   PERF_FLAG_FD_CLOEXEC);
+            if (fds[counter] < 0) {
+                continue;
+            }
+            void *page = mmap(nullptr, pageSize, PROT_READ, MAP_SHARED,
+                              fds[counter], 0);
+            pages[counter] = page == MAP_FAILED
+                                 ? nullptr
+                                 : static_cast<perf_event_mmap_page *>(page);
+            totals.available[counter] = true;
+            any = true;
+        }
+        read(last);
+        return any;
+    }
+
+    void close() {
+        const long pageSize = sysconf(_SC_PAGESIZE);
+        for (int counter = 0; counter < NUM_COUNTERS; ++counter) {
+            if (pages[counter]) {
+                munmap(pages[counter], pageSize);
+                pages[counter] = nullptr;
+            }
+            if (fds[counter] >= 0) {
+                ::close(fds[counter]);
+                fds[counter] = -1;
+            }
+        }
+    }
+
+    void read(uint64_t values[NUM_COUNTERS]) const {
+        for (int counter = 0; counter < NUM_COUNTERS; ++counter) {
+            values[counter] = 0;
+            if (fds[counter] < 0 ||
+                (pages[counter] &&
+                 readUserCounter(pages[counter], values[counter]))) {
+                continue;
+            }
+            if (::read(fds[counter], &values[counter], sizeof(uint64_t)) !=
+                sizeof(uint64_t)) {
+                values[counter] = last[counter];
+            }
+        }
+    }
+
+    // Charges the events since the last boundary to the current region
+    void charge() {
+        uint64_t now[NUM_COUNTERS];
+        read(now);
+        if (current != NO_REGION) {
+            for (int counter = 0; counter < NUM_COUNTERS; ++counter) {
+                totals.counts[current][counter] += now[counter] - last[counter];
+            }
+        }
+        std::memcpy(last, now, sizeof(last));
+    }
+};
+
+thread_local ThreadCounters counters;
+
+#endif
+
+} // namespace
+
+#if PERF_COUNTERS
+
+Scope::Scope(Region region) : parent{counters.current} {
+    counters.charge();
+    counters.current = region;
+    ++counters.totals.entries[region];
+}
+
+Scope::~Scope() {
+    counters.charge();
+    counters.current = parent;
+}
+
+bool enable() { return counters.open(); }
+
+void disable() { counters.close(); }
+
+Totals totals() { return counters.totals; }
+
+#else
+
+bool enable() { return false; }
+
+void disable() {}
+
+Totals totals() { return Totals(); }
+
+#endif
+
+void report(std::ostream &output) {
+    if (!PERF_COUNTERS) {
+        return;
+    }
+    Totals result = totals();
+    const auto flags = output.flags();
+    const auto precision = output.precision();
+    bool any = false;
+    output << std::left << std::setw(16) << "Region" << std::right
+           << std::setw(14) << "Entries";
+    for (int counter = 0; counter < NUM_COUNTERS; ++counter) {
+        output << std::setw(16) << COUNTER_NAMES[counter];
+        any = any || result.available[counter];
+    }
+    output << std::setw(8) << "IPC" << "\n";
+
+    for (int region = 0; region < NUM_REGIONS; ++region) {
+        auto const &counts = result.counts[region];
+        output << std::left << std::setw(16) << REGION_NAMES[region]
+               << std::right << std::setw(14) << result.entries[region];
+        for (int counter = 0; counter < NUM_COUNTERS; ++counter) {
+            output << std::setw(16);
+            if (result.available[counter]) {
+                output << counts[counter];
+            } else {
+                output << "n/a";
+            }
+        }
+        output << std::setw(8);
+        if (result.available[CYCLES] && result.available[INSTRUCTIONS] &&
+            counts[CYCLES]) {
+            output << std::fixed << std::setprecision(2)
+                   << static_cast<double>(counts[INSTRUCTIONS]) /
+                          counts[CYCLES];
+        } else {
+            output << "n/a";
+        }
+        output << "\n";
+    }
+    if (!any) {
+        output << "Hardware counters unavailable, region entries only\n";
+    }
+    output.flags(flags);
+    output.precision(precision);
+    output << std::flush;
+}
+
+} // namespace AdiChess::Profile
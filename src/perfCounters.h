@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+// Hardware counters per region of the engine, read through Linux
+// perf_event_open. Built in with -DUSE_PERF_COUNTERS=ON, otherwise
+// PROFILE_REGION expands to nothing and the hot paths are unchanged.
+//
+// Counts are exclusive: the counters are read on entering and leaving every
+// region and the events in between go to the innermost open region, so the
+// search region holds what the search does outside move generation, making
+// moves, legality and evaluation.
+
+#ifndef PERF_COUNTERS
+#define PERF_COUNTERS 0
+#endif
+
+namespace AdiChess::Profile {
+
+enum Region {
+    MOVE_GENERATION,
+    MAKE_UNMAKE,
+    LEGALITY,
+    EVALUATION,
+    SEARCH,
+    NUM_REGIONS
+};
+
+enum Counter { CYCLES, INSTRUCTIONS, BRANCH_MISSES, CACHE_MISSES, NUM_COUNTERS };
+
+struct Totals {
+    uint64_t counts[NUM_REGIONS][NUM_COUNTERS] = {{0}};
+    uint64_t entries[NUM_REGIONS] = {0};
+    // Counters the kernel would not open, virtual machines often lack them
+    bool available[NUM_COUNTERS] = {false};
+};
+
+// Opens the counters for the calling thread and clears its totals. False
+// when not built in or when no counter could be opened, regions are still
+// entered and counted.
+bool enable();
+void disable();
+
+// Totals of the calling thread
+Totals totals();
+
+// Table of counts and rates per region, nothing when not built in
+void report(std::ostream &output);
+
+#if PERF_COUNTERS
+
+class Scope {
+public:
+    explicit Scope(Region region);
+    ~Scope();
+    Scope(Scope const &) = delete;
+    Scope &operator=(Scope const &) = delete;
+
+private:
+    Region parent;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_REGION(region)                                                 \
+    ::AdiChess::Profile::Scope PROFILE_CONCAT(profileScope, __LINE__)(         \
+        ::AdiChess::Profile::region)
+
+#else
+
+#define PROFILE_REGION(region)
+
+#endif
+
+} // namespace AdiChess::Profile
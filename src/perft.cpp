@@ -0,0 +1,130 @@
+#include "perft.h"
+#include "moveGenerator.h"
+
+namespace AdiChess {
+
+template <Side Us> static uint64_t perft(Board &board, int depth) {
+    uint64_t nodes = 0;
+    MoveGeneration::MoveGenerator moveGenerator(board);
+
+    for (auto const &move : moveGenerator) {
+        if (!board.legalMove<Us>(move)) {
+            continue;
+        }
+        // Bulk count: every legal move at the last ply is a leaf
+        if (depth == 1) {
+            ++nodes;
+        } else {
+            board.makeMove<Us>(move);
+            nodes += perft<~Us>(board, depth - 1);
+            board.unmakeMove<Us>(move);
+        }
+    }
+
+    return nodes;
+}
+
+template <Side Us>
+static uint64_t perft(Position const &position, int depth) {
+    MoveList moves;
+    position.generateMoves<Us>(moves);
+    // Moves are generated legal, the last ply is counted without playing it
+    if (depth == 1) {
+        return moves.size();
+    }
+
+    uint64_t nodes = 0;
+    for (auto const &move : moves) {
+        Position child = position;
+        child.makeMove<Us>(move);
+        nodes += perft<~Us>(child, depth - 1);
+    }
+    return nodes;
+}
+
+uint64_t perft(Board &board, int depth) {
+    if (depth == 0) {
+        return 1;
+    }
+    return board.getCurrentPlayer() == Side::W ? perft<Side::W>(board, depth)
+                                               : perft<Side::B>(board, depth);
+}
+
+uint64_t perft(Position const &position, int depth) {
+    if (depth == 0) {
+        return 1;
+    }
+    return position.getCurrentPlayer() == Side::W
+               ? perft<Side::W>(position, depth)
+               : perft<Side::B>(position, depth);
+}
+
+std::vector<std::pair<Move, uint64_t>> divide(Board &board, int depth) {
+    std::vector<std::pair<Move, uint64_t>> counts;
+    if (depth == 0) {
+        return counts;
+    }
+
+    MoveGeneration::MoveGenerator moveGenerator(board);
+    for (auto const &move : moveGenerator) {
+        if (board.legalMove(move)) {
+            board.makeMove(move);
+            counts.emplace_back(move, perft(board, depth - 1));
+            board.unmakeMove(move);
+        }
+    }
+
+    return counts;
+}
+
+std::vector<std::pair<Move, uint64_t>> divide(Position const &position,
+                                              int depth) {
+    std::vector<std::pair<Move, uint64_t>> counts;
+    if (depth == 0) {
+        return counts;
+    }
+
+    MoveList moves;
+    position.generateMoves(moves);
+    for (auto const &move : moves) {
+        Position child = position;
+        child.makeMove(move);
+        counts.emplace_back(move, perft(child, depth - 1));
+    }
+
+    return counts;
+}
+
+std::string moveToString(Move const &move, Side const &side) {
+    uint64_t from = move.getFrom();
+    uint64_t to = move.getTo();
+
+    // Castling moves carry no squares, derive them from the side to move
+    if (move.getFlag() == Move::KING_CASTLE ||
+        move.getFlag() == Move::QUEEN_CASTLE) {
+        from = side == Side::W ? MoveGeneration::e1 : MoveGeneration::e8;
+        to = from + (move.getFlag() == Move::KING_CASTLE ? -2 : 2);
+    }
+
+    std::string str = MoveGeneration::positionToString(from) +
+                      MoveGeneration::positionToString(to);
+
+    switch (move.getFlag()) {
+    case Move::KNIGHT_PROMOTION:
+    case Move::KNIGHT_PROMO_CAPTURE:
+        return str + "n";
+    case Move::BISHOP_PROMOTION:
+    case Move::BISHOP_PROMO_CAPTURE:
+        return str + "b";
+    case Move::ROOK_PROMOTION:
+    case Move::ROOK_PROMO_CAPTURE:
+        return str + "r";
+    case Move::QUEEN_PROMOTION:
+    case Move::QUEEN_PROMO_CAPTURE:
+        return str + "q";
+    }
+
+    return str;
+}
+
+} // namespace AdiChess
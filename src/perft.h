@@ -0,0 +1,25 @@
+#pragma once
+
+#include "board.h"
+#include "position.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace AdiChess {
+
+// Counts leaf nodes of the legal move tree. Leaves are counted in bulk at the
+// last ply rather than making and unmaking every leaf move.
+uint64_t perft(Board &board, int depth);
+// Same count with copy-make, each ply plays moves on a copy of its position
+uint64_t perft(Position const &position, int depth);
+
+// Per root move leaf counts, in move generation order.
+std::vector<std::pair<Move, uint64_t>> divide(Board &board, int depth);
+std::vector<std::pair<Move, uint64_t>> divide(Position const &position,
+                                              int depth);
+
+std::string moveToString(Move const &move, Side const &side);
+
+} // namespace AdiChess
@@ -0,0 +1,281 @@
+#include "pgn.h"
+#include "moveGenerator.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>
+
+namespace AdiChess::Pgn {
+
+namespace {
+
+bool isSpace(char c) { return std::isspace(static_cast<unsigned char>(c)); }
+
+int square(char file, char rank) { return (rank - '1') * 8 + 7 - (file - 'a'); }
+
+bool isFile(char c) { return c >= 'a' && c <= 'h'; }
+
+bool isRank(char c) { return c >= '1' && c <= '8'; }
+
+Piece::Type pieceType(char c) {
+    switch (c) {
+    case 'K':
+        return Piece::Type::K;
+    case 'Q':
+        return Piece::Type::Q;
+    case 'R':
+        return Piece::Type::R;
+    case 'B':
+        return Piece::Type::B;
+    case 'N':
+        return Piece::Type::N;
+    default:
+        return Piece::Type::NONE;
+    }
+}
+
+Result parseResult(std::string_view text) {
+    if (text == "1-0") {
+        return WHITE_WINS;
+    }
+    if (text == "0-1") {
+        return BLACK_WINS;
+    }
+    if (text == "1/2-1/2") {
+        return DRAW;
+    }
+    return UNKNOWN;
+}
+
+bool castling(std::string_view san) {
+    return san.substr(0, 3) == "O-O" || san.substr(0, 3) == "0-0";
+}
+
+} // namespace
+
+std::string_view tag(Game const &game, std::string_view name) {
+    std::string key = "[" + std::string(name) + " \"";
+    size_t begin = game.tags.find(key);
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    begin += key.size();
+    size_t end = game.tags.find('"', begin);
+    return game.tags.substr(begin, end == std::string_view::npos ? end
+                                                                  : end - begin);
+}
+
+std::optional<Move> parseSan(Board &board, std::string_view san) {
+    while (!san.empty() && std::string_view("+#!?").find(san.back()) !=
+                               std::string_view::npos) {
+        san.remove_suffix(1);
+    }
+
+    MoveGeneration::MoveGenerator moveGenerator(board);
+    if (castling(san)) {
+        auto flag = san.size() >= 5 ? Move::QUEEN_CASTLE : Move::KING_CASTLE;
+        for (auto const &move : moveGenerator) {
+            if (move.getFlag() == flag && board.legalMove(move)) {
+                return move;
+            }
+        }
+        return std::nullopt;
+    }
+
+    Piece::Type piece = Piece::Type::P;
+    if (!san.empty() && pieceType(san.front()) != Piece::Type::NONE) {
+        piece = pieceType(san.front());
+        san.remove_prefix(1);
+    }
+    Piece::Type promotion = Piece::Type::NONE;
+    if (!san.empty() && pieceType(san.back()) != Piece::Type::NONE) {
+        promotion = pieceType(san.back());
+        san.remove_suffix(san.size() >= 2 && san[san.size() - 2] == '=' ? 2 : 1);
+    }
+    if (san.size() < 2 || !isFile(san[san.size() - 2]) ||
+        !isRank(san.back())) {
+        return std::nullopt;
+    }
+    const uint64_t to = square(san[san.size() - 2], san.back());
+    // Whatever precedes the destination disambiguates the origin
+    int fromFile = -1;
+    int fromRank = -1;
+    for (char c : san.substr(0, san.size() - 2)) {
+        if (isFile(c)) {
+            fromFile = c - 'a';
+        } else if (isRank(c)) {
+            fromRank = c - '1';
+        } else if (c != 'x' && c != ':' && c != '-') {
+            return std::nullopt;
+        }
+    }
+
+    std::optional<Move> found;
+    for (auto const &move : moveGenerator) {
+        auto flag = move.getFlag();
+        if (move.getTo() != to || flag == Move::KING_CASTLE ||
+            flag == Move::QUEEN_CASTLE) {
+            continue;
+        }
+        const uint64_t from = move.getFrom();
+        if (board(from).type != piece ||
+            (fromFile >= 0 && static_cast<int>(7 - from % 8) != fromFile) ||
+            (fromRank >= 0 && static_cast<int>(from / 8) != fromRank) ||
+            (move.isPromotion() ? promotionType(move) != promotion
+                                : promotion != Piece::Type::NONE)) {
+            continue;
+        }
+        if (board.legalMove(move)) {
+            // Ambiguous moves are rejected
+            if (found) {
+                return std::nullopt;
+            }
+            found = move;
+        }
+    }
+    return found;
+}
+
+bool replay(Board &board, std::string_view movetext, int maxPlies,
+            std::function<void(Board const &, Move const &)> const &visit) {
+    int plies = 0;
+    size_t i = 0;
+    while (i < movetext.size() && plies < maxPlies) {
+        char c = movetext[i];
+        if (isSpace(c) || c == ')') {
+            ++i;
+        } else if (c == '{') {
+            size_t end = movetext.find('}', i);
+            i = end == std::string_view::npos ? movetext.size() : end + 1;
+        } else if (c == ';' || c == '%') {
+            size_t end = movetext.find('\n', i);
+            i = end == std::string_view::npos ? movetext.size() : end + 1;
+        } else if (c == '(') {
+            // Variations nest
+            int depth = 0;
+            for (; i < movetext.size(); ++i) {
+                if (movetext[i] == '{') {
+                    i = std::min(movetext.find('}', i), movetext.size() - 1);
+                }
+                depth += (movetext[i] == '(') - (movetext[i] == ')');
+                if (depth == 0) {
+                    break;
+                }
+            }
+            ++i;
+        } else if (c == '*') {
+            return true;
+        } else {
+            size_t end = i;
+            while (end < movetext.size() && !isSpace(movetext[end]) &&
+                   std::string_view("{(;)").find(movetext[end]) ==
+                       std::string_view::npos) {
+                ++end;
+            }
+            std::string_view token = movetext.substr(i, end - i);
+            i = end;
+            if (c == '$' || parseResult(token) != UNKNOWN) {
+                continue;
+            }
+            // Move numbers, possibly written against the move
+            if (!castling(token)) {
+                size_t number = 0;
+                while (number < token.size() &&
+                       (std::isdigit(static_cast<unsigned char>(token[number])) ||
+                        token[number] == '.')) {
+                    ++number;
+                }
+                token.remove_prefix(number);
+            }
+            if (token.empty()) {
+                continue;
+            }
+            auto move = parseSan(board, token);
+            if (!move) {
+                return false;
+            }
+            if (visit) {
+                visit(board, *move);
+            }
+            board.makeMove(*move);
+            ++plies;
+        }
+    }
+    return true;
+}
+
+bool nextGame(std::string_view &text, Game &game) {
+    size_t begin = 0;
+    while (begin < text.size() && isSpace(text[begin])) {
+        ++begin;
+    }
+    if (begin == text.size()) {
+        text = {};
+        return false;
+    }
+
+    // Tag pairs, one per line
+    size_t tagsEnd = begin;
+    while (tagsEnd < text.size() && text[tagsEnd] == '[') {
+        size_t lineEnd = text.find('\n', tagsEnd);
+        tagsEnd = lineEnd == std::string_view::npos ? text.size() : lineEnd + 1;
+        while (tagsEnd < text.size() && isSpace(text[tagsEnd])) {
+            ++tagsEnd;
+        }
+    }
+    // The movetext runs up to the tags of the next game
+    size_t end = text.find("\n[", tagsEnd);
+    end = end == std::string_view::npos ? text.size() : end + 1;
+
+    game.tags = text.substr(begin, tagsEnd - begin);
+    game.movetext = text.substr(tagsEnd, end - tagsEnd);
+    game.result = parseResult(tag(game, "Result"));
+    text.remove_prefix(end);
+    return true;
+}
+
+Reader::Reader(std::string const &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+        void *mapped =
+            mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped != MAP_FAILED) {
+            madvise(mapped, fileStat.st_size, MADV_SEQUENTIAL);
+            data = static_cast<const char *>(mapped);
+            size = fileStat.st_size;
+        }
+    }
+    ::close(fd);
+}
+
+Reader::~Reader() {
+    if (data) {
+        munmap(const_cast<char *>(data), size);
+    }
+}
+
+std::vector<std::string_view> Reader::split(int count) const {
+    std::vector<std::string_view> parts;
+    std::string_view all = text();
+    size_t begin = 0;
+    for (int part = 1; part <= count && begin < all.size(); ++part) {
+        size_t end = all.size();
+        if (part < count) {
+            // Every game opens with its Event tag
+            end = all.find("\n[Event ", std::max(begin, all.size() * part / count));
+            end = end == std::string_view::npos ? all.size() : end + 1;
+        }
+        parts.push_back(all.substr(begin, end - begin));
+        begin = end;
+    }
+    return parts;
+}
+
+} // namespace AdiChess::Pgn
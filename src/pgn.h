@@ -0,0 +1,58 @@
+#pragma once
+
+#include "board.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Reading games from PGN files. The file is memory mapped and games are
+// string views into it, moves are resolved against the generated legal moves.
+
+namespace AdiChess::Pgn {
+
+// White's point of view, UNKNOWN for unfinished games
+enum Result : int8_t { BLACK_WINS = -1, DRAW = 0, WHITE_WINS = 1, UNKNOWN = 2 };
+
+struct Game {
+    std::string_view tags;
+    std::string_view movetext;
+    Result result = UNKNOWN;
+};
+
+// Value of a tag, empty when the game does not have it
+std::string_view tag(Game const &game, std::string_view name);
+
+// Legal move of the side to move written in SAN, check and annotation
+// suffixes are accepted
+std::optional<Move> parseSan(Board &board, std::string_view san);
+
+// Plays up to maxPlies moves of the movetext on board, calling visit with
+// the position before every move. Move numbers, comments, variations and
+// NAGs are skipped. False when a move cannot be played.
+bool replay(Board &board, std::string_view movetext, int maxPlies,
+            std::function<void(Board const &, Move const &)> const &visit);
+
+// Takes the next game off the front of text, false once no game is left
+bool nextGame(std::string_view &text, Game &game);
+
+class Reader {
+public:
+    explicit Reader(std::string const &path);
+    ~Reader();
+    Reader(Reader const &) = delete;
+    Reader &operator=(Reader const &) = delete;
+
+    bool isOpen() const { return data != nullptr; }
+    std::string_view text() const { return {data, size}; }
+    // Splits the text into up to count parts that each start at a game
+    std::vector<std::string_view> split(int count) const;
+
+private:
+    const char *data = nullptr;
+    size_t size = 0;
+};
+
+} // namespace AdiChess::Pgn
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <string>
 #include "moveUtils.h"
 
@@ -7,6 +9,11 @@ namespace AdiChess {
         W=0, B=1, NUM_SIDES=2, NONE=3
     };
 
+    // Opposing side, usable as a template argument
+    constexpr Side operator~(Side side) {
+        return static_cast<Side>(side ^ Side::B);
+    }
+
     struct Piece {
     
         enum Type {
@@ -49,4 +56,12 @@ namespace AdiChess {
 
     };
 
+    // Piece a promotion promotes to, the flags list knight, bishop, rook and
+    // queen for both plain promotions and promotion captures
+    inline Piece::Type promotionType(Move const &move) {
+        static const Piece::Type types[] = {Piece::Type::N, Piece::Type::B,
+                                            Piece::Type::R, Piece::Type::Q};
+        return types[(move.getFlag() - Move::KNIGHT_PROMOTION) % 4];
+    }
+
 };
\ No newline at end of file
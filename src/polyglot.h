@@ -0,0 +1,57 @@
+#pragma once
+
+#include "board.h"
+
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+// Polyglot opening book support. Books are memory mapped and probed by binary
+// search over their key sorted entries.
+
+namespace AdiChess::Polyglot {
+
+struct Entry {
+    uint64_t key;
+    uint16_t move;
+    uint16_t weight;
+    uint32_t learn;
+};
+
+// Zobrist key of the position in the Polyglot layout
+uint64_t computeKey(Board const &board);
+
+// Polyglot move encoding, castling is encoded as the king capturing its rook
+uint16_t encodeMove(Move const &move, Side const &side);
+// Resolves a Polyglot move against the legal moves of the position
+std::optional<Move> decodeMove(uint16_t polyglotMove, Board &board);
+
+// Writes entries to a book file, sorting them by key first
+bool writeBook(std::string const &path, std::vector<Entry> entries);
+
+class Book {
+public:
+    explicit Book(std::string const &path);
+    ~Book();
+    Book(const Book &) = delete;
+    Book &operator=(const Book &) = delete;
+
+    bool isOpen() const { return entries != nullptr; }
+    size_t size() const { return entryCount; }
+
+    // All entries for the position, in book order
+    std::vector<Entry> lookup(uint64_t key) const;
+    // Legal book move picked at random in proportion to its weight
+    std::optional<Move> probe(Board &board);
+
+private:
+    Entry readEntry(size_t index) const;
+
+    const unsigned char *entries = nullptr;
+    size_t entryCount = 0;
+    size_t mappedSize = 0;
+    std::mt19937_64 generator;
+};
+
+} // namespace AdiChess::Polyglot
@@ -0,0 +1,384 @@
+#include "position.h"
+#include "perfCounters.h"
+#include "zobrist.h"
+
+#include <array>
+#include <cstring>
+
+namespace AdiChess {
+
+namespace {
+
+using namespace MoveGeneration;
+
+constexpr uint8_t EMPTY = Piece::Type::NONE;
+
+// Castling rights kept after a move from or to each position [kqKQ]
+constexpr std::array<uint8_t, 64> generateCastlingMasks() {
+    std::array<uint8_t, 64> masks{};
+    for (auto &mask : masks) {
+        mask = 0b1111;
+    }
+    masks[h1] = 0b1101;
+    masks[a1] = 0b1110;
+    masks[e1] = 0b1100;
+    masks[h8] = 0b0111;
+    masks[a8] = 0b1011;
+    masks[e8] = 0b0011;
+    return masks;
+}
+
+constexpr std::array<uint8_t, 64> CASTLING_MASKS = generateCastlingMasks();
+
+// Attacks along one ray stopping on and including the first blocker
+uint64_t rayAttack(Direction direction, int position, uint64_t occupied) {
+    uint64_t attacks = rayAttacks[direction][position];
+    uint64_t blockers = attacks & occupied;
+    if (blockers) {
+        // West and north rays run towards higher positions
+        bool increasing = direction == Direction::NW ||
+                          direction == Direction::N ||
+                          direction == Direction::NE ||
+                          direction == Direction::W;
+        uint64_t blocker = increasing ? Utility::bitScanForward(blockers)
+                                      : Utility::bitScanReverse(blockers);
+        attacks ^= rayAttacks[direction][blocker];
+    }
+    return attacks;
+}
+
+uint64_t rookAttacks(int position, uint64_t occupied) {
+    return rayAttack(Direction::N, position, occupied) |
+           rayAttack(Direction::E, position, occupied) |
+           rayAttack(Direction::S, position, occupied) |
+           rayAttack(Direction::W, position, occupied);
+}
+
+uint64_t bishopAttacks(int position, uint64_t occupied) {
+    return rayAttack(Direction::NW, position, occupied) |
+           rayAttack(Direction::NE, position, occupied) |
+           rayAttack(Direction::SE, position, occupied) |
+           rayAttack(Direction::SW, position, occupied);
+}
+
+template <int Offset>
+void serializePawnMoves(MoveList &moves, uint64_t targets, Move::Flag flag) {
+    while (targets) {
+        int to = Utility::bitScanPop(targets);
+        moves.push(Move(to - Offset, to, flag));
+    }
+}
+
+// Promotions of every kind, flag is the knight promotion or promotion capture
+template <int Offset>
+void serializePromotions(MoveList &moves, uint64_t targets, int flag) {
+    while (targets) {
+        int to = Utility::bitScanPop(targets);
+        for (int promotion = 0; promotion < 4; ++promotion) {
+            moves.push(Move(to - Offset, to, flag + promotion));
+        }
+    }
+}
+
+} // namespace
+
+Position::Position(Board const &board)
+    : castlingRights{board.getCastlingRights()},
+      sideToMove{static_cast<uint8_t>(board.getCurrentPlayer())},
+      halfMoveClock{static_cast<uint8_t>(board.getHalfMoveClock())},
+      fullMoveNumber{static_cast<uint16_t>(board.getFullMoveNumber())} {
+    std::memset(mailbox, EMPTY | EMPTY << 4, sizeof(mailbox));
+    for (int position = 0; position < 64; ++position) {
+        Piece piece = board(position);
+        if (piece.type != Piece::Type::NONE) {
+            putPiece(position, piece.type, piece.side);
+        }
+    }
+    if (board.getEnPassantTarget() < 64) {
+        enPassant = board.getEnPassantTarget();
+        key ^= ZOBRIST.enPassantFiles[enPassant % 8];
+    }
+    key ^= ZOBRIST.castlingRights[castlingRights];
+    if (sideToMove == Side::B) {
+        key ^= ZOBRIST.side;
+    }
+}
+
+Position::Position(std::string const &fenString)
+    : Position(Board(fenString)) {}
+
+Piece Position::operator()(int position) const {
+    uint8_t code = mailbox[position / 2] >> (4 * (position % 2)) & 0xF;
+    return code == EMPTY ? Piece(Piece::Type::NONE, Side::NONE)
+                         : Piece(static_cast<Piece::Type>(code & 0b111),
+                                 static_cast<Side>(code >> 3));
+}
+
+Piece::Type Position::typeOn(int position) const {
+    return static_cast<Piece::Type>(mailbox[position / 2] >>
+                                        (4 * (position % 2)) &
+                                    0b111);
+}
+
+void Position::putPiece(int position, Piece::Type type, Side side) {
+    const uint64_t bit = 1ULL << position;
+    pieces[type] |= bit;
+    sides[side] |= bit;
+    const int shift = 4 * (position % 2);
+    mailbox[position / 2] = (mailbox[position / 2] & ~(0xF << shift)) |
+                            ((type | side << 3) << shift);
+    key ^= ZOBRIST.pieces[type][side][position];
+}
+
+void Position::removePiece(int position, Piece::Type type, Side side) {
+    const uint64_t bit = 1ULL << position;
+    pieces[type] &= ~bit;
+    sides[side] &= ~bit;
+    const int shift = 4 * (position % 2);
+    mailbox[position / 2] =
+        (mailbox[position / 2] & ~(0xF << shift)) | (EMPTY << shift);
+    key ^= ZOBRIST.pieces[type][side][position];
+}
+
+uint64_t Position::attackers(int position, Side side,
+                             uint64_t occupied) const {
+    const uint64_t queens = pieces[Piece::Type::Q];
+    return ((knightAttacks[position] & pieces[Piece::Type::N]) |
+            (kingAttacks[position] & pieces[Piece::Type::K]) |
+            (pawnAttacks[~side][position] & pieces[Piece::Type::P]) |
+            (rookAttacks(position, occupied) &
+             (pieces[Piece::Type::R] | queens)) |
+            (bishopAttacks(position, occupied) &
+             (pieces[Piece::Type::B] | queens))) &
+           sides[side];
+}
+
+bool Position::inCheck() const {
+    const Side us = getCurrentPlayer();
+    return attackers(Utility::bitScanForward(getPositions(Piece::Type::K, us)),
+                     ~us, sides[Side::W] | sides[Side::B]);
+}
+
+void Position::generateMoves(MoveList &moves) const {
+    sideToMove == Side::W ? generateMoves<Side::W>(moves)
+                          : generateMoves<Side::B>(moves);
+}
+
+template <Side Us>
+void Position::generatePawnMoves(MoveList &moves, uint64_t pawns,
+                                 uint64_t allowed) const {
+    constexpr int Up = Us == Side::W ? 8 : -8;
+    // Captures towards the a file and towards the h file
+    constexpr int UpA = Up + 1;
+    constexpr int UpH = Up - 1;
+    constexpr uint64_t doublePushRank = Us == Side::W ? rank3 : rank6;
+    constexpr uint64_t promotionRank = Us == Side::W ? rank8 : rank1;
+
+    const uint64_t empty = ~(sides[Side::W] | sides[Side::B]);
+    const uint64_t them = sides[~Us];
+
+    uint64_t pushes = shift<Up>(pawns) & empty;
+    uint64_t doublePushes =
+        shift<Up>(pushes & doublePushRank) & empty & allowed;
+    pushes &= allowed;
+    uint64_t capturesA = shift<UpA>(pawns & ~fileA) & them & allowed;
+    uint64_t capturesH = shift<UpH>(pawns & ~fileH) & them & allowed;
+
+    serializePawnMoves<Up>(moves, pushes & ~promotionRank, Move::QUIET_MOVE);
+    serializePawnMoves<2 * Up>(moves, doublePushes, Move::DOUBLE_PAWN_PUSH);
+    serializePawnMoves<UpA>(moves, capturesA & ~promotionRank, Move::CAPTURE);
+    serializePawnMoves<UpH>(moves, capturesH & ~promotionRank, Move::CAPTURE);
+    serializePromotions<Up>(moves, pushes & promotionRank,
+                            Move::KNIGHT_PROMOTION);
+    serializePromotions<UpA>(moves, capturesA & promotionRank,
+                             Move::KNIGHT_PROMO_CAPTURE);
+    serializePromotions<UpH>(moves, capturesH & promotionRank,
+                             Move::KNIGHT_PROMO_CAPTURE);
+}
+
+template <Side Us> void Position::generateMoves(MoveList &moves) const {
+    PROFILE_REGION(MOVE_GENERATION);
+    constexpr Side Them = ~Us;
+    const uint64_t us = sides[Us];
+    const uint64_t them = sides[Them];
+    const uint64_t occupied = us | them;
+    const int king = Utility::bitScanForward(pieces[Piece::Type::K] & us);
+    const uint64_t checkers = attackers(king, Them, occupied);
+
+    // The king may not stay on a checking ray by stepping away along it
+    uint64_t targets = kingAttacks[king] & ~us;
+    while (targets) {
+        int to = Utility::bitScanPop(targets);
+        if (!attackers(to, Them, occupied ^ (1ULL << king))) {
+            moves.push(Move(king, to,
+                            (them >> to) & 1 ? Move::CAPTURE
+                                             : Move::QUIET_MOVE));
+        }
+    }
+    if (checkers & (checkers - 1)) {
+        return;
+    }
+
+    // Other moves capture the checker or block its ray
+    const uint64_t allowed =
+        checkers ? checkers |
+                       squaresBetween[king][Utility::bitScanForward(checkers)]
+                 : ~0ULL;
+
+    // A piece is pinned when it is alone between the king and a slider
+    const uint64_t queens = pieces[Piece::Type::Q];
+    uint64_t pinned = 0;
+    uint64_t snipers =
+        ((rookAttacks(king, them) & (pieces[Piece::Type::R] | queens)) |
+         (bishopAttacks(king, them) & (pieces[Piece::Type::B] | queens))) &
+        them;
+    while (snipers) {
+        uint64_t between =
+            squaresBetween[king][Utility::bitScanPop(snipers)] & occupied;
+        if (between && !(between & (between - 1))) {
+            pinned |= between & us;
+        }
+    }
+
+    const uint64_t pawns = pieces[Piece::Type::P] & us;
+    generatePawnMoves<Us>(moves, pawns & ~pinned, allowed);
+    for (uint64_t pinnedPawns = pawns & pinned; pinnedPawns;) {
+        uint64_t from = Utility::bitScanPop(pinnedPawns);
+        generatePawnMoves<Us>(moves, 1ULL << from,
+                              allowed & rayThrough[king][from]);
+    }
+
+    // En passant is checked by removing both pawns, as the captured pawn
+    // may be the last blocker of a slider on the king's rank
+    if (enPassant < 64) {
+        constexpr int Up = Us == Side::W ? 8 : -8;
+        const uint64_t target = 1ULL << enPassant;
+        const uint64_t captured = shift<-Up>(target);
+        uint64_t capturers = pawnAttacks[Them][enPassant] & pawns;
+        while (capturers && (allowed & (target | captured))) {
+            uint64_t from = Utility::bitScanPop(capturers);
+            uint64_t after = (occupied ^ (1ULL << from) ^ captured) | target;
+            const uint64_t sliders = them & ~captured;
+            if (!((rookAttacks(king, after) & sliders &
+                   (pieces[Piece::Type::R] | queens)) |
+                  (bishopAttacks(king, after) & sliders &
+                   (pieces[Piece::Type::B] | queens)))) {
+                moves.push(Move(from, enPassant, Move::EN_PASSANT_CAPTURE));
+            }
+        }
+    }
+
+    for (uint64_t knights = pieces[Piece::Type::N] & us & ~pinned; knights;) {
+        int from = Utility::bitScanPop(knights);
+        uint64_t attacks = knightAttacks[from] & ~us & allowed;
+        while (attacks) {
+            int to = Utility::bitScanPop(attacks);
+            moves.push(Move(from, to,
+                            (them >> to) & 1 ? Move::CAPTURE
+                                             : Move::QUIET_MOVE));
+        }
+    }
+
+    uint64_t sliders = (pieces[Piece::Type::R] | pieces[Piece::Type::B] |
+                        queens) &
+                       us;
+    while (sliders) {
+        int from = Utility::bitScanPop(sliders);
+        Piece::Type type = typeOn(from);
+        uint64_t attacks = 0;
+        if (type != Piece::Type::B) {
+            attacks |= rookAttacks(from, occupied);
+        }
+        if (type != Piece::Type::R) {
+            attacks |= bishopAttacks(from, occupied);
+        }
+        attacks &= ~us & allowed;
+        if ((pinned >> from) & 1) {
+            attacks &= rayThrough[king][from];
+        }
+        while (attacks) {
+            int to = Utility::bitScanPop(attacks);
+            moves.push(Move(from, to,
+                            (them >> to) & 1 ? Move::CAPTURE
+                                             : Move::QUIET_MOVE));
+        }
+    }
+
+    // No castling out of check
+    if (checkers) {
+        return;
+    }
+    constexpr int base = Us == Side::W ? 0 : 56;
+    if ((castlingRights >> (2 * Us)) & 0b10 &&
+        !(occupied & (0b0110ULL << base)) &&
+        !attackers(base + f1, Them, occupied) &&
+        !attackers(base + g1, Them, occupied)) {
+        moves.push(Move(0, 0, Move::KING_CASTLE));
+    }
+    if ((castlingRights >> (2 * Us)) & 0b01 &&
+        !(occupied & (0b01110000ULL << base)) &&
+        !attackers(base + d1, Them, occupied) &&
+        !attackers(base + c1, Them, occupied)) {
+        moves.push(Move(0, 0, Move::QUEEN_CASTLE));
+    }
+}
+
+void Position::makeMove(Move const &move) {
+    sideToMove == Side::W ? makeMove<Side::W>(move) : makeMove<Side::B>(move);
+}
+
+template <Side Us> void Position::makeMove(Move const &move) {
+    PROFILE_REGION(MAKE_UNMAKE);
+    constexpr Side Them = ~Us;
+    constexpr int Up = Us == Side::W ? 8 : -8;
+    constexpr int base = Us == Side::W ? 0 : 56;
+    const int from = move.getFrom();
+    const int to = move.getTo();
+    const auto flag = move.getFlag();
+
+    key ^= ZOBRIST.castlingRights[castlingRights];
+    if (enPassant < 64) {
+        key ^= ZOBRIST.enPassantFiles[enPassant % 8];
+    }
+    enPassant = 64;
+    ++halfMoveClock;
+
+    if (flag == Move::KING_CASTLE || flag == Move::QUEEN_CASTLE) {
+        const bool kingSide = flag == Move::KING_CASTLE;
+        removePiece(base + e1, Piece::Type::K, Us);
+        removePiece(base + (kingSide ? h1 : a1), Piece::Type::R, Us);
+        putPiece(base + (kingSide ? g1 : c1), Piece::Type::K, Us);
+        putPiece(base + (kingSide ? f1 : d1), Piece::Type::R, Us);
+        castlingRights &= Us == Side::W ? 0b1100 : 0b0011;
+    } else {
+        const Piece::Type type = typeOn(from);
+        if (flag == Move::EN_PASSANT_CAPTURE) {
+            removePiece(to - Up, Piece::Type::P, Them);
+        } else if (move.isCapture()) {
+            removePiece(to, typeOn(to), Them);
+        }
+        if (move.isCapture() || type == Piece::Type::P) {
+            halfMoveClock = 0;
+        }
+        removePiece(from, type, Us);
+        putPiece(to, move.isPromotion() ? promotionType(move) : type, Us);
+        if (flag == Move::DOUBLE_PAWN_PUSH) {
+            enPassant = to - Up;
+            key ^= ZOBRIST.enPassantFiles[enPassant % 8];
+        }
+        castlingRights &= CASTLING_MASKS[from] & CASTLING_MASKS[to];
+    }
+
+    key ^= ZOBRIST.castlingRights[castlingRights] ^ ZOBRIST.side;
+    if (Us == Side::B) {
+        ++fullMoveNumber;
+    }
+    sideToMove = Them;
+}
+
+template void Position::generateMoves<Side::W>(MoveList &) const;
+template void Position::generateMoves<Side::B>(MoveList &) const;
+template void Position::makeMove<Side::W>(Move const &);
+template void Position::makeMove<Side::B>(Move const &);
+
+} // namespace AdiChess
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "board.h"
+
+#include <string>
+
+// Compact position for copy-make. Bitboards, a four bit mailbox and the
+// irreversible state fit in two cache lines, so a search or perft keeps one
+// position per ply and undoing a move is dropping the copy. Moves use the same
+// encoding as Board and keys match Board::getKey.
+
+namespace AdiChess {
+
+// Legal moves of a position, generated into a fixed array
+class MoveList {
+public:
+    // Upper bound on the legal moves of any position
+    static constexpr int MAX_MOVES = 256;
+
+    void push(Move const &move) { moves[count++] = move; }
+    size_t size() const { return count; }
+    Move const *begin() const { return moves; }
+    Move const *end() const { return moves + count; }
+
+private:
+    Move moves[MAX_MOVES];
+    size_t count = 0;
+};
+
+class alignas(64) Position {
+public:
+    explicit Position(Board const &board);
+    explicit Position(std::string const &fenString =
+                          "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w "
+                          "KQkq - 0 1");
+
+    Piece operator()(int position) const;
+
+    uint64_t getPositions(Piece::Type const &pieceType, Side const &side) const {
+        return pieces[pieceType] & sides[side];
+    }
+
+    uint64_t getPositions(Side const &side) const { return sides[side]; }
+
+    Side getCurrentPlayer() const { return static_cast<Side>(sideToMove); }
+    uint8_t getCastlingRights() const { return castlingRights; }
+    // Out of range (greater than 63) when there is no en passant target
+    uint64_t getEnPassantTarget() const {
+        return enPassant < 64 ? enPassant : -1;
+    }
+    int getHalfMoveClock() const { return halfMoveClock; }
+    int getFullMoveNumber() const { return fullMoveNumber; }
+    uint64_t getKey() const { return key; }
+
+    // The side to move is in check
+    bool inCheck() const;
+
+    // Legal moves of the side to move
+    void generateMoves(MoveList &moves) const;
+    template <Side Us> void generateMoves(MoveList &moves) const;
+
+    // Plays a legal move in place. Copy the position first to keep it.
+    void makeMove(Move const &move);
+    template <Side Us> void makeMove(Move const &move);
+
+private:
+    void putPiece(int position, Piece::Type type, Side side);
+    void removePiece(int position, Piece::Type type, Side side);
+    Piece::Type typeOn(int position) const;
+
+    // Pieces of side attacking position with the given occupancy
+    uint64_t attackers(int position, Side side, uint64_t occupied) const;
+    template <Side Us>
+    void generatePawnMoves(MoveList &moves, uint64_t pawns,
+                           uint64_t allowed) const;
+
+    uint64_t pieces[Piece::Type::NUM_PIECES] = {0};
+    uint64_t sides[Side::NUM_SIDES] = {0};
+    uint64_t key = 0;
+    // Piece type and side << 3 of each position, two positions per byte
+    uint8_t mailbox[32];
+    // 64 when there is no en passant target
+    uint8_t enPassant = 64;
+    uint8_t castlingRights = 0;
+    uint8_t sideToMove = Side::W;
+    uint8_t halfMoveClock = 0;
+    uint16_t fullMoveNumber = 1;
+};
+
+static_assert(sizeof(Position) == 128, "Position spans two cache lines");
+
+} // namespace AdiChess
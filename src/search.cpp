@@ -1,53 +1,457 @@
 #include "search.h"
-#include <iostream>
+#include "perfCounters.h"
+
+#include <algorithm>
 
 namespace AdiChess {
 
-Search::Search(Board &board_) : board{board_}, principalMove{Move(0, 0, 0)} {}
+namespace {
+
+// Nodes searched between checks of the limits
+constexpr uint64_t CHECK_INTERVAL = 1024;
+
+// Sets the board's prefetcher for the children of one node and restores the
+// one of the node above on every way out, so the board never keeps a table
+// after a search returns
+class PrefetcherScope {
+public:
+    PrefetcherScope(Board &board_, Memory::Prefetcher const *prefetcher)
+        : board{board_}, previous{board_.getPrefetcher()} {
+        board.setPrefetcher(prefetcher);
+    }
+    ~PrefetcherScope() { board.setPrefetcher(previous); }
+    PrefetcherScope(PrefetcherScope const &) = delete;
+    PrefetcherScope &operator=(PrefetcherScope const &) = delete;
+
+private:
+    Board &board;
+    Memory::Prefetcher const *previous;
+};
+
+// Score of a probed position, plies counts moves already played from the
+// root
+int tablebaseScore(Tablebase::ProbeResult const &result, int plies) {
+    switch (result.outcome) {
+    case Tablebase::ProbeResult::WIN:
+        return MATE_SCORE - result.plies - plies;
+    case Tablebase::ProbeResult::LOSS:
+        return -MATE_SCORE + result.plies + plies;
+    default:
+        return 0;
+    }
+}
+
+// Mate scores are stored counted from the node rather than the root
+int toTable(int score, int ply) {
+    return score > MATE_BOUND ? score + ply : score < -MATE_BOUND ? score - ply
+                                                                  : score;
+}
+
+int fromTable(int score, int ply) {
+    return score > MATE_BOUND ? score - ply : score < -MATE_BOUND ? score + ply
+                                                                  : score;
+}
+
+// The hash move first, then captures
+void orderMoves(MoveGeneration::MoveGenerator &moves, Move hashMove) {
+    auto first = moves.begin();
+    auto found = std::find(moves.begin(), moves.end(), hashMove);
+    if (found != moves.end()) {
+        std::iter_swap(first++, found);
+    }
+    std::partition(first, moves.end(),
+                   [](Move const &move) { return move.isCapture(); });
+}
+
+} // namespace
+
+Search::Search(Board &board_) : board{board_}, principalMove{NO_MOVE} {}
 
 int Search::negamax(int depth) {
-    std::cout << board.getCurrentPlayer() << '\n';
-    int alpha = INT32_MIN;
-    int beta = INT32_MAX;
+    PROFILE_REGION(SEARCH);
+    nodes = 0;
+    rootDepth = 0;
+    aborted = false;
+    // Book moves are played without searching
+    if (book) {
+        if (auto bookMove = book->probe(board)) {
+            principalMove = *bookMove;
+            principalVariation = {*bookMove};
+            return 0;
+        }
+    }
+    if (trace) {
+        trace->beginIteration(depth, board.getCurrentPlayer());
+    }
+    int value = searchRoot(depth, {}, principalMove);
+    principalVariation = lines[0];
+    if (!principalVariation.empty()) {
+        principalMove = principalVariation.front();
+    }
+    return value;
+}
+
+int Search::search(SearchLimits const &limits_,
+                   std::function<void(SearchInfo const &)> const &report) {
+    PROFILE_REGION(SEARCH);
+    limits = limits_;
+    nodes = 0;
+    aborted = false;
+    pondering = limits.ponder;
+    start = std::chrono::steady_clock::now();
+    results.clear();
+    std::optional<Move> bookMove;
+    if (book && (bookMove = book->probe(board))) {
+        principalMove = *bookMove;
+        principalVariation = {*bookMove};
+    }
+
+    for (rootDepth = 1; !bookMove && rootDepth <= std::max(limits.depth, 1);
+         ++rootDepth) {
+        std::vector<SearchInfo> iteration;
+        std::vector<Move> excluded;
+        if (trace) {
+            trace->beginIteration(rootDepth, board.getCurrentPlayer());
+        }
+        for (int line = 0; line < multiPV; ++line) {
+            // Lines are searched first in the order of the last iteration
+            Move first = principalMove;
+            if (static_cast<size_t>(line) < results.size() &&
+                !results[line].principalVariation.empty()) {
+                first = results[line].principalVariation.front();
+            }
+            int value = searchRoot(rootDepth, excluded, first);
+            if (aborted || (line > 0 && value == -INFINITE_SCORE)) {
+                break;
+            }
+            iteration.push_back(
+                {rootDepth, value, nodes, elapsed(), lines[0], line + 1});
+            if (lines[0].empty()) {
+                break;
+            }
+            excluded.push_back(lines[0].front());
+        }
+        // An unfinished iteration is discarded
+        if (aborted) {
+            break;
+        }
+        results = std::move(iteration);
+        principalVariation = results.front().principalVariation;
+        if (!principalVariation.empty()) {
+            principalMove = principalVariation.front();
+        }
+        if (report) {
+            for (auto const &line : results) {
+                report(line);
+            }
+        }
+        // The next iteration takes longer than all before it together
+        if (limitReached(2)) {
+            break;
+        }
+    }
+    // The move is not played before the opponent does
+    if (pondering) {
+        std::unique_lock<std::mutex> lock(signalMutex);
+        const auto signalled = [&] {
+            return stopRequested || ponderHitRequested;
+        };
+        // wait_for keeps to the runtime symbols older libstdc++ exports
+        while (!signal.wait_for(lock, std::chrono::hours(1), signalled)) {
+        }
+    }
+    int score = results.empty() ? 0 : results.front().score;
+    rootDepth = 0;
+    stopRequested = false;
+    ponderHitRequested = false;
+    return score;
+}
+
+void Search::stop() {
+    {
+        std::lock_guard<std::mutex> lock(signalMutex);
+        stopRequested = true;
+    }
+    signal.notify_all();
+}
+
+void Search::ponderHit() {
+    {
+        std::lock_guard<std::mutex> lock(signalMutex);
+        ponderHitRequested = true;
+    }
+    signal.notify_all();
+}
+
+void Search::checkLimits() {
+    if (rootDepth > 1 && limitReached(1)) {
+        aborted = true;
+    }
+}
+
+bool Search::limitReached(int timeFactor) {
+    if (ponderHitRequested.exchange(false)) {
+        pondering = false;
+        start = std::chrono::steady_clock::now();
+    }
+    if (stopRequested) {
+        return true;
+    }
+    return !pondering &&
+           (nodes >= limits.nodes ||
+            (limits.time && timeFactor * elapsed() >= limits.time));
+}
+
+int64_t Search::elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+int Search::searchRoot(int depth, std::vector<Move> const &excluded,
+                       Move first) {
+    if (trace) {
+        return board.getCurrentPlayer() == Side::W
+                   ? searchRoot<Side::W, true>(depth, excluded, first)
+                   : searchRoot<Side::B, true>(depth, excluded, first);
+    }
+    return board.getCurrentPlayer() == Side::W
+               ? searchRoot<Side::W, false>(depth, excluded, first)
+               : searchRoot<Side::B, false>(depth, excluded, first);
+}
+
+template <Side Us, bool Traced>
+int Search::searchRoot(int depth, std::vector<Move> const &excluded,
+                       Move first) {
+    [[maybe_unused]] const uint64_t startNodes = nodes;
+    [[maybe_unused]] int searched = 0;
+    ply = 0;
+    lines[0].clear();
     MoveGeneration::MoveGenerator moveGen(board);
-    // move ordering
-    int value = INT32_MIN;
+    orderMoves(moveGen, first);
+    // Only children with depth left probe the table
+    const PrefetcherScope prefetching(board, depth > 1 ? table : nullptr);
+
+    int alpha = -INFINITE_SCORE;
+    int beta = INFINITE_SCORE;
+    int value = -INFINITE_SCORE;
     for (auto const &move : moveGen) {
-        if (board.legalMove(move)) {
-            board.makeMove(move);
-            auto moveScore = -negamax(depth - 1, -beta, -alpha);
+        if (std::find(excluded.begin(), excluded.end(), move) !=
+            excluded.end()) {
+            continue;
+        }
+        if (board.legalMove<Us>(move)) {
+            if constexpr (Traced) {
+                played[1] = move.raw();
+                ++searched;
+            }
+            board.makeMove<Us>(move);
+            ++ply;
+            auto moveScore = -negamax<~Us, Traced>(depth - 1, -beta, -alpha);
+            --ply;
+            board.unmakeMove<Us>(move);
+            if (aborted) {
+                return value;
+            }
             if (moveScore > value) {
-                principalMove = move;
                 value = moveScore;
+                alpha = std::max(alpha, value);
+                lines[0].clear();
+                lines[0].push_back(move);
+                lines[0].insert(lines[0].end(), lines[1].begin(),
+                                lines[1].end());
             }
-            board.unmakeMove(move);
         }
     }
+    if constexpr (Traced) {
+        trace->record({-INFINITE_SCORE, INFINITE_SCORE, value,
+                       static_cast<uint32_t>(nodes - startNodes), 0, 0,
+                       static_cast<int8_t>(depth),
+                       static_cast<uint8_t>(std::min(searched, 255)),
+                       Trace::NO_CUTOFF, Trace::ROOT, 0});
+    }
     return value;
 }
+
+int Search::negamax(int depth, int alpha, int beta) {
+    if (trace) {
+        return board.getCurrentPlayer() == Side::W
+                   ? negamax<Side::W, true>(depth, alpha, beta)
+                   : negamax<Side::B, true>(depth, alpha, beta);
+    }
+    return board.getCurrentPlayer() == Side::W
+               ? negamax<Side::W, false>(depth, alpha, beta)
+               : negamax<Side::B, false>(depth, alpha, beta);
+}
+
+template <Side Us, bool Traced>
 int Search::negamax(int depth, int alpha, int beta) {
-    if (depth == 0) {
-        return quiesce(alpha, beta);
+    [[maybe_unused]] const uint64_t startNodes = nodes;
+    [[maybe_unused]] const int originalBeta = beta;
+    [[maybe_unused]] const int enteredAlpha = alpha;
+    [[maybe_unused]] uint8_t traceFlags = 0;
+    [[maybe_unused]] int searched = 0;
+    [[maybe_unused]] int cutoff = Trace::NO_CUTOFF;
+    // Every completed node returns through here, aborted ones are dropped
+    auto finish = [&](int score) {
+        if constexpr (Traced) {
+            trace->record({enteredAlpha, originalBeta, score,
+                           static_cast<uint32_t>(nodes - startNodes),
+                           played[ply], static_cast<uint8_t>(ply),
+                           static_cast<int8_t>(depth),
+                           static_cast<uint8_t>(std::min(searched, 255)),
+                           static_cast<uint8_t>(cutoff), traceFlags, 0});
+        }
+        return score;
+    };
+    if (++nodes % CHECK_INTERVAL == 0) {
+        checkLimits();
+    }
+    if (aborted) {
+        return 0;
+    }
+    lines[ply].clear();
+    if (board.fiftyMoves() || board.isRepetition()) {
+        traceFlags |= Trace::LEAF;
+        return finish(0);
+    }
+    // A move back to an earlier position secures at least a draw
+    if (alpha < 0 && board.hasUpcomingRepetition()) {
+        alpha = 0;
+        if (alpha >= beta) {
+            traceFlags |= Trace::LEAF;
+            return finish(alpha);
+        }
+    }
+    if (tablebases) {
+        if (auto result = tablebases->probe(board)) {
+            traceFlags |= Trace::LEAF;
+            return finish(tablebaseScore(*result, ply));
+        }
     }
+    if (depth <= 0 || ply >= MAX_PLY - 1) {
+        traceFlags |= Trace::LEAF;
+        return finish(quiesce(alpha, beta));
+    }
+
+    Move hashMove = NO_MOVE;
+    if (table) {
+        TranspositionTable::Entry entry{};
+        if (table->probe(board.getKey(), entry)) {
+            traceFlags |= Trace::HASH_HIT;
+            hashMove = entry.move;
+            int score = fromTable(entry.score, ply);
+            if (entry.depth >= depth &&
+                (entry.bound == TranspositionTable::EXACT ||
+                 (entry.bound == TranspositionTable::LOWER && score >= beta) ||
+                 (entry.bound == TranspositionTable::UPPER && score <= alpha))) {
+                traceFlags |= Trace::HASH_CUTOFF;
+                return finish(score);
+            }
+        }
+    }
+
     MoveGeneration::MoveGenerator moveGen(board);
-    // move ordering
-    int value = INT32_MIN;
+    orderMoves(moveGen, hashMove);
+    const PrefetcherScope prefetching(board, depth > 1 ? table : nullptr);
+    const int originalAlpha = alpha;
+    int value = -INFINITE_SCORE;
+    Move bestMove = NO_MOVE;
     for (auto const &move : moveGen) {
-        if (board.legalMove(move)) {
-            board.makeMove(move);
-            auto moveScore = -negamax(depth - 1, -beta, -alpha);
-            value = std::max(value, moveScore);
-            board.unmakeMove(move);
-            alpha = std::max(alpha, value);
-            if (alpha >= beta)
-                return value;
+        if (board.legalMove<Us>(move)) {
+            if constexpr (Traced) {
+                played[ply + 1] = move.raw();
+            }
+            ++searched;
+            board.makeMove<Us>(move);
+            ++ply;
+            auto moveScore = -negamax<~Us, Traced>(depth - 1, -beta, -alpha);
+            --ply;
+            board.unmakeMove<Us>(move);
+            if (aborted) {
+                return 0;
+            }
+            if (moveScore > value) {
+                value = moveScore;
+                bestMove = move;
+            }
+            if (value > alpha) {
+                alpha = value;
+                lines[ply].clear();
+                lines[ply].push_back(move);
+                lines[ply].insert(lines[ply].end(), lines[ply + 1].begin(),
+                                  lines[ply + 1].end());
+            }
+            if (alpha >= beta) {
+                cutoff = searched - 1;
+                break;
+            }
         }
     }
-    return value;
+    // Checkmate or stalemate
+    if (value == -INFINITE_SCORE) {
+        traceFlags |= Trace::LEAF;
+        return finish(board.inCheck(Us) ? -MATE_SCORE + ply : 0);
+    }
+    if (table) {
+        auto bound = value >= beta            ? TranspositionTable::LOWER
+                     : value > originalAlpha ? TranspositionTable::EXACT
+                                              : TranspositionTable::UPPER;
+        table->store(board.getKey(), depth, toTable(value, ply), bound,
+                     bestMove);
+    }
+    return finish(value);
 }
 
 int Search::quiesce(int alpha, int beta) { return Evaluation::evaluate(board); }
 
 Move Search::getPrincipalMove() const { return principalMove; }
 
-} // namespace AdiChess
\ No newline at end of file
+std::vector<Move> const &Search::getPrincipalVariation() const {
+    return principalVariation;
+}
+
+Move Search::getPonderMove() {
+    if (principalVariation.size() > 1) {
+        return principalVariation[1];
+    }
+    if (principalVariation.empty() || !table) {
+        return NO_MOVE;
+    }
+    const Move move = principalVariation.front();
+    Move reply = NO_MOVE;
+    board.makeMove(move);
+    TranspositionTable::Entry entry{};
+    if (table->probe(board.getKey(), entry) && entry.move != NO_MOVE) {
+        // A colliding key can leave a move of another position
+        MoveGeneration::MoveGenerator moveGen(board);
+        for (auto const &candidate : moveGen) {
+            if (candidate == entry.move && board.legalMove(candidate)) {
+                reply = candidate;
+                break;
+            }
+        }
+    }
+    board.unmakeMove(move);
+    return reply;
+}
+
+std::vector<SearchInfo> const &Search::getLines() const { return results; }
+
+uint64_t Search::getNodes() const { return nodes; }
+
+void Search::setBook(Polyglot::Book *book_) { book = book_; }
+
+void Search::setTablebases(Tablebase::Tablebases const *tablebases_) {
+    tablebases = tablebases_;
+}
+
+void Search::setTranspositionTable(TranspositionTable *table_) {
+    table = table_;
+}
+
+void Search::setMultiPV(int lines_) { multiPV = std::max(lines_, 1); }
+
+void Search::setTrace(Trace::Recorder *trace_) { trace = trace_; }
+
+} // namespace AdiChess
@@ -1,18 +1,131 @@
+#pragma once
+
 #include "evaluation.h"
 #include "moveGenerator.h"
+#include "polyglot.h"
+#include "searchTrace.h"
+#include "tablebase.h"
+#include "transpositionTable.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
 
 namespace AdiChess {
-    
+
+// Scores beyond any evaluation, mates and tablebase wins score MATE_SCORE less
+// the plies to mate from the root
+constexpr int INFINITE_SCORE = 1000000;
+constexpr int MATE_SCORE = 100000;
+// Scores further from zero than this are mates
+constexpr int MATE_BOUND = MATE_SCORE - 1000;
+constexpr int MAX_PLY = 128;
+
+struct SearchLimits {
+    int depth = MAX_PLY - 1;
+    uint64_t nodes = UINT64_MAX;
+    // Milliseconds, 0 for no limit
+    int64_t time = 0;
+    // Searches without limits until ponderHit, which starts the clock
+    bool ponder = false;
+    // Attacker moves of a mate search, 0 for the regular search
+    int mate = 0;
+};
+
+// One line of a completed iteration
+struct SearchInfo {
+    int depth;
+    int score;
+    uint64_t nodes;
+    // Milliseconds since the search started
+    int64_t time;
+    std::vector<Move> principalVariation;
+    // Rank of the line, 1 for the best
+    int multiPV = 1;
+};
+
 class Search {
 public:
     Search(Board &board_);
     int negamax(int depth);
     int quiesce(int alpha, int beta);
     Move getPrincipalMove() const;
+    std::vector<Move> const &getPrincipalVariation() const;
+    // Expected reply to the principal move: the second move of the principal
+    // variation, else the hash move of the position after the principal
+    // move, NO_MOVE when there is neither
+    Move getPonderMove();
+    // Nodes visited by the last root search
+    uint64_t getNodes() const;
     int negamax(int depth, int alpha, int beta);
+    // Book consulted before searching the root, may be null
+    void setBook(Polyglot::Book *book_);
+    // Tablebases probed at interior nodes, may be null
+    void setTablebases(Tablebase::Tablebases const *tablebases_);
+    // Table shared with searches on other threads, may be null
+    void setTranspositionTable(TranspositionTable *table_);
+    // Lines searched by search(), every line after the first excludes the
+    // root moves of the lines above it
+    void setMultiPV(int lines_);
+    // Every node searched is recorded here, may be null
+    void setTrace(Trace::Recorder *trace_);
+
+    // Lines of the last completed iteration, best first
+    std::vector<SearchInfo> const &getLines() const;
+
+    // Iterative deepening until a limit is reached, report is called for
+    // every line of a completed iteration. The first iteration always
+    // completes so there is a move to play.
+    int search(SearchLimits const &limits_,
+               std::function<void(SearchInfo const &)> const &report = {});
+    // Ends a running search from another thread at its next check
+    void stop();
+    // The opponent played the expected move, the running search keeps its
+    // tree and continues under its limits from now
+    void ponderHit();
+
 private:
+    // Best score over the root moves not excluded, -INFINITE_SCORE if there
+    // are none
+    template <Side Us, bool Traced>
+    int searchRoot(int depth, std::vector<Move> const &excluded, Move first);
+    int searchRoot(int depth, std::vector<Move> const &excluded, Move first);
+    template <Side Us, bool Traced> int negamax(int depth, int alpha, int beta);
+    void checkLimits();
+    // Stop requested or a limit reached, the time limit is checked against
+    // the elapsed time times timeFactor
+    bool limitReached(int timeFactor);
+    int64_t elapsed() const;
+
     Board &board;
     Move principalMove;
+    std::vector<Move> principalVariation;
+    std::vector<SearchInfo> results;
+    int multiPV = 1;
+    // Triangular table, the line found below each ply
+    std::vector<Move> lines[MAX_PLY + 1];
+    Polyglot::Book *book = nullptr;
+    Tablebase::Tablebases const *tablebases = nullptr;
+    TranspositionTable *table = nullptr;
+    Trace::Recorder *trace = nullptr;
+    // Move played into each ply, kept only while tracing
+    uint16_t played[MAX_PLY + 1] = {0};
+    uint64_t nodes = 0;
+    int ply = 0;
+
+    SearchLimits limits;
+    int rootDepth = 0;
+    std::chrono::steady_clock::time_point start;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> ponderHitRequested{false};
+    // Signalled by stop and ponderHit, wakes a search waiting to play
+    std::mutex signalMutex;
+    std::condition_variable signal;
+    bool pondering = false;
+    bool aborted = false;
 };
 
-}
\ No newline at end of file
+}
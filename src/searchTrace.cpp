@@ -0,0 +1,268 @@
+#include "searchTrace.h"
+#include "perft.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace AdiChess::Trace {
+
+/* FILE LAYOUT:
+|-- 4 --|-- 4 --|-- 24 * count --|
+  Magic   Record  Records in the order the nodes returned
+          size                                              */
+
+namespace {
+
+constexpr char MAGIC[4] = {'A', 'T', 'R', '1'};
+constexpr int HEAVIEST_PLIES = 3;
+
+} // namespace
+
+Recorder::Recorder(std::string const &path, size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    ring.resize(size);
+    mask = size - 1;
+
+    file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) {
+        return;
+    }
+    uint32_t recordSize = sizeof(Record);
+    if (::write(file, MAGIC, sizeof(MAGIC)) != sizeof(MAGIC) ||
+        ::write(file, &recordSize, sizeof(recordSize)) != sizeof(recordSize)) {
+        ::close(file);
+        file = -1;
+        return;
+    }
+    writer = std::thread(&Recorder::write, this);
+}
+
+Recorder::~Recorder() {
+    if (writer.joinable()) {
+        done = true;
+        writer.join();
+    }
+    if (file >= 0) {
+        ::close(file);
+    }
+}
+
+void Recorder::beginIteration(int depth, int side) {
+    Record marker{};
+    marker.depth = depth;
+    marker.move = side;
+    marker.cutoff = NO_CUTOFF;
+    marker.flags = ITERATION;
+    record(marker);
+}
+
+void Recorder::flush() {
+    while (isOpen() && tail.load(std::memory_order_acquire) !=
+                           head.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+// Drains the ring in contiguous runs until the recorder is destroyed
+void Recorder::write() {
+    while (true) {
+        const bool finishing = done.load(std::memory_order_acquire);
+        uint64_t end = head.load(std::memory_order_acquire);
+        uint64_t begin = tail.load(std::memory_order_relaxed);
+        if (begin == end) {
+            if (finishing) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        while (begin != end) {
+            const uint64_t run =
+                std::min(end - begin, ring.size() - (begin & mask));
+            auto bytes = reinterpret_cast<const char *>(&ring[begin & mask]);
+            size_t remaining = run * sizeof(Record);
+            while (remaining) {
+                ssize_t written = ::write(file, bytes, remaining);
+                if (written <= 0) {
+                    // The rest of the trace is dropped rather than stalling
+                    // the search
+                    break;
+                }
+                bytes += written;
+                remaining -= written;
+            }
+            begin += run;
+            tail.store(begin, std::memory_order_release);
+        }
+    }
+}
+
+bool read(std::string const &path, std::vector<Record> &records) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    uint32_t recordSize = 0;
+    if (!file.read(magic, sizeof(magic)) ||
+        std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !file.read(reinterpret_cast<char *>(&recordSize), sizeof(recordSize)) ||
+        recordSize != sizeof(Record)) {
+        return false;
+    }
+    records.clear();
+    Record record;
+    while (file.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+        records.push_back(record);
+    }
+    return true;
+}
+
+Summary summarise(std::vector<Record> const &records, size_t heaviest) {
+    Summary summary;
+    // Records return children first, so the completed nodes of every ply
+    // wait here for their parent one ply up
+    std::vector<std::vector<size_t>> pending(256);
+    std::vector<size_t> parents(records.size(), SIZE_MAX);
+    size_t lastIteration = records.size();
+    int rootSide = 0;
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        auto const &record = records[i];
+        if (record.flags & ITERATION) {
+            summary.iterations.emplace_back(record.depth, 0);
+            lastIteration = i;
+            rootSide = record.move;
+            for (auto &nodes : pending) {
+                nodes.clear();
+            }
+            continue;
+        }
+        for (size_t child : pending[record.ply + 1]) {
+            parents[child] = i;
+        }
+        pending[record.ply + 1].clear();
+        pending[record.ply].push_back(i);
+
+        if (record.flags & ROOT) {
+            if (!summary.iterations.empty()) {
+                summary.iterations.back().second += record.nodes;
+            }
+            continue;
+        }
+        auto &depth = summary.depths[record.depth];
+        ++depth.nodes;
+        depth.hashHits += (record.flags & HASH_HIT) != 0;
+        depth.hashCutoffs += (record.flags & HASH_CUTOFF) != 0;
+        if (record.searched) {
+            ++depth.interior;
+            depth.searched += record.searched;
+        }
+        if (record.cutoff != NO_CUTOFF) {
+            ++depth.failHighs;
+            depth.firstMoveFailHighs += record.cutoff == 0;
+            depth.cutoffIndices += record.cutoff;
+            ++summary.cutoffHistogram[std::min<int>(record.cutoff, 7)];
+        }
+    }
+
+    if (lastIteration == records.size()) {
+        return summary;
+    }
+    std::vector<size_t> candidates;
+    for (size_t i = lastIteration + 1; i < records.size(); ++i) {
+        auto const &record = records[i];
+        if (!(record.flags & ROOT) && record.ply >= 1 &&
+            record.ply <= HEAVIEST_PLIES && parents[i] != SIZE_MAX) {
+            candidates.push_back(i);
+        }
+    }
+    heaviest = std::min(heaviest, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + heaviest,
+                      candidates.end(), [&](size_t a, size_t b) {
+                          return records[a].nodes > records[b].nodes;
+                      });
+    for (size_t i = 0; i < heaviest; ++i) {
+        Subtree subtree{{}, rootSide, records[candidates[i]]};
+        for (size_t node = candidates[i];
+             node != SIZE_MAX && !(records[node].flags & ROOT);
+             node = parents[node]) {
+            subtree.path.insert(subtree.path.begin(), records[node].move);
+        }
+        summary.heaviest.push_back(subtree);
+    }
+    return summary;
+}
+
+void report(Summary const &summary, std::ostream &output) {
+    const auto flags = output.flags();
+    const auto precision = output.precision();
+    output << std::fixed << std::setprecision(2);
+
+    output << "Iterations\n";
+    uint64_t previous = 0;
+    for (auto const &[depth, nodes] : summary.iterations) {
+        output << "  depth " << std::setw(3) << depth << "  nodes "
+               << std::setw(12) << nodes;
+        if (previous) {
+            output << "  growth " << static_cast<double>(nodes) / previous;
+        }
+        output << "\n";
+        previous = nodes;
+    }
+
+    output << "\nBy remaining depth\n"
+           << "  depth        nodes  branching  hash hits  hash cuts"
+              "  fail highs  first move  mean index\n";
+    for (auto it = summary.depths.rbegin(); it != summary.depths.rend(); ++it) {
+        auto const &stats = it->second;
+        auto percent = [](uint64_t part, uint64_t whole) {
+            return whole ? 100.0 * part / whole : 0.0;
+        };
+        output << "  " << std::setw(5) << it->first << std::setw(13)
+               << stats.nodes << std::setw(11) << stats.branchingFactor()
+               << std::setw(10) << percent(stats.hashHits, stats.nodes) << "%"
+               << std::setw(10) << percent(stats.hashCutoffs, stats.nodes)
+               << "%" << std::setw(12) << stats.failHighs << std::setw(11)
+               << percent(stats.firstMoveFailHighs, stats.failHighs) << "%"
+               << std::setw(12)
+               << (stats.failHighs ? static_cast<double>(stats.cutoffIndices) /
+                                         stats.failHighs
+                                   : 0.0)
+               << "\n";
+    }
+
+    output << "\nFail highs by move index\n ";
+    for (int index = 0; index < 8; ++index) {
+        output << " " << index << (index == 7 ? "+" : "") << ": "
+               << summary.cutoffHistogram[index];
+    }
+    output << "\n";
+
+    if (!summary.heaviest.empty()) {
+        output << "\nHeaviest subtrees of the last iteration\n";
+    }
+    for (auto const &subtree : summary.heaviest) {
+        auto const &record = subtree.record;
+        output << "  " << std::setw(10) << record.nodes << " nodes  depth "
+               << static_cast<int>(record.depth) << "  window ["
+               << record.alpha << ", " << record.beta << "]  score "
+               << record.score << " ";
+        int side = subtree.rootSide;
+        for (uint16_t move : subtree.path) {
+            output << " " << moveToString(Move::fromRaw(move), static_cast<Side>(side));
+            side ^= 1;
+        }
+        output << "\n";
+    }
+    output.flags(flags);
+    output.precision(precision);
+}
+
+} // namespace AdiChess::Trace
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "move.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Search tree traces for offline analysis. A search given a Recorder writes
+// one record per node as the node returns into a ring buffer, which a
+// background thread drains to a file. Searches without a recorder run the
+// untraced instantiation of the search and pay nothing.
+
+namespace AdiChess::Trace {
+
+enum Flags : uint8_t {
+    // A transposition table entry was found, and it ended the node
+    HASH_HIT = 1,
+    HASH_CUTOFF = 2,
+    // Scored without searching moves: draws, tablebases and the horizon
+    LEAF = 4,
+    // The root, written by every root pass
+    ROOT = 8,
+    // Starts an iteration, depth is the iteration depth and move the side to
+    // move at the root
+    ITERATION = 16,
+};
+
+// Index of the move that failed high, none when the node did not
+constexpr uint8_t NO_CUTOFF = 255;
+
+struct Record {
+    // Window the node was searched with and its result
+    int32_t alpha;
+    int32_t beta;
+    int32_t score;
+    // Nodes in the subtree, the node included
+    uint32_t nodes;
+    // Move played to reach the node, raw encoding
+    uint16_t move;
+    uint8_t ply;
+    int8_t depth;
+    // Legal moves searched
+    uint8_t searched;
+    uint8_t cutoff;
+    uint8_t flags;
+    uint8_t unused;
+};
+
+static_assert(sizeof(Record) == 24, "Records are 24 bytes on disk");
+
+// Writes the records of one search thread to a file
+class Recorder {
+public:
+    // Capacity in records, rounded up to a power of two
+    explicit Recorder(std::string const &path, size_t capacity = 1 << 16);
+    ~Recorder();
+    Recorder(Recorder const &) = delete;
+    Recorder &operator=(Recorder const &) = delete;
+
+    bool isOpen() const { return file >= 0; }
+
+    // Waits for the writer when the buffer is full
+    void record(Record const &record) {
+        const uint64_t position = head.load(std::memory_order_relaxed);
+        while (position - tail.load(std::memory_order_acquire) > mask) {
+            std::this_thread::yield();
+        }
+        ring[position & mask] = record;
+        head.store(position + 1, std::memory_order_release);
+    }
+
+    void beginIteration(int depth, int side);
+    // Returns once every record so far is in the file
+    void flush();
+
+private:
+    void write();
+
+    std::vector<Record> ring;
+    uint64_t mask;
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    std::atomic<bool> done{false};
+    int file = -1;
+    std::thread writer;
+};
+
+// Reads a trace file, false when it is missing or not a trace
+bool read(std::string const &path, std::vector<Record> &records);
+
+struct DepthStats {
+    // Nodes searched to this remaining depth, those with moves searched and
+    // the moves searched at them
+    uint64_t nodes = 0;
+    uint64_t interior = 0;
+    uint64_t searched = 0;
+    uint64_t hashHits = 0;
+    uint64_t hashCutoffs = 0;
+    uint64_t failHighs = 0;
+    uint64_t firstMoveFailHighs = 0;
+    // Sum of the indices of the moves that failed high
+    uint64_t cutoffIndices = 0;
+
+    double branchingFactor() const {
+        return interior ? static_cast<double>(searched) / interior : 0;
+    }
+};
+
+struct Subtree {
+    // Moves from the root, raw encoding
+    std::vector<uint16_t> path;
+    int rootSide = 0;
+    Record record;
+};
+
+struct Summary {
+    // Depth and nodes of every iteration in the trace
+    std::vector<std::pair<int, uint64_t>> iterations;
+    std::map<int, DepthStats> depths;
+    // Fail highs by index of the cutoff move, the last counts the rest
+    uint64_t cutoffHistogram[8] = {0};
+    // Heaviest subtrees within three plies of the root in the last
+    // iteration, heaviest first
+    std::vector<Subtree> heaviest;
+};
+
+Summary summarise(std::vector<Record> const &records, size_t heaviest = 10);
+
+void report(Summary const &summary, std::ostream &output);
+
+} // namespace AdiChess::Trace
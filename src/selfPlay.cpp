@@ -0,0 +1,142 @@
+#include "selfPlay.h"
+#include "packedPosition.h"
+#include "search.h"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+namespace AdiChess::SelfPlay {
+
+namespace {
+
+std::vector<Move> legalMoves(Board &board) {
+    std::vector<Move> moves;
+    MoveGeneration::MoveGenerator moveGenerator(board);
+    for (auto const &move : moveGenerator) {
+        if (board.legalMove(move)) {
+            moves.push_back(move);
+        }
+    }
+    return moves;
+}
+
+// Bare kings, or a single minor piece against a bare king
+bool insufficientMaterial(Board const &board) {
+    uint64_t occupied =
+        board.getPositions(Side::W) | board.getPositions(Side::B);
+    uint64_t minors = 0;
+    for (Side side : {Side::W, Side::B}) {
+        minors |= board.getPositions(Piece::Type::B, side) |
+                  board.getPositions(Piece::Type::N, side);
+    }
+    int pieces = Utility::popCnt(occupied);
+    return pieces == 2 || (pieces == 3 && Utility::popCnt(minors) == 1);
+}
+
+// Plays random moves from the start position, taken back again if they end
+// the game
+bool playOpening(Board &board, int plies, std::mt19937_64 &random) {
+    std::vector<Move> played;
+    for (int ply = 0; ply < plies; ++ply) {
+        auto moves = legalMoves(board);
+        if (moves.empty()) {
+            break;
+        }
+        played.push_back(moves[random() % moves.size()]);
+        board.makeMove(played.back());
+    }
+    if (played.size() == static_cast<size_t>(plies) &&
+        !legalMoves(board).empty()) {
+        return true;
+    }
+    for (auto move = played.rbegin(); move != played.rend(); ++move) {
+        board.unmakeMove(*move);
+    }
+    return false;
+}
+
+// Plays one game and appends its recorded positions to writer
+uint64_t playGame(Options const &options, std::mt19937_64 &random,
+                  PackedWriter &writer) {
+    Board board;
+    while (!playOpening(board, options.randomPlies, random)) {
+    }
+
+    std::vector<PackedPosition> positions;
+    // White's point of view
+    int result = 0;
+    for (int ply = 0;; ++ply) {
+        const Side us = board.getCurrentPlayer();
+        if (legalMoves(board).empty()) {
+            result = board.inCheck(us) ? (us == Side::W ? -1 : 1) : 0;
+            break;
+        }
+        if (ply >= options.maxPlies || board.fiftyMoves() ||
+            board.isRepetition() || insufficientMaterial(board)) {
+            break;
+        }
+
+        Search search(board);
+        SearchLimits limits;
+        limits.depth = options.depth;
+        limits.nodes = options.nodes;
+        const int score = search.search(limits);
+        Move move = search.getPrincipalMove();
+
+        // Only quiet positions are kept, the side to move is not in check
+        // and its best move wins no material
+        if (!board.inCheck(us) && !move.isCapture() && !move.isPromotion()) {
+            positions.push_back(pack(board));
+            positions.back().setScore(score, 0);
+        }
+        board.makeMove(move);
+    }
+
+    for (auto &position : positions) {
+        position.result = result;
+    }
+    writer.write(positions.data(), positions.size());
+    return positions.size();
+}
+
+} // namespace
+
+Stats run(std::string const &path, Options const &options) {
+    auto start = std::chrono::steady_clock::now();
+    // Truncates any previous output, threads then append to it
+    { PackedWriter truncate(path); }
+
+    std::atomic<int> nextGame{0};
+    std::atomic<uint64_t> positions{0};
+    auto worker = [&] {
+        // Each flush is a single append so threads never interleave records
+        PackedWriter writer(path, true);
+        for (int game = nextGame++; game < options.games; game = nextGame++) {
+            // Seeded per game so the games do not depend on the thread count
+            std::mt19937_64 random(options.seed * 0x9E3779B97F4A7C15ULL +
+                                   game);
+            positions += playGame(options, random, writer);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int thread = 1; thread < options.threads; ++thread) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : workers) {
+        thread.join();
+    }
+
+    Stats stats;
+    stats.games = options.games;
+    stats.positions = positions;
+    stats.seconds = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    return stats;
+}
+
+} // namespace AdiChess::SelfPlay
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Self-play games producing scored positions for evaluation training. Games
+// run concurrently, one per thread at a time, and every thread appends its
+// buffered positions to the shared output file.
+
+namespace AdiChess::SelfPlay {
+
+struct Options {
+    int games = 1;
+    int threads = 1;
+    // Each move is searched to depth, or until nodes runs out after the
+    // first iteration
+    int depth = 4;
+    uint64_t nodes = UINT64_MAX;
+    // Random moves played before positions are recorded
+    int randomPlies = 8;
+    // Games still running after this many plies are adjudicated drawn
+    int maxPlies = 400;
+    uint64_t seed = 0;
+};
+
+struct Stats {
+    uint64_t games = 0;
+    uint64_t positions = 0;
+    double seconds = 0;
+};
+
+// Plays the games and writes quiet scored positions to path as
+// PackedPosition records
+Stats run(std::string const &path, Options const &options);
+
+} // namespace AdiChess::SelfPlay
@@ -0,0 +1,144 @@
+#include "slidingAttacks.h"
+#include "cpu.h"
+
+#if HAS_TARGETS
+#include <immintrin.h>
+#endif
+
+namespace MoveGeneration {
+
+namespace {
+
+// Wrap masks for each fill direction. Moving towards the A file must not land
+// on the H file and vice versa.
+constexpr uint64_t notFileA = ~static_cast<uint64_t>(fileA);
+constexpr uint64_t notFileH = ~static_cast<uint64_t>(fileH);
+
+#if HAS_TARGETS
+
+// Left shifting lanes fill N, W, NW, NE and right shifting lanes fill S, E,
+// SE, SW. Rook sliders occupy the first two lanes and bishop sliders the last
+// two in both.
+TARGET_AVX2 inline __m256i occludedFillLeft(__m256i generator, __m256i propagator,
+                                __m256i shift) {
+    const __m256i shift2 = _mm256_add_epi64(shift, shift);
+    const __m256i shift4 = _mm256_add_epi64(shift2, shift2);
+    generator = _mm256_or_si256(
+        generator,
+        _mm256_and_si256(propagator, _mm256_sllv_epi64(generator, shift)));
+    propagator =
+        _mm256_and_si256(propagator, _mm256_sllv_epi64(propagator, shift));
+    generator = _mm256_or_si256(
+        generator,
+        _mm256_and_si256(propagator, _mm256_sllv_epi64(generator, shift2)));
+    propagator =
+        _mm256_and_si256(propagator, _mm256_sllv_epi64(propagator, shift2));
+    return _mm256_or_si256(
+        generator,
+        _mm256_and_si256(propagator, _mm256_sllv_epi64(generator, shift4)));
+}
+
+TARGET_AVX2 inline __m256i occludedFillRight(__m256i generator, __m256i propagator,
+                                 __m256i shift) {
+    const __m256i shift2 = _mm256_add_epi64(shift, shift);
+    const __m256i shift4 = _mm256_add_epi64(shift2, shift2);
+    generator = _mm256_or_si256(
+        generator,
+        _mm256_and_si256(propagator, _mm256_srlv_epi64(generator, shift)));
+    propagator =
+        _mm256_and_si256(propagator, _mm256_srlv_epi64(propagator, shift));
+    generator = _mm256_or_si256(
+        generator,
+        _mm256_and_si256(propagator, _mm256_srlv_epi64(generator, shift2)));
+    propagator =
+        _mm256_and_si256(propagator, _mm256_srlv_epi64(propagator, shift2));
+    return _mm256_or_si256(
+        generator,
+        _mm256_and_si256(propagator, _mm256_srlv_epi64(generator, shift4)));
+}
+
+#endif
+
+template <int Offset>
+inline uint64_t occludedFill(uint64_t generator, uint64_t propagator) {
+    generator |= propagator & shift<Offset>(generator);
+    propagator &= shift<Offset>(propagator);
+    generator |= propagator & shift<2 * Offset>(generator);
+    propagator &= shift<2 * Offset>(propagator);
+    return generator | (propagator & shift<4 * Offset>(generator));
+}
+
+// Fill then shift once more so the ray includes the blocking square
+template <int Offset>
+inline uint64_t slidingAttacks(uint64_t sliders, uint64_t empty,
+                               uint64_t wrapMask) {
+    return shift<Offset>(occludedFill<Offset>(sliders, empty & wrapMask)) &
+           wrapMask;
+}
+
+SlidingAttacks scalarSlidingAttacks(uint64_t rookSliders,
+                                    uint64_t bishopSliders, uint64_t empty) {
+    uint64_t rookLike = slidingAttacks<8>(rookSliders, empty, ~0ULL) |
+                        slidingAttacks<-8>(rookSliders, empty, ~0ULL) |
+                        slidingAttacks<1>(rookSliders, empty, notFileH) |
+                        slidingAttacks<-1>(rookSliders, empty, notFileA);
+    uint64_t bishopLike = slidingAttacks<9>(bishopSliders, empty, notFileH) |
+                          slidingAttacks<7>(bishopSliders, empty, notFileA) |
+                          slidingAttacks<-7>(bishopSliders, empty, notFileH) |
+                          slidingAttacks<-9>(bishopSliders, empty, notFileA);
+    return {rookLike, bishopLike};
+}
+
+#if HAS_TARGETS
+
+TARGET_AVX2 SlidingAttacks avx2SlidingAttacks(uint64_t rookSliders,
+                                              uint64_t bishopSliders,
+                                              uint64_t empty) {
+    const __m256i shifts = _mm256_setr_epi64x(8, 1, 9, 7);
+    const __m256i leftMasks = _mm256_setr_epi64x(
+        -1, static_cast<int64_t>(notFileH), static_cast<int64_t>(notFileH),
+        static_cast<int64_t>(notFileA));
+    const __m256i rightMasks = _mm256_setr_epi64x(
+        -1, static_cast<int64_t>(notFileA), static_cast<int64_t>(notFileA),
+        static_cast<int64_t>(notFileH));
+    const __m256i sliders = _mm256_setr_epi64x(
+        static_cast<int64_t>(rookSliders), static_cast<int64_t>(rookSliders),
+        static_cast<int64_t>(bishopSliders),
+        static_cast<int64_t>(bishopSliders));
+    const __m256i emptySquares =
+        _mm256_set1_epi64x(static_cast<int64_t>(empty));
+
+    __m256i left = occludedFillLeft(
+        sliders, _mm256_and_si256(emptySquares, leftMasks), shifts);
+    left = _mm256_and_si256(_mm256_sllv_epi64(left, shifts), leftMasks);
+    __m256i right = occludedFillRight(
+        sliders, _mm256_and_si256(emptySquares, rightMasks), shifts);
+    right = _mm256_and_si256(_mm256_srlv_epi64(right, shifts), rightMasks);
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes),
+                       _mm256_or_si256(left, right));
+    return {lanes[0] | lanes[1], lanes[2] | lanes[3]};
+}
+
+#endif
+
+} // namespace
+
+SlidingAttacks getSlidingAttacks(uint64_t rookSliders, uint64_t bishopSliders,
+                                 uint64_t empty) {
+#if HAS_TARGETS
+    if (AdiChess::Cpu::target() == AdiChess::Cpu::AVX2) {
+        return avx2SlidingAttacks(rookSliders, bishopSliders, empty);
+    }
+#endif
+    return scalarSlidingAttacks(rookSliders, bishopSliders, empty);
+}
+
+const char *slidingAttacksImplementation() {
+    return AdiChess::Cpu::target() == AdiChess::Cpu::AVX2
+               ? "AVX2 Kogge-Stone"
+               : "Scalar Kogge-Stone";
+}
+
+} // namespace MoveGeneration
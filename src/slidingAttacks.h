@@ -0,0 +1,26 @@
+#pragma once
+
+#include "moveUtils.h"
+
+// Set-wise sliding attacks using Kogge-Stone occluded fills. All sliders of a
+// kind are filled in every direction at once instead of looking up one piece
+// at a time. On CPUs with AVX2 four directions are filled per instruction,
+// otherwise a scalar fill is used per direction.
+
+namespace MoveGeneration {
+
+struct SlidingAttacks {
+    // Attacks along ranks and files, and along diagonals
+    uint64_t rookLike;
+    uint64_t bishopLike;
+};
+
+// Attacks of rookSliders along ranks and files and of bishopSliders along
+// diagonals. Rays stop on and include the first non-empty square.
+SlidingAttacks getSlidingAttacks(uint64_t rookSliders, uint64_t bishopSliders,
+                                 uint64_t empty);
+
+// Name of the fill implementation selected for this CPU
+const char *slidingAttacksImplementation();
+
+} // namespace MoveGeneration
@@ -0,0 +1,662 @@
+#include "tablebase.h"
+#include "moveGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <set>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace AdiChess::Tablebase {
+
+namespace {
+
+// Stored values, see tablebase.h. UNKNOWN only appears during generation and
+// INVALID marks unreachable indices such as overlapping pieces.
+constexpr uint8_t DRAW = 0;
+constexpr uint8_t MAX_VALUE = 253;
+constexpr uint8_t UNKNOWN = 254;
+constexpr uint8_t INVALID = 255;
+
+constexpr char MAGIC[4] = {'A', 'T', 'B', '1'};
+constexpr size_t HEADER_SIZE = 16;
+
+// Pieces appear in signatures strongest first
+constexpr Piece::Type SIGNATURE_ORDER[] = {Piece::Type::Q, Piece::Type::R,
+                                           Piece::Type::B, Piece::Type::N,
+                                           Piece::Type::P};
+// Indexed by Piece::Type: K, Q, B, R, N, P
+constexpr char PIECE_CHARS[Piece::Type::NUM_PIECES] = {'K', 'Q', 'B',
+                                                       'R', 'N', 'P'};
+constexpr int PIECE_STRENGTHS[Piece::Type::NUM_PIECES] = {0, 9, 3, 5, 3, 1};
+
+constexpr int MAX_PIECES = 6;
+
+Piece::Type pieceType(char c) {
+    for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+        if (PIECE_CHARS[type] == c) {
+            return static_cast<Piece::Type>(type);
+        }
+    }
+    return Piece::Type::NONE;
+}
+
+// Place of a piece in SIGNATURE_ORDER
+size_t signatureRank(char c) {
+    return std::find(std::begin(SIGNATURE_ORDER), std::end(SIGNATURE_ORDER),
+                     pieceType(c)) -
+           std::begin(SIGNATURE_ORDER);
+}
+
+// Lists the pieces of one side after its king in signature order
+void sortSide(std::string &side) {
+    std::sort(side.begin() + 1, side.end(), [](char lhs, char rhs) {
+        return signatureRank(lhs) < signatureRank(rhs);
+    });
+}
+
+// Positions are indexed from h1 so files run from the most significant bit
+constexpr int fileOf(int position) { return 7 - position % 8; }
+constexpr int rankOf(int position) { return position / 8; }
+constexpr int transpose(int position) {
+    return fileOf(position) * 8 + 7 - rankOf(position);
+}
+
+// Pawnless tables restrict the white king to the a1-d1-d4 triangle
+struct KingTriangle {
+    int index[64];
+    int squares[10];
+
+    constexpr KingTriangle() : index{}, squares{} {
+        int count = 0;
+        for (int position = 0; position < 64; ++position) {
+            index[position] = -1;
+            if (fileOf(position) <= 3 &&
+                rankOf(position) <= fileOf(position)) {
+                index[position] = count;
+                squares[count++] = position;
+            }
+        }
+    }
+};
+
+constexpr KingTriangle TRIANGLE;
+
+std::string splitWhite(std::string const &signature) {
+    return signature.substr(0, signature.find('K', 1));
+}
+
+std::string splitBlack(std::string const &signature) {
+    return signature.substr(signature.find('K', 1));
+}
+
+std::string flipSignature(std::string const &signature) {
+    return splitBlack(signature) + splitWhite(signature);
+}
+
+// Orders one side's material, more pieces first, then total strength, then the
+// strongest piece
+bool stronger(std::string const &lhs, std::string const &rhs) {
+    auto strength = [](std::string const &side) {
+        int total = 0;
+        for (char c : side) {
+            total += PIECE_STRENGTHS[pieceType(c)];
+        }
+        return total;
+    };
+    auto rank = [](std::string const &side) {
+        std::string ranks;
+        for (char c : side) {
+            ranks += static_cast<char>(signatureRank(c));
+        }
+        return ranks;
+    };
+    if (lhs.size() != rhs.size())
+        return lhs.size() > rhs.size();
+    if (strength(lhs) != strength(rhs))
+        return strength(lhs) > strength(rhs);
+    return rank(lhs) < rank(rhs);
+}
+
+// Tables are stored with the stronger side as white
+std::string canonical(std::string const &signature) {
+    return stronger(splitBlack(signature), splitWhite(signature))
+               ? flipSignature(signature)
+               : signature;
+}
+
+template <typename F>
+void parallelFor(size_t size, int threads, F const &body) {
+    constexpr size_t BLOCK_SIZE = 4096;
+    std::atomic<size_t> nextBlock{0};
+    auto worker = [&] {
+        Board board;
+        for (size_t begin = nextBlock.fetch_add(BLOCK_SIZE); begin < size;
+             begin = nextBlock.fetch_add(BLOCK_SIZE)) {
+            body(board, begin, std::min(size, begin + BLOCK_SIZE));
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int thread = 1; thread < threads; ++thread) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : workers) {
+        thread.join();
+    }
+}
+
+// Piece counts apart from kings, four bits per piece type with white's
+// counts in the low half
+constexpr int MATERIAL_SIDE_BITS = 20;
+
+uint64_t materialKey(std::string const &signature) {
+    size_t split = signature.find('K', 1);
+    uint64_t key = 0;
+    for (size_t i = 1; i < signature.size(); ++i) {
+        if (i == split) {
+            continue;
+        }
+        key += 1ULL << (4 * signatureRank(signature[i]) +
+                        (i < split ? 0 : MATERIAL_SIDE_BITS));
+    }
+    return key;
+}
+
+uint64_t materialKey(Board const &board) {
+    uint64_t key = 0;
+    int shift = 0;
+    for (Side side : {Side::W, Side::B}) {
+        for (Piece::Type type : SIGNATURE_ORDER) {
+            // Few pieces, clearing bits beats a full population count
+            uint64_t positions = board.getPositions(type, side);
+            uint64_t count = 0;
+            for (; positions; positions &= positions - 1) {
+                ++count;
+            }
+            key |= count << shift;
+            shift += 4;
+        }
+    }
+    return key;
+}
+
+// Whether more than limit bits are set, found by clearing at most limit of
+// them rather than counting every bit
+bool moreBitsThan(uint64_t bitboard, int limit) {
+    for (int i = 0; i < limit && bitboard; ++i) {
+        bitboard &= bitboard - 1;
+    }
+    return bitboard != 0;
+}
+
+// The same material with the colours swapped
+uint64_t flipMaterial(uint64_t key) {
+    constexpr uint64_t sideMask = (1ULL << MATERIAL_SIDE_BITS) - 1;
+    return key >> MATERIAL_SIDE_BITS | (key & sideMask) << MATERIAL_SIDE_BITS;
+}
+
+} // namespace
+
+struct Tablebases::Layout {
+    explicit Layout(std::string const &signature) {
+        size_t split = signature.find('K', 1);
+        for (size_t i = 1; i < signature.size(); ++i) {
+            if (i != split) {
+                pieces.emplace_back(pieceType(signature[i]),
+                                    i < split ? Side::W : Side::B);
+            }
+        }
+        pawns = signature.find('P') != std::string::npos;
+        size = (pawns ? 32 : 10) * 64 * 2;
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            size *= 64;
+        }
+    }
+
+    int count() const { return pieces.size() + 2; }
+
+    // Squares are white king, black king then the remaining pieces in
+    // signature order. Side to move is 0 for white.
+    size_t index(int squares[], int sideToMove) const {
+        int n = count();
+        if (fileOf(squares[0]) > 3) {
+            for (int i = 0; i < n; ++i)
+                squares[i] ^= 7;
+        }
+        if (!pawns) {
+            if (rankOf(squares[0]) > 3) {
+                for (int i = 0; i < n; ++i)
+                    squares[i] ^= 56;
+            }
+            if (rankOf(squares[0]) > fileOf(squares[0])) {
+                for (int i = 0; i < n; ++i)
+                    squares[i] = transpose(squares[i]);
+            }
+        }
+
+        size_t index = pawns ? rankOf(squares[0]) * 4 + fileOf(squares[0])
+                             : TRIANGLE.index[squares[0]];
+        for (int i = 1; i < n; ++i) {
+            index = index * 64 + squares[i];
+        }
+        return index * 2 + sideToMove;
+    }
+
+    int decode(size_t index, int squares[]) const {
+        int sideToMove = index % 2;
+        index /= 2;
+        for (int i = count() - 1; i > 0; --i) {
+            squares[i] = index % 64;
+            index /= 64;
+        }
+        squares[0] = pawns ? (index / 4) * 8 + 7 - index % 4
+                           : TRIANGLE.squares[index];
+        return sideToMove;
+    }
+
+    // Reads squares from the board, flipped when black holds the table's
+    // white material
+    int gather(Board const &board, bool flip, int squares[]) const {
+        const Side white = flip ? Side::B : Side::W;
+        const int mirror = flip ? 56 : 0;
+        squares[0] = Utility::bitScanForward(
+                         board.getPositions(Piece::Type::K, white)) ^
+                     mirror;
+        squares[1] = Utility::bitScanForward(
+                         board.getPositions(Piece::Type::K, ~white)) ^
+                     mirror;
+        uint64_t used = 0;
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            Side side = pieces[i].side == Side::W ? white : ~white;
+            uint64_t positions =
+                board.getPositions(pieces[i].type, side) & ~used;
+            uint64_t position = Utility::bitScanForward(positions);
+            used |= 1ULL << position;
+            squares[i + 2] = position ^ mirror;
+        }
+        return board.getCurrentPlayer() == white ? 0 : 1;
+    }
+
+    // Places the position on the board, false if it cannot occur
+    bool setUp(Board &board, int squares[], int sideToMove) const {
+        int n = count();
+        uint64_t occupied = 0;
+        for (int i = 0; i < n; ++i) {
+            if (occupied & (1ULL << squares[i]))
+                return false;
+            occupied |= 1ULL << squares[i];
+        }
+        if (MoveGeneration::kingAttacks[squares[0]] & (1ULL << squares[1]))
+            return false;
+
+        board.clear(sideToMove ? Side::B : Side::W);
+        board(squares[0], Piece(Piece::Type::K, Side::W));
+        board(squares[1], Piece(Piece::Type::K, Side::B));
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            int rank = rankOf(squares[i + 2]);
+            if (pieces[i].type == Piece::Type::P && (rank == 0 || rank == 7))
+                return false;
+            board(squares[i + 2], pieces[i]);
+        }
+
+        // Side that just moved cannot be left in check
+        return !board.inCheck(board.getOpponent());
+    }
+
+    std::vector<Piece> pieces;
+    bool pawns;
+    size_t size;
+};
+
+std::string signature(Board const &board) {
+    std::string result;
+    for (Side side : {Side::W, Side::B}) {
+        result += 'K';
+        for (Piece::Type type : SIGNATURE_ORDER) {
+            result.append(
+                Utility::popCnt(board.getPositions(type, side)),
+                PIECE_CHARS[type]);
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> allSignatures(int maxPieces) {
+    std::set<std::string> unique;
+
+    // Enumerate piece multisets for both sides through the signature order
+    std::vector<std::string> sides = {"K"};
+    for (int pieces = 1; pieces <= maxPieces - 2; ++pieces) {
+        std::vector<std::string> extended;
+        for (auto const &side : sides) {
+            size_t last = side.size() == 1 ? 0 : signatureRank(side.back());
+            for (size_t i = last; i < std::size(SIGNATURE_ORDER); ++i) {
+                extended.push_back(side + PIECE_CHARS[SIGNATURE_ORDER[i]]);
+            }
+        }
+        sides.insert(sides.end(), extended.begin(), extended.end());
+        std::sort(sides.begin(), sides.end());
+        sides.erase(std::unique(sides.begin(), sides.end()), sides.end());
+    }
+
+    for (auto const &white : sides) {
+        for (auto const &black : sides) {
+            int count = white.size() + black.size();
+            if (count > 2 && count <= maxPieces) {
+                unique.insert(canonical(white + black));
+            }
+        }
+    }
+
+    // Captures depend on fewer pieces and promotions on fewer pawns
+    std::vector<std::string> ordered(unique.begin(), unique.end());
+    std::stable_sort(ordered.begin(), ordered.end(),
+                     [](std::string const &lhs, std::string const &rhs) {
+                         auto pawns = [](std::string const &signature) {
+                             return std::count(signature.begin(),
+                                               signature.end(), 'P');
+                         };
+                         if (lhs.size() != rhs.size())
+                             return lhs.size() < rhs.size();
+                         return pawns(lhs) < pawns(rhs);
+                     });
+    return ordered;
+}
+
+std::vector<std::string> dependencies(std::string const &signature) {
+    std::vector<std::string> result;
+    const std::string white = splitWhite(signature);
+    const std::string black = splitBlack(signature);
+    // One side's material replaced, the other kept
+    auto add = [&](Side side, std::string const &material) {
+        std::string name =
+            side == Side::W ? material + black : white + material;
+        if (name.size() == 2) {
+            return;
+        }
+        name = canonical(name);
+        if (std::find(result.begin(), result.end(), name) == result.end()) {
+            result.push_back(name);
+        }
+    };
+    for (Side side : {Side::W, Side::B}) {
+        std::string const &own = side == Side::W ? white : black;
+        for (size_t i = 1; i < own.size(); ++i) {
+            std::string captured = own;
+            captured.erase(i, 1);
+            add(side, captured);
+            if (own[i] != 'P') {
+                continue;
+            }
+            for (char promotion : {'Q', 'R', 'B', 'N'}) {
+                std::string promoted = captured + promotion;
+                sortSide(promoted);
+                add(side, promoted);
+            }
+        }
+    }
+    return result;
+}
+
+Tablebases::Tablebases() = default;
+
+Tablebases::Tablebases(std::string const &directory) {
+    for (auto const &signature : allSignatures(MAX_PIECES)) {
+        load(directory + "/" + signature + ".atb", signature);
+    }
+}
+
+Tablebases::~Tablebases() {
+    for (auto &entry : tables) {
+        if (entry.second.mappedSize) {
+            munmap(const_cast<uint8_t *>(entry.second.data) - HEADER_SIZE,
+                   entry.second.mappedSize);
+        }
+    }
+}
+
+bool Tablebases::contains(std::string const &signature) const {
+    return tables.count(signature);
+}
+
+bool Tablebases::load(std::string const &path, std::string const &signature) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    Layout layout(signature);
+    struct stat fileStat;
+    void *mapped = MAP_FAILED;
+    if (fstat(fd, &fileStat) == 0 &&
+        static_cast<size_t>(fileStat.st_size) == HEADER_SIZE + layout.size) {
+        mapped = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    auto bytes = static_cast<const uint8_t *>(mapped);
+    if (std::memcmp(bytes, MAGIC, sizeof(MAGIC)) != 0) {
+        munmap(mapped, fileStat.st_size);
+        return false;
+    }
+
+    Table &table = add(signature);
+    table.data = bytes + HEADER_SIZE;
+    table.size = layout.size;
+    table.mappedSize = fileStat.st_size;
+    std::memcpy(&table.maxPlies, bytes + sizeof(MAGIC), sizeof(int));
+    largest = std::max(largest, layout.count());
+    return true;
+}
+
+Tablebases::Table &Tablebases::add(std::string const &signature) {
+    Table &table = tables[signature];
+    table.layout = std::make_unique<Layout>(signature);
+    materials[materialKey(signature)] = &table;
+    return table;
+}
+
+std::optional<uint8_t> Tablebases::probeValue(Board const &board) const {
+    uint64_t occupied =
+        board.getPositions(Side::W) | board.getPositions(Side::B);
+    // Both kings are always there
+    if (!moreBitsThan(occupied, 2)) {
+        return DRAW;
+    }
+    if (moreBitsThan(occupied, largest)) {
+        return std::nullopt;
+    }
+
+    const uint64_t key = materialKey(board);
+    bool flip = false;
+    auto table = materials.find(key);
+    if (table == materials.end()) {
+        flip = true;
+        table = materials.find(flipMaterial(key));
+        if (table == materials.end()) {
+            return std::nullopt;
+        }
+    }
+
+    Layout const &layout = *table->second->layout;
+    int squares[MAX_PIECES];
+    int sideToMove = layout.gather(board, flip, squares);
+    uint8_t value = table->second->data[layout.index(squares, sideToMove)];
+    if (value > MAX_VALUE) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<ProbeResult> Tablebases::probe(Board const &board) const {
+    // Tables hold no castling rights or en passant captures
+    if (board.getCastlingRights()) {
+        return std::nullopt;
+    }
+    uint64_t enPassantTarget = board.getEnPassantTarget();
+    if (enPassantTarget < 64 &&
+        (MoveGeneration::pawnAttacks[board.getOpponent()][enPassantTarget] &
+         board.getPositions(Piece::Type::P, board.getCurrentPlayer()))) {
+        return std::nullopt;
+    }
+
+    auto value = probeValue(board);
+    if (!value) {
+        return std::nullopt;
+    }
+    if (*value == DRAW) {
+        return ProbeResult{ProbeResult::DRAW, 0};
+    }
+    int plies = *value - 1;
+    return ProbeResult{plies % 2 ? ProbeResult::WIN : ProbeResult::LOSS,
+                       plies};
+}
+
+bool Tablebases::generate(std::string const &directory,
+                          std::string const &signature, int threads) {
+    const Layout layout(signature);
+
+    // Every capture and promotion must lead to a table that already exists
+    int maxDependencyPlies = 0;
+    for (auto const &dependency : dependencies(signature)) {
+        auto table = tables.find(dependency);
+        if (table == tables.end()) {
+            return false;
+        }
+        maxDependencyPlies =
+            std::max(maxDependencyPlies, table->second.maxPlies);
+    }
+
+    std::vector<uint8_t> values(layout.size, UNKNOWN);
+
+    // Value of the position reached after a move, same material positions
+    // are read from the table being generated
+    auto childValue = [&](Board const &board, bool sameMaterial) -> uint8_t {
+        if (sameMaterial) {
+            int squares[MAX_PIECES];
+            int sideToMove = layout.gather(board, false, squares);
+            return values[layout.index(squares, sideToMove)];
+        }
+        return probeValue(board).value_or(INVALID);
+    };
+
+    // Invalid positions, checkmates and stalemates
+    parallelFor(layout.size, threads,
+                [&](Board &board, size_t begin, size_t end) {
+                    int squares[MAX_PIECES];
+                    for (size_t index = begin; index < end; ++index) {
+                        int sideToMove = layout.decode(index, squares);
+                        if (!layout.setUp(board, squares, sideToMove)) {
+                            values[index] = INVALID;
+                            continue;
+                        }
+                        MoveGeneration::MoveGenerator moveGenerator(board);
+                        bool hasMove = std::any_of(
+                            moveGenerator.begin(), moveGenerator.end(),
+                            [&](Move const &move) {
+                                return board.legalMove(move);
+                            });
+                        if (!hasMove) {
+                            values[index] =
+                                board.inCheck(board.getCurrentPlayer()) ? 1
+                                                                        : DRAW;
+                        }
+                    }
+                });
+
+    // Each pass resolves the positions exactly plies from mate. Wins need a
+    // child lost in plies - 1, losses need every child won within plies - 1.
+    int maxPlies = 0;
+    for (int plies = 1; plies < MAX_VALUE; ++plies) {
+        std::vector<uint8_t> next = values;
+        std::atomic<size_t> resolved{0};
+
+        parallelFor(
+            layout.size, threads, [&](Board &board, size_t begin, size_t end) {
+                int squares[MAX_PIECES];
+                for (size_t index = begin; index < end; ++index) {
+                    if (values[index] != UNKNOWN) {
+                        continue;
+                    }
+                    int sideToMove = layout.decode(index, squares);
+                    layout.setUp(board, squares, sideToMove);
+
+                    // Odd passes can only find wins and even passes losses
+                    const bool winPass = plies % 2;
+                    bool resolvedHere = !winPass;
+                    int longestWin = 0;
+                    MoveGeneration::MoveGenerator moveGenerator(board);
+                    for (auto const &move : moveGenerator) {
+                        if (!board.legalMove(move)) {
+                            continue;
+                        }
+                        bool sameMaterial =
+                            !move.isCapture() && !move.isPromotion();
+                        board.makeMove(move);
+                        uint8_t child = childValue(board, sameMaterial);
+                        board.unmakeMove(move);
+
+                        bool childWins = child != DRAW && child <= MAX_VALUE &&
+                                         (child - 1) % 2;
+                        if (winPass && child == plies) {
+                            resolvedHere = true;
+                            break;
+                        }
+                        if (!winPass) {
+                            if (!childWins) {
+                                resolvedHere = false;
+                                break;
+                            }
+                            longestWin = std::max(longestWin, child - 1);
+                        }
+                    }
+
+                    if (resolvedHere &&
+                        (winPass || longestWin == plies - 1)) {
+                        next[index] = plies + 1;
+                        ++resolved;
+                    }
+                }
+            });
+
+        values.swap(next);
+        if (resolved) {
+            maxPlies = plies;
+        } else if (plies > maxDependencyPlies + 1) {
+            break;
+        }
+    }
+
+    // Anything never resolved cannot be forced either way
+    std::replace(values.begin(), values.end(), UNKNOWN, DRAW);
+
+    std::ofstream file(directory + "/" + signature + ".atb", std::ios::binary);
+    file.write(MAGIC, sizeof(MAGIC));
+    file.write(reinterpret_cast<const char *>(&maxPlies), sizeof(int));
+    uint64_t size = layout.size;
+    file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    file.write(reinterpret_cast<const char *>(values.data()), values.size());
+    if (!file) {
+        return false;
+    }
+
+    Table &table = add(signature);
+    table.generated = std::move(values);
+    table.data = table.generated.data();
+    table.size = layout.size;
+    table.maxPlies = maxPlies;
+    largest = std::max(largest, layout.count());
+    return true;
+}
+
+} // namespace AdiChess::Tablebase
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "board.h"
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Endgame tablebases for positions of up to four pieces, kings included.
+// Tables are generated retrogradely on top of Board and MoveGenerator and
+// store one byte per position: 0 for a draw, otherwise the number of plies to
+// mate plus one. An odd number of plies is a win for the side to move, an even
+// number a loss. Positions are indexed by material signature (e.g. "KRKP",
+// white pieces first) with the white king reduced by board symmetry.
+
+namespace AdiChess::Tablebase {
+
+struct ProbeResult {
+    enum Outcome { LOSS = -1, DRAW = 0, WIN = 1 };
+    Outcome outcome;
+    // Plies to mate, zero for draws
+    int plies;
+};
+
+// Material signature of the position, such as "KQKR"
+std::string signature(Board const &board);
+
+// Signatures of every ending with up to maxPieces pieces in generation order,
+// so each table only depends on tables earlier in the list
+std::vector<std::string> allSignatures(int maxPieces);
+
+// Tables that captures and promotions in signature lead to, bare kings left
+// out
+std::vector<std::string> dependencies(std::string const &signature);
+
+class Tablebases {
+public:
+    Tablebases();
+    // Memory maps every table found in directory
+    explicit Tablebases(std::string const &directory);
+    ~Tablebases();
+    Tablebases(const Tablebases &) = delete;
+    Tablebases &operator=(const Tablebases &) = delete;
+
+    size_t size() const { return tables.size(); }
+    int maxPieces() const { return largest; }
+    bool contains(std::string const &signature) const;
+
+    std::optional<ProbeResult> probe(Board const &board) const;
+
+    // Generates the table for signature using the given number of threads
+    // and writes it to directory. Tables it depends on must already be
+    // loaded or generated.
+    bool generate(std::string const &directory, std::string const &signature,
+                  int threads);
+
+private:
+    // Index layout and symmetry handling of one material signature
+    struct Layout;
+
+    struct Table {
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        // Set when the table is memory mapped rather than generated
+        size_t mappedSize = 0;
+        // Longest distance to mate stored, bounds generation of dependants
+        int maxPlies = 0;
+        std::vector<uint8_t> generated;
+        std::unique_ptr<Layout const> layout;
+    };
+
+    std::optional<uint8_t> probeValue(Board const &board) const;
+    bool load(std::string const &path, std::string const &signature);
+
+    // Register a table under its signature and material key
+    Table &add(std::string const &signature);
+
+    std::map<std::string, Table> tables;
+    // The tables by the piece counts of both sides, probed without building
+    // a signature
+    std::unordered_map<uint64_t, Table const *> materials;
+    int largest = 0;
+};
+
+} // namespace AdiChess::Tablebase
@@ -0,0 +1,90 @@
+#include "transpositionTable.h"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace AdiChess {
+
+namespace {
+
+/* DATA LAYOUT:
+LSB |-- 16 --|-- 32 --|-- 8 --|-- 2 --| ... MSB
+       Move    Score   Depth   Bound */
+
+uint64_t pack(int depth, int score, TranspositionTable::Bound bound,
+              Move move) {
+    return move.raw() | static_cast<uint64_t>(static_cast<uint32_t>(score)) << 16 |
+           static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 48 |
+           static_cast<uint64_t>(bound) << 56;
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t megabytes) { resize(megabytes); }
+
+void TranspositionTable::resize(size_t megabytes) {
+    // Largest power of two number of slots that fits
+    size_t wanted = std::max<size_t>(megabytes, 1) * 1024 * 1024 / sizeof(Slot);
+    count = 1;
+    while (count * 2 <= wanted) {
+        count *= 2;
+    }
+    static_assert(std::is_trivially_default_constructible_v<Slot>,
+                  "Fresh slots are left zero, empty keys and data");
+    slots.reset();
+    slots = Memory::makeLargeArray<Slot>(count);
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < count; ++i) {
+        slots[i].key.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TranspositionTable::probe(uint64_t key, Entry &entry) const {
+    Slot const &slot = slots[key & (count - 1)];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if ((slot.key.load(std::memory_order_relaxed) ^ data) != key ||
+        (data >> 56) == NONE) {
+        return false;
+    }
+    entry.move = Move::fromRaw(static_cast<uint16_t>(data));
+    entry.score = static_cast<int32_t>(data >> 16);
+    entry.depth = static_cast<uint8_t>(data >> 48);
+    entry.bound = static_cast<Bound>(data >> 56);
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, Bound bound,
+                               Move move) {
+    Slot &slot = slots[key & (count - 1)];
+    uint64_t old = slot.data.load(std::memory_order_relaxed);
+    bool sameKey = (slot.key.load(std::memory_order_relaxed) ^ old) == key;
+    // Deeper results of the same position are kept over shallower ones
+    if (sameKey && static_cast<uint8_t>(old >> 48) > depth && bound != EXACT) {
+        return;
+    }
+    // Keep the known best move when the new result has none
+    if (sameKey && move == NO_MOVE) {
+        move = Move::fromRaw(static_cast<uint16_t>(old));
+    }
+    uint64_t data = pack(depth, score, bound, move);
+    slot.key.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::prefetch(uint64_t key) const {
+    Memory::prefetch(&slots[key & (count - 1)]);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sample = std::min<size_t>(count, 1000);
+    int used = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        used += (slots[i].data.load(std::memory_order_relaxed) >> 56) != NONE;
+    }
+    return static_cast<int>(used * 1000 / sample);
+}
+
+} // namespace AdiChess
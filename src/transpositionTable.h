@@ -0,0 +1,52 @@
+#pragma once
+
+#include "largePages.h"
+#include "move.h"
+
+#include <atomic>
+#include <memory>
+
+// Hash table of search results keyed by Board::getKey. The table is shared by
+// searches on several threads without locking: each entry stores its key
+// xored with its data, so a torn write leaves an entry whose key no longer
+// matches and the probe misses. The slots are allocated in huge pages.
+
+namespace AdiChess {
+
+class TranspositionTable : public Memory::Prefetcher {
+public:
+    enum Bound : uint8_t { NONE, UPPER, LOWER, EXACT };
+
+    struct Entry {
+        Move move;
+        int score;
+        int depth;
+        Bound bound;
+    };
+
+    explicit TranspositionTable(size_t megabytes = 16);
+
+    // Drops every entry, the table must not be in use
+    void resize(size_t megabytes);
+    void clear();
+
+    bool probe(uint64_t key, Entry &entry) const;
+    void store(uint64_t key, int depth, int score, Bound bound, Move move);
+    // Starts loading the slot of key
+    void prefetch(uint64_t key) const override;
+
+    size_t size() const { return count; }
+    // Entries in use per thousand, sampled from the start of the table
+    int hashfull() const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> data;
+    };
+
+    Memory::LargeArray<Slot> slots;
+    size_t count = 0;
+};
+
+} // namespace AdiChess
@@ -0,0 +1,292 @@
+#include "tuner.h"
+#include "evaluationParameters.h"
+#include "packedPosition.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+namespace AdiChess::Tuning {
+
+namespace {
+
+// Feature layout within a phase
+constexpr int MATERIAL = 0;
+constexpr int MOBILITY = Piece::Type::NUM_PIECES;
+constexpr int BISHOP_PAIR = 2 * Piece::Type::NUM_PIECES;
+
+// Positions evaluated together in the vectorised loops
+constexpr size_t BLOCK_SIZE = 256;
+
+const char *PIECE_NAMES[Piece::Type::NUM_PIECES] = {
+    [Piece::Type::K] = "K", [Piece::Type::Q] = "Q", [Piece::Type::B] = "B",
+    [Piece::Type::R] = "R", [Piece::Type::N] = "N", [Piece::Type::P] = "P"};
+
+// Splits [0, size) into one contiguous range per thread
+template <typename F> void parallelFor(size_t size, int threads, F const &body) {
+    std::vector<std::thread> workers;
+    size_t chunk = (size + threads - 1) / threads;
+    for (int thread = 1; thread < threads; ++thread) {
+        size_t begin = std::min(size, thread * chunk);
+        size_t end = std::min(size, begin + chunk);
+        workers.emplace_back(body, thread, begin, end);
+    }
+    body(0, 0, std::min(size, chunk));
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+// Opening and endgame evaluations for a block of positions
+void evaluateBlock(Dataset const &dataset, size_t begin, size_t count,
+                   Parameters const &parameters, float *evaluations) {
+    float opening[BLOCK_SIZE] = {0};
+    float endgame[BLOCK_SIZE] = {0};
+    for (int feature = 0; feature < NUM_FEATURES; ++feature) {
+        const int16_t *values = dataset.features[feature].data() + begin;
+        const float openingWeight = parameters[feature];
+        const float endgameWeight = parameters[NUM_FEATURES + feature];
+        for (size_t i = 0; i < count; ++i) {
+            opening[i] += openingWeight * values[i];
+            endgame[i] += endgameWeight * values[i];
+        }
+    }
+    const float *phases = dataset.phases.data() + begin;
+    for (size_t i = 0; i < count; ++i) {
+        evaluations[i] = opening[i] + (endgame[i] - opening[i]) * phases[i];
+    }
+}
+
+float sigmoid(float k, float evaluation) {
+    return 1 / (1 + std::exp(-k * evaluation));
+}
+
+// Accumulates the loss gradient over [begin, end) into gradient, returns the
+// summed squared error
+double accumulateGradient(Dataset const &dataset, size_t begin, size_t end,
+                          Parameters const &parameters, double k,
+                          Parameters &gradient) {
+    double error = 0;
+    float evaluations[BLOCK_SIZE];
+    float openingTerms[BLOCK_SIZE];
+    float endgameTerms[BLOCK_SIZE];
+    for (size_t block = begin; block < end; block += BLOCK_SIZE) {
+        size_t count = std::min(BLOCK_SIZE, end - block);
+        evaluateBlock(dataset, block, count, parameters, evaluations);
+
+        const float *phases = dataset.phases.data() + block;
+        const float *results = dataset.results.data() + block;
+        for (size_t i = 0; i < count; ++i) {
+            float predicted = sigmoid(k, evaluations[i]);
+            float difference = predicted - results[i];
+            error += difference * difference;
+            // Derivative of the squared error with respect to the evaluation
+            float slope = 2 * difference * predicted * (1 - predicted) * k;
+            openingTerms[i] = slope * (1 - phases[i]);
+            endgameTerms[i] = slope * phases[i];
+        }
+
+        for (int feature = 0; feature < NUM_FEATURES; ++feature) {
+            const int16_t *values = dataset.features[feature].data() + block;
+            float opening = 0;
+            float endgame = 0;
+            for (size_t i = 0; i < count; ++i) {
+                opening += openingTerms[i] * values[i];
+                endgame += endgameTerms[i] * values[i];
+            }
+            gradient[feature] += opening;
+            gradient[NUM_FEATURES + feature] += endgame;
+        }
+    }
+    return error;
+}
+
+void writeTable(std::ofstream &file, std::string const &name,
+                Parameters const &parameters, int offset) {
+    file << "constexpr int " << name << "[2][6] = {\n";
+    for (int phase = 0; phase < 2; ++phase) {
+        file << "    [Phase::" << (phase ? "ENDGAME" : "OPENING") << "] = {";
+        for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+            file << (type ? ",\n                        " : "")
+                 << "[Piece::Type::" << PIECE_NAMES[type] << "] = "
+                 << std::lround(parameters[phase * NUM_FEATURES + offset + type]);
+        }
+        file << "},\n";
+    }
+    file << "};\n";
+}
+
+} // namespace
+
+Parameters currentParameters() {
+    using namespace Evaluation;
+    Parameters parameters{};
+    for (int phase = 0; phase < 2; ++phase) {
+        for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+            parameters[phase * NUM_FEATURES + MATERIAL + type] =
+                MATERIAL_VALUES[phase][type];
+            parameters[phase * NUM_FEATURES + MOBILITY + type] =
+                MOBILITY_VALUES[phase][type];
+        }
+        parameters[phase * NUM_FEATURES + BISHOP_PAIR] =
+            BISHOP_PAIR_VALUES[phase];
+    }
+    return parameters;
+}
+
+void Dataset::add(Board const &board, double result) {
+    AttackInfo const &attacks = board.getAttackInfo();
+    for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+        int counts[2];
+        int mobility[2];
+        for (Side side : {Side::W, Side::B}) {
+            counts[side] = Utility::popCnt(
+                board.getPositions(static_cast<Piece::Type>(type), side));
+            mobility[side] = Utility::popCnt(attacks.pieceAttacks[type][side] &
+                                             ~board.getPositions(side));
+        }
+        features[MATERIAL + type].push_back(counts[Side::W] - counts[Side::B]);
+        features[MOBILITY + type].push_back(mobility[Side::W] -
+                                            mobility[Side::B]);
+        if (type == Piece::Type::B) {
+            features[BISHOP_PAIR].push_back((counts[Side::W] == 2) -
+                                            (counts[Side::B] == 2));
+        }
+    }
+    phases.push_back(Evaluation::computePhase(board) / 256.0f);
+    results.push_back(result);
+}
+
+Dataset loadDataset(std::string const &path, size_t limit) {
+    Dataset dataset;
+    PackedReader reader(path);
+    PackedPosition position;
+    Board board;
+    while (dataset.size() < limit && reader.next(position)) {
+        if (!position.hasScore()) {
+            continue;
+        }
+        unpack(position, board);
+        dataset.add(board, (position.result + 1) / 2.0);
+    }
+    return dataset;
+}
+
+double evaluate(Dataset const &dataset, size_t index,
+                Parameters const &parameters) {
+    float evaluation;
+    evaluateBlock(dataset, index, 1, parameters, &evaluation);
+    return evaluation;
+}
+
+double loss(Dataset const &dataset, Parameters const &parameters, double k,
+            int threads) {
+    std::vector<double> errors(threads);
+    parallelFor(dataset.size(), threads,
+                [&](int thread, size_t begin, size_t end) {
+                    Parameters unused{};
+                    errors[thread] = accumulateGradient(
+                        dataset, begin, end, parameters, k, unused);
+                });
+    double error = 0;
+    for (double threadError : errors) {
+        error += threadError;
+    }
+    return dataset.size() ? error / dataset.size() : 0;
+}
+
+double fitScale(Dataset const &dataset, Parameters const &parameters,
+                int threads) {
+    // Golden section search, the loss is unimodal in k
+    constexpr double ratio = 0.6180339887498949;
+    double low = 1e-5;
+    double high = 0.1;
+    for (int iteration = 0; iteration < 40; ++iteration) {
+        double left = high - ratio * (high - low);
+        double right = low + ratio * (high - low);
+        if (loss(dataset, parameters, left, threads) <
+            loss(dataset, parameters, right, threads)) {
+            high = right;
+        } else {
+            low = left;
+        }
+    }
+    return (low + high) / 2;
+}
+
+Parameters tune(Dataset const &dataset, Parameters parameters, double k,
+                Options const &options,
+                std::function<void(int, double)> const &report) {
+    constexpr double beta1 = 0.9;
+    constexpr double beta2 = 0.999;
+    constexpr double epsilon = 1e-8;
+    Parameters firstMoment{};
+    Parameters secondMoment{};
+    int step = 0;
+
+    for (int epoch = 0; epoch < options.epochs; ++epoch) {
+        for (size_t batch = 0; batch < dataset.size();
+             batch += options.batchSize) {
+            size_t batchEnd = std::min(dataset.size(), batch + options.batchSize);
+            std::vector<Parameters> gradients(options.threads, Parameters{});
+            parallelFor(batchEnd - batch, options.threads,
+                        [&](int thread, size_t begin, size_t end) {
+                            accumulateGradient(dataset, batch + begin,
+                                               batch + end, parameters, k,
+                                               gradients[thread]);
+                        });
+
+            ++step;
+            for (int i = 0; i < NUM_PARAMETERS; ++i) {
+                double gradient = 0;
+                for (auto const &threadGradient : gradients) {
+                    gradient += threadGradient[i];
+                }
+                gradient /= batchEnd - batch;
+                firstMoment[i] = beta1 * firstMoment[i] + (1 - beta1) * gradient;
+                secondMoment[i] =
+                    beta2 * secondMoment[i] + (1 - beta2) * gradient * gradient;
+                double corrected1 = firstMoment[i] / (1 - std::pow(beta1, step));
+                double corrected2 =
+                    secondMoment[i] / (1 - std::pow(beta2, step));
+                parameters[i] -= options.learningRate * corrected1 /
+                                 (std::sqrt(corrected2) + epsilon);
+            }
+        }
+        if (report) {
+            report(epoch, loss(dataset, parameters, k, options.threads));
+        }
+    }
+    return parameters;
+}
+
+bool writeHeader(std::string const &path, Parameters const &parameters) {
+    std::ofstream file(path);
+    file << "#pragma once\n\n"
+            "#include \"evaluation.h\"\n\n"
+            "// Evaluation weights indexed by phase and piece type. Regenerated "
+            "by the tune\n"
+            "// tool, PIECE_PHASES is carried over unchanged.\n\n"
+            "namespace Evaluation {\n\n";
+    writeTable(file, "MATERIAL_VALUES", parameters, MATERIAL);
+    file << "\n// Bonus per square attacked by each piece type, read from the "
+            "cached attack\n// maps of the position\n";
+    writeTable(file, "MOBILITY_VALUES", parameters, MOBILITY);
+    file << "\n// Bishop synergy bonus for holding both bishops\n"
+            "constexpr int BISHOP_PAIR_VALUES[2] = {[Phase::OPENING] = "
+         << std::lround(parameters[BISHOP_PAIR]) << ",\n"
+         << "                                       [Phase::ENDGAME] = "
+         << std::lround(parameters[NUM_FEATURES + BISHOP_PAIR]) << "};\n\n";
+
+    file << "constexpr int PIECE_PHASES[6] = {";
+    for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+        file << (type == 0 ? "" : type % 2 ? ", " : ",\n                                 ")
+             << "[Piece::Type::" << PIECE_NAMES[type]
+             << "] = " << Evaluation::PIECE_PHASES[type];
+    }
+    file << "};\n\n} // namespace Evaluation\n";
+    return static_cast<bool>(file);
+}
+
+} // namespace AdiChess::Tuning
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "board.h"
+
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Texel tuning of the evaluation weights. The evaluation is linear in its
+// weights once the phase is known, so every position is reduced to a few
+// feature counts (white minus black) and the weights are fitted to game
+// results through the sigmoid of the evaluation.
+
+namespace AdiChess::Tuning {
+
+// Material, mobility per piece type and the bishop pair
+constexpr int NUM_FEATURES = 13;
+// Every feature has an opening and an endgame weight
+constexpr int NUM_PARAMETERS = 2 * NUM_FEATURES;
+
+using Parameters = std::array<double, NUM_PARAMETERS>;
+
+// Weights currently compiled into the evaluation
+Parameters currentParameters();
+
+// Positions as structure of arrays so the evaluation and gradient loops run
+// across positions
+struct Dataset {
+    void add(Board const &board, double result);
+    size_t size() const { return results.size(); }
+
+    std::array<std::vector<int16_t>, NUM_FEATURES> features;
+    // Endgame weight of the position, 0 in the opening and 1 in the endgame
+    std::vector<float> phases;
+    // 1 for a white win, 0.5 for a draw and 0 for a loss
+    std::vector<float> results;
+};
+
+// Loads scored PackedPosition records, labelled with their game results
+Dataset loadDataset(std::string const &path, size_t limit = SIZE_MAX);
+
+// Evaluation from white's point of view
+double evaluate(Dataset const &dataset, size_t index,
+                Parameters const &parameters);
+
+double loss(Dataset const &dataset, Parameters const &parameters, double k,
+            int threads);
+
+// Sigmoid scaling minimising the loss of the given parameters
+double fitScale(Dataset const &dataset, Parameters const &parameters,
+                int threads);
+
+struct Options {
+    int epochs = 100;
+    size_t batchSize = 1 << 16;
+    double learningRate = 1;
+    int threads = 1;
+};
+
+// Adam over mini-batches, report is called after every epoch with the loss
+Parameters tune(Dataset const &dataset, Parameters parameters, double k,
+                Options const &options,
+                std::function<void(int, double)> const &report = {});
+
+// Writes the parameters as a replacement for evaluationParameters.h
+bool writeHeader(std::string const &path, Parameters const &parameters);
+
+} // namespace AdiChess::Tuning
@@ -0,0 +1,148 @@
+#include "uci.h"
+#include "perft.h"
+
+#include <sstream>
+
+namespace AdiChess::UCI {
+
+namespace {
+
+// Milliseconds kept in hand for communication with the GUI
+constexpr int64_t MOVE_OVERHEAD = 50;
+
+const char *START_FEN =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+} // namespace
+
+std::optional<Move> parseMove(Board &board, std::string const &text) {
+    MoveGeneration::MoveGenerator moveGenerator(board);
+    for (auto const &move : moveGenerator) {
+        if (moveToString(move, board.getCurrentPlayer()) == text &&
+            board.legalMove(move)) {
+            return move;
+        }
+    }
+    return std::nullopt;
+}
+
+std::unique_ptr<Board> parsePosition(std::istream &arguments) {
+    std::string token;
+    std::string fen;
+    arguments >> token;
+    if (token == "startpos") {
+        fen = START_FEN;
+        arguments >> token;
+    } else if (token == "fen") {
+        while (arguments >> token && token != "moves") {
+            fen += (fen.empty() ? "" : " ") + token;
+        }
+    } else {
+        return nullptr;
+    }
+    if (!Board::validFen(fen)) {
+        return nullptr;
+    }
+
+    auto board = std::make_unique<Board>(fen);
+    if (board->inCheck(board->getOpponent())) {
+        return nullptr;
+    }
+    if (token == "moves") {
+        while (arguments >> token) {
+            auto move = parseMove(*board, token);
+            if (!move) {
+                return nullptr;
+            }
+            board->makeMove(*move);
+        }
+    }
+    return board;
+}
+
+SearchLimits parseGo(std::istream &arguments, Side side) {
+    SearchLimits limits;
+    std::string token;
+    int64_t clock[2] = {0, 0};
+    int64_t increment[2] = {0, 0};
+    int64_t movesToGo = 0;
+    while (arguments >> token) {
+        if (token == "depth") {
+            arguments >> limits.depth;
+        } else if (token == "nodes") {
+            arguments >> limits.nodes;
+        } else if (token == "movetime") {
+            arguments >> limits.time;
+        } else if (token == "mate") {
+            arguments >> limits.mate;
+        } else if (token == "ponder") {
+            limits.ponder = true;
+        } else if (token == "wtime") {
+            arguments >> clock[Side::W];
+        } else if (token == "btime") {
+            arguments >> clock[Side::B];
+        } else if (token == "winc") {
+            arguments >> increment[Side::W];
+        } else if (token == "binc") {
+            arguments >> increment[Side::B];
+        } else if (token == "movestogo") {
+            arguments >> movesToGo;
+        }
+    }
+
+    // A share of the remaining time, never so much the flag falls
+    if (!limits.time && clock[side] > 0) {
+        int64_t share = clock[side] / (movesToGo > 0 ? movesToGo : 30) +
+                        increment[side] * 3 / 4;
+        limits.time =
+            std::max<int64_t>(1, std::min(share, clock[side] - MOVE_OVERHEAD));
+    }
+    return limits;
+}
+
+std::string formatScore(int score) {
+    if (score > MATE_BOUND) {
+        return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+    }
+    if (score < -MATE_BOUND) {
+        return "mate -" + std::to_string((MATE_SCORE + score) / 2);
+    }
+    return "cp " + std::to_string(score);
+}
+
+std::string formatInfo(SearchInfo const &info, Side side) {
+    std::ostringstream line;
+    line << "info depth " << info.depth << " multipv " << info.multiPV
+         << " score " << formatScore(info.score)
+         << " nodes " << info.nodes << " nps "
+         << info.nodes * 1000 / std::max<int64_t>(info.time, 1) << " time "
+         << info.time << " pv";
+    for (auto const &move : info.principalVariation) {
+        line << " " << moveToString(move, side);
+        side = ~side;
+    }
+    return line.str();
+}
+
+std::string formatBestMove(Search &search, Side side) {
+    std::string line = "bestmove " + moveToString(search.getPrincipalMove(), side);
+    const Move ponder = search.getPonderMove();
+    if (ponder != NO_MOVE) {
+        line += " ponder " + moveToString(ponder, ~side);
+    }
+    return line;
+}
+
+std::string formatBestMove(std::vector<Move> const &principalVariation,
+                           Side side) {
+    if (principalVariation.empty()) {
+        return "bestmove 0000";
+    }
+    std::string line = "bestmove " + moveToString(principalVariation[0], side);
+    if (principalVariation.size() > 1) {
+        line += " ponder " + moveToString(principalVariation[1], ~side);
+    }
+    return line;
+}
+
+} // namespace AdiChess::UCI
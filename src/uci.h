@@ -0,0 +1,39 @@
+#pragma once
+
+#include "search.h"
+
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string>
+
+// Pieces of the UCI text protocol shared by the engine's command loops
+
+namespace AdiChess::UCI {
+
+// Legal move of the side to move in long algebraic notation, e.g. e2e4, e1g1
+// or e7e8q
+std::optional<Move> parseMove(Board &board, std::string const &text);
+
+// Arguments of a position command, "startpos" or "fen <fen>" optionally
+// followed by "moves <moves>". Null when the position or a move is invalid.
+std::unique_ptr<Board> parsePosition(std::istream &arguments);
+
+// Arguments of a go command: depth, nodes, movetime, mate, ponder and the clock
+// (wtime, btime, winc, binc and movestogo) of side, the side to move
+SearchLimits parseGo(std::istream &arguments, Side side);
+
+// "cp <centipawns>" or "mate <moves>", negative when being mated
+std::string formatScore(int score);
+
+// info line of a completed iteration, side is the side to move at the root
+std::string formatInfo(SearchInfo const &info, Side side);
+
+// bestmove line of a finished search, with the expected reply to ponder on
+// when the principal variation or the table after the best move has one
+std::string formatBestMove(Search &search, Side side);
+// bestmove line for a principal variation, 0000 when it is empty
+std::string formatBestMove(std::vector<Move> const &principalVariation,
+                           Side side);
+
+} // namespace AdiChess::UCI
@@ -0,0 +1,198 @@
+#include "uciEngine.h"
+#include "bench.h"
+#include "cpu.h"
+#include "uci.h"
+
+#include <sstream>
+
+namespace AdiChess::UCI {
+
+namespace {
+
+constexpr size_t DEFAULT_HASH_MEGABYTES = 16;
+
+} // namespace
+
+Engine::Engine(std::function<void(std::string const &)> output_)
+    : output{std::move(output_)}, board{std::make_unique<Board>()},
+      table{DEFAULT_HASH_MEGABYTES} {}
+
+Engine::~Engine() { stopSearch(); }
+
+bool Engine::command(std::string const &line) {
+    std::istringstream arguments(line);
+    std::string command;
+    if (!(arguments >> command)) {
+        return true;
+    }
+
+    if (command == "uci") {
+        send("id name AdiChess");
+        send("option name Hash type spin default " +
+             std::to_string(DEFAULT_HASH_MEGABYTES) + " min 1 max 65536");
+        send("option name MultiPV type spin default 1 min 1 max 256");
+        send("option name Ponder type check default false");
+        send("option name Searcher type combo default AlphaBeta var AlphaBeta "
+             "var MCTS");
+        send("option name Threads type spin default 1 min 1 max 256");
+        send("option name RolloutDepth type spin default 0 min 0 max 8");
+        send(std::string("info string CPU target ") +
+             Cpu::name(Cpu::target()));
+        send("uciok");
+    } else if (command == "isready") {
+        send("readyok");
+    } else if (command == "ucinewgame") {
+        stopSearch();
+        table.clear();
+        mateTable.clear();
+        board = std::make_unique<Board>();
+    } else if (command == "setoption") {
+        setOption(arguments);
+    } else if (command == "position") {
+        stopSearch();
+        if (auto position = parsePosition(arguments)) {
+            board = std::move(position);
+        } else {
+            send("info string error invalid position");
+        }
+    } else if (command == "go") {
+        go(arguments);
+    } else if (command == "stop") {
+        if (search) {
+            search->stop();
+        }
+        if (solver) {
+            solver->stop();
+        }
+        if (mcts) {
+            mcts->stop();
+        }
+    } else if (command == "ponderhit") {
+        if (search) {
+            search->ponderHit();
+        }
+        if (mcts) {
+            mcts->ponderHit();
+        }
+    } else if (command == "bench") {
+        stopSearch();
+        int depth = Bench::DEFAULT_DEPTH;
+        arguments >> depth;
+        std::ostringstream report;
+        Bench::run(depth, report);
+        std::istringstream lines(report.str());
+        for (std::string reportLine; std::getline(lines, reportLine);) {
+            send(reportLine);
+        }
+    } else if (command == "quit") {
+        stopSearch();
+        return false;
+    } else {
+        send("info string error unknown command " + command);
+    }
+    return true;
+}
+
+void Engine::wait() {
+    if (searchThread.joinable()) {
+        searchThread.join();
+    }
+}
+
+void Engine::send(std::string const &line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    output(line);
+}
+
+void Engine::go(std::istream &arguments) {
+    stopSearch();
+    const Side side = board->getCurrentPlayer();
+    SearchLimits limits = parseGo(arguments, side);
+    if (limits.mate > 0) {
+        solver = std::make_unique<Mate::Solver>(*board, mateTable);
+        searchThread = std::thread([this, limits, side] {
+            auto result = solver->solve(limits.mate, limits);
+            if (result.moves) {
+                // Reported as the iteration that would find the mate
+                send(formatInfo({2 * result.moves - 1,
+                                 MATE_SCORE - (2 * result.moves - 1),
+                                 result.nodes, result.time,
+                                 result.principalVariation},
+                                side));
+            } else {
+                send("info string no mate in " + std::to_string(limits.mate) +
+                     " nodes " + std::to_string(result.nodes));
+            }
+            send(formatBestMove(result.principalVariation, side));
+        });
+        return;
+    }
+    if (useMcts) {
+        mcts = std::make_unique<Mcts::Searcher>(*board, mctsOptions);
+        searchThread = std::thread([this, limits, side] {
+            mcts->search(limits, [&](SearchInfo const &info) {
+                send(formatInfo(info, side));
+            });
+            send(formatBestMove(mcts->getPrincipalVariation(), side));
+        });
+        return;
+    }
+    search = std::make_unique<Search>(*board);
+    search->setTranspositionTable(&table);
+    search->setMultiPV(multiPV);
+    searchThread = std::thread([this, limits, side] {
+        search->search(limits, [&](SearchInfo const &info) {
+            send(formatInfo(info, side));
+        });
+        send(formatBestMove(*search, side));
+    });
+}
+
+void Engine::setOption(std::istream &arguments) {
+    std::string token, name;
+    arguments >> token >> name >> token;
+    if (name == "Hash") {
+        size_t megabytes = 0;
+        if (arguments >> megabytes && megabytes > 0) {
+            stopSearch();
+            table.resize(megabytes);
+        }
+    } else if (name == "MultiPV") {
+        int lines = 0;
+        if (arguments >> lines && lines > 0) {
+            multiPV = lines;
+        }
+    } else if (name == "Searcher") {
+        std::string value;
+        if (arguments >> value && (value == "AlphaBeta" || value == "MCTS")) {
+            useMcts = value == "MCTS";
+        }
+    } else if (name == "Threads") {
+        int threads = 0;
+        if (arguments >> threads && threads > 0) {
+            mctsOptions.threads = threads;
+        }
+    } else if (name == "RolloutDepth") {
+        int depth = -1;
+        if (arguments >> depth && depth >= 0) {
+            mctsOptions.rolloutDepth = depth;
+        }
+    } else if (name != "Ponder") {
+        send("info string error unknown option " + name);
+    }
+}
+
+void Engine::stopSearch() {
+    if (search) {
+        search->stop();
+    }
+    if (solver) {
+        solver->stop();
+    }
+    if (mcts) {
+        mcts->stop();
+    }
+    wait();
+}
+
+} // namespace AdiChess::UCI
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "mateSearch.h"
+#include "mcts.h"
+#include "search.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// UCI front end. Commands are handled as they arrive, searches run on their
+// own thread so stop and ponderhit are seen while searching. Pondering is a
+// search started with "go ponder" on the position after the expected reply;
+// ponderhit turns it into the timed search of that position without
+// restarting it, and stop on a miss ends it so the next position can be
+// searched. "go mate <moves>" runs the proof-number mate search instead, and
+// the Searcher option swaps the alpha-beta search for Monte Carlo tree search.
+
+namespace AdiChess::UCI {
+
+class Engine {
+public:
+    // output is called once per line, never from two threads at once
+    explicit Engine(std::function<void(std::string const &)> output_);
+    ~Engine();
+
+    // Handles one line of input, false after quit
+    bool command(std::string const &line);
+    // Waits for the running search to send its bestmove
+    void wait();
+
+private:
+    void send(std::string const &line);
+    void go(std::istream &arguments);
+    void setOption(std::istream &arguments);
+    void stopSearch();
+
+    std::function<void(std::string const &)> output;
+    std::mutex outputMutex;
+    std::unique_ptr<Board> board;
+    TranspositionTable table;
+    int multiPV = 1;
+    std::unique_ptr<Search> search;
+    Mate::Table mateTable;
+    std::unique_ptr<Mate::Solver> solver;
+    bool useMcts = false;
+    Mcts::Options mctsOptions;
+    std::unique_ptr<Mcts::Searcher> mcts;
+    std::thread searchThread;
+};
+
+} // namespace AdiChess::UCI
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "piece.h"
+
+#include <cstdint>
+
+// Zobrist keys shared by every position representation, so a position hashes
+// to the same key whichever model reached it
+
+namespace AdiChess {
+
+struct ZobristKeys {
+    uint64_t pieces[Piece::Type::NUM_PIECES][Side::NUM_SIDES][64];
+    uint64_t castlingRights[16];
+    uint64_t enPassantFiles[8];
+    uint64_t side;
+};
+
+constexpr ZobristKeys generateZobristKeys() {
+    ZobristKeys keys{};
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    auto next = [&seed] {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
+    for (auto &types : keys.pieces)
+        for (auto &sides : types)
+            for (auto &key : sides)
+                key = next();
+    for (auto &key : keys.castlingRights)
+        key = next();
+    for (auto &key : keys.enPassantFiles)
+        key = next();
+    keys.side = next();
+    return keys;
+}
+
+inline constexpr ZobristKeys ZOBRIST = generateZobristKeys();
+
+} // namespace AdiChess
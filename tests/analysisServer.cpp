@@ -0,0 +1,215 @@
+#include "../src/analysisServer.h"
+#include "../src/uci.h"
+#include "gtest/gtest.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <thread>
+
+using namespace AdiChess;
+
+namespace {
+
+class Client {
+public:
+    explicit Client(int port) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        connected = connect(fd, reinterpret_cast<sockaddr *>(&address),
+                            sizeof(address)) == 0;
+    }
+
+    explicit Client(std::string const &path) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        connected = connect(fd, reinterpret_cast<sockaddr *>(&address),
+                            sizeof(address)) == 0;
+    }
+
+    ~Client() { close(fd); }
+
+    void send(std::string const &line) {
+        std::string data = line + "\n";
+        ASSERT_EQ(write(fd, data.data(), data.size()),
+                  static_cast<ssize_t>(data.size()));
+    }
+
+    // Empty once the server closes the connection
+    std::string readLine() {
+        size_t end;
+        while ((end = input.find('\n')) == std::string::npos) {
+            char buffer[4096];
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n <= 0) {
+                return "";
+            }
+            input.append(buffer, n);
+        }
+        std::string line = input.substr(0, end);
+        input.erase(0, end + 1);
+        return line;
+    }
+
+    // Lines up to and including the bestmove
+    std::vector<std::string> readSearch() {
+        std::vector<std::string> lines;
+        do {
+            lines.push_back(readLine());
+        } while (!lines.back().empty() && lines.back().rfind("bestmove", 0));
+        return lines;
+    }
+
+    bool connected = false;
+
+private:
+    int fd;
+    std::string input;
+};
+
+// Server running on a background thread for the duration of a test
+class RunningServer {
+public:
+    explicit RunningServer(AnalysisServer::Options const &options)
+        : server(options) {
+        listening = server.listen();
+        if (listening) {
+            thread = std::thread([this] { server.run(); });
+        }
+    }
+
+    ~RunningServer() {
+        server.shutdown();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    AnalysisServer server;
+    bool listening;
+
+private:
+    std::thread thread;
+};
+
+bool legalReply(std::string const &bestMove, std::string const &moves) {
+    std::istringstream arguments("startpos moves " + moves);
+    auto board = UCI::parsePosition(arguments);
+    return board &&
+           UCI::parseMove(*board, bestMove.substr(9, bestMove.find(' ', 9) - 9))
+               .has_value();
+}
+
+} // namespace
+
+TEST(AnalysisServer, ConcurrentSessions) {
+    AnalysisServer::Options options;
+    options.workers = 2;
+    options.hashMegabytes = 1;
+    RunningServer running(options);
+    ASSERT_TRUE(running.listening);
+
+    const char *openings[] = {"e2e4", "d2d4", "g1f3"};
+    std::vector<std::unique_ptr<Client>> clients;
+    for (auto opening : openings) {
+        clients.push_back(std::make_unique<Client>(running.server.port()));
+        ASSERT_TRUE(clients.back()->connected);
+        clients.back()->send(std::string("position startpos moves ") + opening);
+        clients.back()->send("go depth 3");
+    }
+    for (size_t i = 0; i < clients.size(); ++i) {
+        auto lines = clients[i]->readSearch();
+        ASSERT_EQ(lines.size(), 4u);
+        for (int depth = 1; depth <= 3; ++depth) {
+            ASSERT_EQ(lines[depth - 1].rfind("info depth " +
+                                                 std::to_string(depth) + " ",
+                                             0),
+                      0u);
+        }
+        ASSERT_TRUE(legalReply(lines.back(), openings[i]));
+    }
+}
+
+TEST(AnalysisServer, StopEndsUnlimitedSearch) {
+    RunningServer running(AnalysisServer::Options{});
+    ASSERT_TRUE(running.listening);
+    Client client(running.server.port());
+    client.send("position startpos");
+    client.send("go");
+    ASSERT_EQ(client.readLine().rfind("info depth 1 ", 0), 0u);
+    client.send("stop");
+    auto lines = client.readSearch();
+    ASSERT_EQ(lines.back().rfind("bestmove ", 0), 0u);
+    ASSERT_TRUE(legalReply(lines.back(), ""));
+
+    // The session takes further requests
+    client.send("isready");
+    ASSERT_EQ(client.readLine(), "readyok");
+}
+
+TEST(AnalysisServer, NodeBudget) {
+    AnalysisServer::Options options;
+    options.maxNodes = 20000;
+    RunningServer running(options);
+    ASSERT_TRUE(running.listening);
+    Client client(running.server.port());
+    client.send("go depth 60");
+    auto lines = client.readSearch();
+    ASSERT_EQ(lines.back().rfind("bestmove ", 0), 0u);
+    for (size_t i = 0; i + 1 < lines.size(); ++i) {
+        std::istringstream info(lines[i]);
+        std::string token;
+        uint64_t nodes = 0;
+        while (info >> token) {
+            if (token == "nodes") {
+                info >> nodes;
+            }
+        }
+        // The budget is checked every 1024 nodes
+        ASSERT_LT(nodes, options.maxNodes + 1024);
+    }
+}
+
+TEST(AnalysisServer, UnixSocket) {
+    AnalysisServer::Options options;
+    options.socketPath = testing::TempDir() + "analysis_server_test.sock";
+    RunningServer running(options);
+    ASSERT_TRUE(running.listening);
+    Client client(options.socketPath);
+    ASSERT_TRUE(client.connected);
+    client.send("isready");
+    ASSERT_EQ(client.readLine(), "readyok");
+
+    client.send("position fen not a fen");
+    ASSERT_EQ(client.readLine(), "info string error invalid position");
+
+    // Mate in one
+    client.send("position fen 6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    client.send("go depth 2");
+    auto lines = client.readSearch();
+    ASSERT_NE(lines[lines.size() - 2].find(" score mate 1 "),
+              std::string::npos);
+    ASSERT_EQ(lines.back(), "bestmove a1a8");
+
+    client.send("quit");
+    ASSERT_EQ(client.readLine(), "");
+}
+
+TEST(AnalysisServer, MultiPV) {
+    RunningServer running(AnalysisServer::Options{});
+    ASSERT_TRUE(running.listening);
+    Client client(running.server.port());
+    client.send("setoption name MultiPV value 3");
+    client.send("go depth 2");
+    auto lines = client.readSearch();
+    ASSERT_EQ(lines.size(), 7u);
+    ASSERT_NE(lines[5].find(" multipv 3 "), std::string::npos);
+}
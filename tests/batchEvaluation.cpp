@@ -0,0 +1,47 @@
+#include "../src/batchEvaluation.h"
+#include "../src/evaluation.h"
+#include "../src/moveGenerator.h"
+#include "gtest/gtest.h"
+
+#include <random>
+
+using namespace AdiChess;
+
+TEST(BatchEvaluation, MatchesEvaluate) {
+    // Positions along random games from a few starting points
+    const char *fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"};
+    std::mt19937_64 random(1);
+    Evaluation::PositionBatch batch;
+    std::vector<int> expected;
+
+    for (auto fen : fens) {
+        Board board(fen);
+        for (int ply = 0; ply < 80; ++ply) {
+            batch.add(board);
+            expected.push_back(Evaluation::evaluate(board));
+
+            std::vector<Move> moves;
+            MoveGeneration::MoveGenerator moveGenerator(board);
+            for (auto const &move : moveGenerator) {
+                if (board.legalMove(move)) {
+                    moves.push_back(move);
+                }
+            }
+            if (moves.empty()) {
+                break;
+            }
+            board.makeMove(moves[random() % moves.size()]);
+        }
+    }
+
+    ASSERT_GT(batch.size(), 64);
+    ASSERT_EQ(Evaluation::evaluate(batch), expected);
+
+    batch.clear();
+    ASSERT_EQ(batch.size(), 0);
+    ASSERT_TRUE(Evaluation::evaluate(batch).empty());
+}
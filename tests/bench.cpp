@@ -0,0 +1,19 @@
+#include "../src/bench.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+using namespace AdiChess;
+
+TEST(Bench, NodeSignatureIsDeterministic) {
+    std::ostringstream first;
+    std::ostringstream second;
+    auto result = Bench::run(3, first);
+    ASSERT_GT(result.nodes, 0u);
+    ASSERT_EQ(Bench::run(3, second).nodes, result.nodes);
+    // Per position lines match too, not only the total
+    auto lines = [](std::string const &output) {
+        return output.substr(0, output.find("Time"));
+    };
+    ASSERT_EQ(lines(first.str()), lines(second.str()));
+}
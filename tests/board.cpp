@@ -0,0 +1,234 @@
+#include "../src/board.h"
+#include "../src/moveGenerator.h"
+#include "../src/slidingAttacks.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+using namespace AdiChess;
+
+TEST(AttackInfo, StartPositionHasNoChecksOrPins) {
+    Board board;
+    auto const &attacks = board.getAttackInfo();
+    ASSERT_EQ(attacks.checkers, 0);
+    ASSERT_EQ(attacks.pinned, 0);
+    ASSERT_EQ(attacks.attacked[Side::W] & MoveGeneration::rank3,
+              MoveGeneration::rank3);
+    ASSERT_FALSE(board.inCheck(Side::W));
+    ASSERT_FALSE(board.inCheck(Side::B));
+}
+
+TEST(AttackInfo, Checkers) {
+    // Black queen on e7 checks the white king on e1
+    Board board("4k3/4q3/8/8/8/8/8/4K3 w - - 0 1");
+    auto const &attacks = board.getAttackInfo();
+    ASSERT_EQ(attacks.checkers, 1ULL << MoveGeneration::e7);
+    ASSERT_TRUE(board.inCheck(Side::W));
+    ASSERT_FALSE(board.inCheck(Side::B));
+    // King may not retreat along the checking ray
+    ASSERT_TRUE(attacks.attacked[Side::B] & (1ULL << MoveGeneration::e1));
+}
+
+TEST(AttackInfo, Pinned) {
+    // White knight on e2 is pinned by the rook on e8, bishop on d2 by the
+    // bishop on a5
+    Board board("4r1k1/8/8/b7/8/8/3BN3/4K3 w - - 0 1");
+    auto const &attacks = board.getAttackInfo();
+    ASSERT_EQ(attacks.pinned,
+              (1ULL << MoveGeneration::e2) | (1ULL << MoveGeneration::d2));
+    ASSERT_EQ(attacks.checkers, 0);
+}
+
+TEST(AttackInfo, RestoredOnUnmake) {
+    Board board;
+    board.getAttackInfo();
+    Move move(MoveGeneration::e2, MoveGeneration::e4, Move::DOUBLE_PAWN_PUSH);
+    board.makeMove(move);
+    ASSERT_FALSE(board.inCheck(Side::B));
+    board.unmakeMove(move);
+    ASSERT_TRUE(board.getAttackInfo().valid);
+}
+
+namespace {
+
+// Compares check detection and the capture and check generators against
+// making every move, over the whole tree to the depth
+void compareChecks(Board &board, int depth, int &checks) {
+    std::vector<uint64_t> expectedCaptures, expectedChecks, captures, quiet;
+    MoveGeneration::MoveGenerator moveGen(board);
+    for (auto const &move : moveGen) {
+        if (!board.legalMove(move)) {
+            continue;
+        }
+        const bool givesCheck = board.givesCheck(move);
+        board.makeMove(move);
+        ASSERT_EQ(givesCheck, board.inCheck(board.getCurrentPlayer()))
+            << board;
+        if (depth > 1) {
+            compareChecks(board, depth - 1, checks);
+        }
+        board.unmakeMove(move);
+        if (move.isCapture() || move.isPromotion()) {
+            expectedCaptures.push_back(move.raw());
+        } else if (givesCheck) {
+            expectedChecks.push_back(move.raw());
+            ++checks;
+        }
+    }
+    for (auto type : {MoveGeneration::GenType::CAPTURES,
+                      MoveGeneration::GenType::CHECKS}) {
+        MoveGeneration::MoveGenerator generated(board, type);
+        auto &keys = type == MoveGeneration::GenType::CHECKS ? quiet : captures;
+        for (auto const &move : generated) {
+            if (board.legalMove(move)) {
+                keys.push_back(move.raw());
+            }
+        }
+    }
+    for (auto *keys :
+         {&expectedCaptures, &expectedChecks, &captures, &quiet}) {
+        std::sort(keys->begin(), keys->end());
+    }
+    ASSERT_EQ(captures, expectedCaptures);
+    ASSERT_EQ(quiet, expectedChecks);
+}
+
+} // namespace
+
+TEST(CheckInfo, GeneratorsAndGivesCheckMatchMakingMoves) {
+    // Kiwipete, en passant discoveries, promotions, and castling into check
+    const char *fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "5k2/8/8/8/8/8/8/4K2R w K - 0 1",
+        "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1",
+    };
+    for (auto fen : fens) {
+        Board board(fen);
+        int checks = 0;
+        compareChecks(board, 3, checks);
+        ASSERT_GT(checks, 0) << fen;
+    }
+}
+
+TEST(CheckInfo, DiscoveredCheckCandidates) {
+    // The knight on e4 blocks the rook on e1 from the king on e8, the bishop
+    // on a3 has no slider behind it
+    Board board("4k3/8/8/8/4N3/B7/8/4RK2 w - - 0 1");
+    auto const &checks = board.getCheckInfo();
+    ASSERT_EQ(checks.discoverers, 1ULL << MoveGeneration::e4);
+    ASSERT_EQ(checks.kingPosition, static_cast<uint64_t>(MoveGeneration::e8));
+    // Every knight move uncovers the rook
+    MoveGeneration::MoveGenerator generated(board,
+                                            MoveGeneration::GenType::CHECKS);
+    int knightMoves = 0;
+    for (auto const &move : generated) {
+        knightMoves += move.getFrom() == MoveGeneration::e4;
+    }
+    ASSERT_EQ(knightMoves, 8);
+}
+
+TEST(SlidingAttacks, MatchesPerPieceAttackMaps) {
+    Board board(
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    uint64_t occupied =
+        board.getPositions(Side::W) | board.getPositions(Side::B);
+    for (Side side : {Side::W, Side::B}) {
+        uint64_t rookLike = 0;
+        uint64_t bishopLike = 0;
+        uint64_t rooks = board.getPositions(Piece::Type::R, side) |
+                         board.getPositions(Piece::Type::Q, side);
+        uint64_t bishops = board.getPositions(Piece::Type::B, side) |
+                           board.getPositions(Piece::Type::Q, side);
+        auto attacks =
+            MoveGeneration::getSlidingAttacks(rooks, bishops, ~occupied);
+        while (rooks) {
+            rookLike |= board.getAttackMap(Utility::bitScanPop(rooks),
+                                           Piece::Type::R, 0, occupied, side);
+        }
+        while (bishops) {
+            bishopLike |= board.getAttackMap(
+                Utility::bitScanPop(bishops), Piece::Type::B, 0, occupied, side);
+        }
+        ASSERT_EQ(attacks.rookLike, rookLike);
+        ASSERT_EQ(attacks.bishopLike, bishopLike);
+    }
+}
+
+TEST(PositionKey, TranspositionsAndUnmake) {
+    Board board;
+    const uint64_t startKey = board.getKey();
+    Move e2e4(MoveGeneration::e2, MoveGeneration::e4, Move::DOUBLE_PAWN_PUSH);
+    board.makeMove(e2e4);
+    ASSERT_NE(board.getKey(), startKey);
+    Board parsed("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1");
+    ASSERT_EQ(board.getKey(), parsed.getKey());
+    board.unmakeMove(e2e4);
+    ASSERT_EQ(board.getKey(), startKey);
+}
+
+TEST(PositionKey, Repetition) {
+    Board board;
+    const Move moves[] = {
+        Move(MoveGeneration::g1, MoveGeneration::f3, Move::QUIET_MOVE),
+        Move(MoveGeneration::g8, MoveGeneration::f6, Move::QUIET_MOVE),
+        Move(MoveGeneration::f3, MoveGeneration::g1, Move::QUIET_MOVE),
+        Move(MoveGeneration::f6, MoveGeneration::g8, Move::QUIET_MOVE)};
+
+    ASSERT_FALSE(board.hasUpcomingRepetition());
+    for (int i = 0; i < 3; ++i) {
+        board.makeMove(moves[i]);
+        ASSERT_FALSE(board.isRepetition());
+    }
+    // Black can return the knight to reach the start position again
+    ASSERT_TRUE(board.hasUpcomingRepetition());
+    board.makeMove(moves[3]);
+    ASSERT_TRUE(board.isRepetition());
+    ASSERT_EQ(board.getKey(), Board().getKey());
+
+    board.unmakeMove(moves[3]);
+    ASSERT_FALSE(board.isRepetition());
+}
+
+TEST(PositionKey, UpcomingRepetitionNeedsClearPath) {
+    // The knight steps aside for the rook and returns, the rook can only go
+    // back to a1 when the knight is not in its way
+    const Move moves[][3] = {
+        {Move(MoveGeneration::a4, MoveGeneration::b6, Move::QUIET_MOVE),
+         Move(MoveGeneration::a1, MoveGeneration::a7, Move::QUIET_MOVE),
+         Move(MoveGeneration::b6, MoveGeneration::a4, Move::QUIET_MOVE)},
+        {Move(MoveGeneration::b4, MoveGeneration::d5, Move::QUIET_MOVE),
+         Move(MoveGeneration::a1, MoveGeneration::a7, Move::QUIET_MOVE),
+         Move(MoveGeneration::d5, MoveGeneration::b4, Move::QUIET_MOVE)}};
+
+    Board blocked("7k/8/8/8/n7/8/8/R3K3 b - - 0 1");
+    Board clear("7k/8/8/8/1n6/8/8/R3K3 b - - 0 1");
+    for (auto const &move : moves[0]) {
+        blocked.makeMove(move);
+    }
+    for (auto const &move : moves[1]) {
+        clear.makeMove(move);
+    }
+    ASSERT_FALSE(blocked.hasUpcomingRepetition());
+    ASSERT_TRUE(clear.hasUpcomingRepetition());
+}
+
+TEST(PositionKey, FiftyMoves) {
+    ASSERT_FALSE(Board("4k3/8/8/8/8/8/8/4K2R w - - 99 80").fiftyMoves());
+    ASSERT_TRUE(Board("4k3/8/8/8/8/8/8/4K2R w - - 100 80").fiftyMoves());
+}
+
+TEST(PositionKey, CastlingCountsOnePly) {
+    Board board("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 10 30");
+    board.makeMove(Move(0, 0, Move::KING_CASTLE));
+    ASSERT_EQ(board.getHalfMoveClock(), 11);
+    board.makeMove(Move(0, 0, Move::QUEEN_CASTLE));
+    ASSERT_EQ(board.getHalfMoveClock(), 12);
+    board.unmakeMove(Move(0, 0, Move::QUEEN_CASTLE));
+    board.unmakeMove(Move(0, 0, Move::KING_CASTLE));
+    ASSERT_EQ(board.getHalfMoveClock(), 10);
+    ASSERT_EQ(board.getKey(),
+              Board("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 10 30").getKey());
+}
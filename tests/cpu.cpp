@@ -0,0 +1,78 @@
+#include "../src/batchEvaluation.h"
+#include "../src/cpu.h"
+#include "../src/slidingAttacks.h"
+#include "gtest/gtest.h"
+
+#include <random>
+
+using namespace AdiChess;
+
+namespace {
+
+const char *POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "2r3k1/5pp1/p3p2p/1p1rP3/3P4/P4P2/1P3KPP/2R1R3 b - - 0 27",
+};
+
+// Restores the startup target when a test ends
+struct TargetGuard {
+    Cpu::Target saved = Cpu::target();
+    ~TargetGuard() { Cpu::select(saved); }
+};
+
+} // namespace
+
+TEST(Cpu, SelectionIsCappedByTheCpu) {
+    TargetGuard guard;
+    EXPECT_LE(Cpu::target(), Cpu::detect());
+    EXPECT_EQ(Cpu::select(Cpu::AVX2), Cpu::detect());
+    EXPECT_EQ(Cpu::select(Cpu::BASELINE), Cpu::BASELINE);
+    EXPECT_STREQ(Cpu::name(Cpu::BMI2), "bmi2");
+}
+
+// Every variant the CPU runs gives the baseline's results
+TEST(Cpu, VariantsAgree) {
+    TargetGuard guard;
+    std::mt19937_64 random(3);
+    std::vector<uint64_t> masks(64);
+    for (auto &mask : masks) {
+        mask = random() & random();
+    }
+
+    std::vector<int> scores;
+    std::vector<MoveGeneration::SlidingAttacks> attacks;
+    Evaluation::PositionBatch batch;
+    for (auto fen : POSITIONS) {
+        Board board(fen);
+        batch.add(board);
+    }
+
+    for (int target = Cpu::BASELINE; target <= Cpu::detect(); ++target) {
+        Cpu::select(static_cast<Cpu::Target>(target));
+        std::vector<int> targetScores;
+        for (auto fen : POSITIONS) {
+            Board board(fen);
+            targetScores.push_back(Evaluation::evaluate(board));
+        }
+        ASSERT_EQ(Evaluation::evaluate(batch), targetScores);
+
+        std::vector<MoveGeneration::SlidingAttacks> targetAttacks;
+        for (size_t i = 0; i + 1 < masks.size(); ++i) {
+            targetAttacks.push_back(MoveGeneration::getSlidingAttacks(
+                masks[i], masks[i + 1], ~(masks[i] | masks[i + 1])));
+        }
+
+        if (target == Cpu::BASELINE) {
+            scores = targetScores;
+            attacks = targetAttacks;
+            continue;
+        }
+        EXPECT_EQ(targetScores, scores) << Cpu::name(Cpu::target());
+        for (size_t i = 0; i < attacks.size(); ++i) {
+            EXPECT_EQ(targetAttacks[i].rookLike, attacks[i].rookLike);
+            EXPECT_EQ(targetAttacks[i].bishopLike, attacks[i].bishopLike);
+        }
+    }
+}
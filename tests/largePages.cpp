@@ -0,0 +1,107 @@
+#include "../src/board.h"
+#include "../src/largePages.h"
+#include "../src/moveGenerator.h"
+#include "../src/search.h"
+#include "../src/transpositionTable.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdint>
+
+using namespace AdiChess;
+
+namespace {
+
+class KeyRecorder : public Memory::Prefetcher {
+public:
+    void prefetch(uint64_t key) const override { keys.push_back(key); }
+    mutable std::vector<uint64_t> keys;
+};
+
+} // namespace
+
+TEST(LargePages, SmallArraysAreCacheLineAlignedAndZeroed) {
+    auto values = Memory::makeLargeArray<uint64_t>(100);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(values.get()) %
+                  Memory::CACHE_LINE_SIZE,
+              0u);
+    ASSERT_FALSE(values.get_deleter().isMapped());
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(values[i], 0u);
+    }
+}
+
+TEST(LargePages, ElementsWithInitialisersAreConstructed) {
+    struct Marked {
+        int value = 7;
+    };
+    auto values = Memory::makeLargeArray<Marked>(100);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(values[i].value, 7);
+    }
+}
+
+TEST(LargePages, LargeArraysAreHugePageAligned) {
+    const size_t count = 3 * Memory::HUGE_PAGE_SIZE / sizeof(uint64_t) + 5;
+    auto values = Memory::makeLargeArray<std::atomic<uint64_t>>(count);
+    ASSERT_NE(values.get(), nullptr);
+#ifdef __linux__
+    ASSERT_TRUE(values.get_deleter().isMapped());
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(values.get()) %
+                  Memory::HUGE_PAGE_SIZE,
+              0u);
+#endif
+    ASSERT_EQ(values[count - 1].load(), 0u);
+    values[0] = 1;
+    values[count - 1] = 2;
+    ASSERT_EQ(values[0] + values[count - 1], 3u);
+}
+
+TEST(LargePages, MakeMovePrefetchesReachedPositions) {
+    Board board;
+    KeyRecorder recorder;
+    board.setPrefetcher(&recorder);
+    board.makeMove(Move(MoveGeneration::e2, MoveGeneration::e4,
+                        Move::DOUBLE_PAWN_PUSH));
+    board.makeMove(Move(MoveGeneration::e7, MoveGeneration::e5,
+                        Move::DOUBLE_PAWN_PUSH));
+    ASSERT_EQ(recorder.keys.size(), 2u);
+    ASSERT_EQ(recorder.keys.back(), board.getKey());
+
+    board.setPrefetcher(nullptr);
+    board.makeMove(Move(MoveGeneration::g1, MoveGeneration::f3,
+                        Move::QUIET_MOVE));
+    ASSERT_EQ(recorder.keys.size(), 2u);
+}
+
+TEST(LargePages, SearchRestoresPrefetcher) {
+    Board board;
+    KeyRecorder recorder;
+    board.setPrefetcher(&recorder);
+    TranspositionTable table(1);
+    Search search(board);
+    search.setTranspositionTable(&table);
+    SearchLimits limits;
+    limits.depth = 3;
+    search.search(limits);
+    ASSERT_EQ(board.getPrefetcher(), &recorder);
+    search.negamax(3);
+    ASSERT_EQ(board.getPrefetcher(), &recorder);
+    // The search's own moves went to the table
+    ASSERT_TRUE(recorder.keys.empty());
+}
+
+TEST(LargePages, TranspositionTableSurvivesResize) {
+    TranspositionTable table(4);
+    const Move move(MoveGeneration::e2, MoveGeneration::e4,
+                    Move::DOUBLE_PAWN_PUSH);
+    table.prefetch(12345);
+    table.store(12345, 3, 10, TranspositionTable::EXACT, move);
+    TranspositionTable::Entry entry;
+    ASSERT_TRUE(table.probe(12345, entry));
+    table.resize(1);
+    ASSERT_FALSE(table.probe(12345, entry));
+    table.store(12345, 3, 10, TranspositionTable::EXACT, move);
+    ASSERT_TRUE(table.probe(12345, entry));
+    ASSERT_EQ(entry.move, move);
+}
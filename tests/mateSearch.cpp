@@ -0,0 +1,82 @@
+#include "../src/mateSearch.h"
+#include "../src/perft.h"
+#include "gtest/gtest.h"
+
+using namespace AdiChess;
+
+namespace {
+
+// Plays the line and checks it ends in checkmate
+bool endsInMate(Board &board, std::vector<Move> const &line) {
+    for (auto const &move : line) {
+        if (!board.legalMove(move)) {
+            return false;
+        }
+        board.makeMove(move);
+    }
+    MoveGeneration::MoveGenerator moveGen(board);
+    for (auto const &move : moveGen) {
+        if (board.legalMove(move)) {
+            return false;
+        }
+    }
+    return board.inCheck(board.getCurrentPlayer());
+}
+
+} // namespace
+
+TEST(MateSearch, FindsShortestCheckingMate) {
+    struct {
+        const char *fen;
+        int moves;
+        const char *first;
+    } puzzles[] = {
+        {"6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1", 1, "d1d8"},
+        {"r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 1",
+         2, "d5f6"},
+        {"r1b3kr/ppp1Bp1p/1b6/n2P4/2p3q1/2Q2N2/P4PPP/RN2R1K1 w - - 1 1", 3,
+         "c3h8"},
+        {"5r1k/6pp/8/4N3/2Q5/8/8/6K1 w - - 0 1", 4, "e5f7"},
+        {"2r3k1/p4p2/3Rp2p/1p2P1pK/8/1P4P1/P3Q2P/1q6 b - - 0 1", 3, "b1g6"},
+    };
+    for (auto const &puzzle : puzzles) {
+        Board board(puzzle.fen);
+        const Side side = board.getCurrentPlayer();
+        Mate::Table table(1);
+        Mate::Solver solver(board, table);
+        auto result = solver.solve(6);
+        ASSERT_EQ(result.moves, puzzle.moves) << puzzle.fen;
+        ASSERT_EQ(result.principalVariation.size(), 2u * puzzle.moves - 1);
+        ASSERT_EQ(moveToString(result.principalVariation[0], side),
+                  puzzle.first);
+        ASSERT_TRUE(endsInMate(board, result.principalVariation));
+    }
+}
+
+TEST(MateSearch, NoMateWithinTheMoves) {
+    // A mate in four is not found in three
+    Board board("5r1k/6pp/8/4N3/2Q5/8/8/6K1 w - - 0 1");
+    Mate::Table table(1);
+    Mate::Solver solver(board, table);
+    auto result = solver.solve(3);
+    ASSERT_EQ(result.moves, 0);
+    ASSERT_TRUE(result.principalVariation.empty());
+    // The board is left as it was
+    ASSERT_EQ(board.getKey(), Board("5r1k/6pp/8/4N3/2Q5/8/8/6K1 w - - 0 1").getKey());
+
+    // Stalemate is no mate
+    Board stalemate("7k/8/6Q1/8/8/8/8/6K1 w - - 0 1");
+    Mate::Solver stalemateSolver(stalemate, table);
+    ASSERT_EQ(stalemateSolver.solve(1).moves, 0);
+}
+
+TEST(MateSearch, StopsAtNodeLimit) {
+    Board board("6k1/8/8/8/8/8/8/QR4K1 w - - 0 1");
+    Mate::Table table(1);
+    Mate::Solver solver(board, table);
+    SearchLimits limits;
+    limits.nodes = 2048;
+    auto result = solver.solve(8, limits);
+    ASSERT_EQ(result.moves, 0);
+    ASSERT_LE(result.nodes, 2048u + 1);
+}
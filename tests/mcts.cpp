@@ -0,0 +1,78 @@
+#include "../src/mcts.h"
+#include "../src/perft.h"
+#include "gtest/gtest.h"
+
+using namespace AdiChess;
+
+TEST(Mcts, FindsMateInOne) {
+    Board board("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1");
+    Mcts::Searcher searcher(board);
+    SearchLimits limits;
+    limits.nodes = 2000;
+    const int score = searcher.search(limits);
+    ASSERT_EQ(moveToString(searcher.getPrincipalMove(), Side::W), "d1d8");
+    ASSERT_GT(score, 500);
+}
+
+TEST(Mcts, TakesHangingQueen) {
+    Board board("4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1");
+    Mcts::Searcher searcher(board);
+    SearchLimits limits;
+    limits.nodes = 5000;
+    searcher.search(limits);
+    ASSERT_EQ(moveToString(searcher.getPrincipalMove(), Side::W), "d2d5");
+}
+
+TEST(Mcts, StopsAtPlayoutLimitAndRestoresBoard) {
+    Board board;
+    const uint64_t key = board.getKey();
+    Mcts::Searcher searcher(board);
+    SearchLimits limits;
+    limits.nodes = 1000;
+    std::vector<SearchInfo> reports;
+    searcher.search(limits,
+                    [&](SearchInfo const &info) { reports.push_back(info); });
+    ASSERT_EQ(searcher.getNodes(), 1000u);
+    ASSERT_EQ(board.getKey(), key);
+    ASSERT_FALSE(reports.empty());
+    ASSERT_EQ(reports.back().nodes, 1000u);
+    ASSERT_FALSE(reports.back().principalVariation.empty());
+    ASSERT_EQ(reports.back().principalVariation.front(),
+              searcher.getPrincipalMove());
+}
+
+TEST(Mcts, SharesTreeBetweenThreads) {
+    Board board("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1");
+    Mcts::Options options;
+    options.threads = 4;
+    options.rolloutDepth = 1;
+    Mcts::Searcher searcher(board, options);
+    SearchLimits limits;
+    limits.nodes = 4000;
+    searcher.search(limits);
+    // Threads finish the playouts they started before the limit
+    ASSERT_GE(searcher.getNodes(), 4000u);
+    ASSERT_LE(searcher.getNodes(), 4000u + options.threads);
+    ASSERT_EQ(moveToString(searcher.getPrincipalMove(), Side::W), "d1d8");
+}
+
+TEST(Mcts, FullPoolKeepsSearching) {
+    Board board;
+    Mcts::Options options;
+    options.poolSize = 100;
+    Mcts::Searcher searcher(board, options);
+    SearchLimits limits;
+    limits.nodes = 3000;
+    searcher.search(limits);
+    ASSERT_EQ(searcher.getNodes(), 3000u);
+    ASSERT_FALSE(searcher.getPrincipalVariation().empty());
+}
+
+TEST(Mcts, NoMovesGivesEmptyLine) {
+    Board board("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+    Mcts::Searcher searcher(board);
+    SearchLimits limits;
+    limits.nodes = 10;
+    searcher.search(limits);
+    ASSERT_TRUE(searcher.getPrincipalVariation().empty());
+}
@@ -0,0 +1,114 @@
+#include "../src/openingExplorer.h"
+#include "../src/perft.h"
+#include "gtest/gtest.h"
+
+#include <fstream>
+
+using namespace AdiChess;
+
+TEST(OpeningExplorer, BuildAndLookup) {
+    std::string pgnPath = testing::TempDir() + "explorer_test.pgn";
+    std::string indexPath = testing::TempDir() + "explorer_test.aox";
+    {
+        std::ofstream pgn(pgnPath);
+        const char *games[][2] = {{"1. e4 e5 2. Nf3 Nc6", "1-0"},
+                                  {"1. e4 c5 2. Nf3 d6", "0-1"},
+                                  {"1. d4 d5 2. c4", "1/2-1/2"},
+                                  {"1. e4 e5 2. Bc4", "1/2-1/2"},
+                                  {"1. Nf3 d5 2. g3", "*"}};
+        for (auto const &game : games) {
+            pgn << "[Event \"Test\"]\n[Result \"" << game[1] << "\"]\n\n"
+                << game[0] << " " << game[1] << "\n\n";
+        }
+    }
+
+    for (int threads : {1, 3}) {
+        Explorer::BuildOptions options;
+        options.threads = threads;
+        auto stats = Explorer::build(pgnPath, indexPath, options);
+        ASSERT_EQ(stats.games, 4u);
+        ASSERT_EQ(stats.skipped, 1u);
+
+        Explorer::Index index(indexPath);
+        ASSERT_TRUE(index.isOpen());
+        ASSERT_EQ(index.size(), stats.entries);
+
+        Board board;
+        auto moves = index.lookup(board);
+        ASSERT_EQ(moves.size(), 2u);
+        ASSERT_EQ(moveToString(moves[0].move, Side::W), "e2e4");
+        ASSERT_EQ(moves[0].games(), 3u);
+        ASSERT_EQ(moves[0].whiteWins, 1u);
+        ASSERT_EQ(moves[0].draws, 1u);
+        ASSERT_EQ(moves[0].blackWins, 1u);
+        ASSERT_DOUBLE_EQ(moves[1].score(Side::W), 0.5);
+
+        // Transposed or unseen positions
+        board.makeMove(Move(MoveGeneration::e2, MoveGeneration::e4,
+                            Move::DOUBLE_PAWN_PUSH));
+        moves = index.lookup(board);
+        ASSERT_EQ(moves.size(), 2u);
+        ASSERT_EQ(moves[0].games(), 2u);
+        ASSERT_DOUBLE_EQ(moves[0].score(Side::B), 0.25);
+        board.makeMove(Move(MoveGeneration::a7, MoveGeneration::a6,
+                            Move::QUIET_MOVE));
+        ASSERT_TRUE(index.lookup(board).empty());
+    }
+    std::remove(pgnPath.c_str());
+    std::remove(indexPath.c_str());
+}
+
+TEST(OpeningExplorer, SkipsGamesWithInvalidFen) {
+    std::string pgnPath = testing::TempDir() + "explorer_fen_test.pgn";
+    std::string indexPath = testing::TempDir() + "explorer_fen_test.aox";
+    {
+        std::ofstream pgn(pgnPath);
+        // The second placement has no kings and only three ranks
+        const char *fens[] = {"4k3/8/8/8/8/8/4P3/4K3 w - - 0 1",
+                              "8/8/8 w - - 0 1"};
+        for (auto const *fen : fens) {
+            pgn << "[Event \"Test\"]\n[Result \"1-0\"]\n[FEN \"" << fen
+                << "\"]\n\n1. e4 Kd7 1-0\n\n";
+        }
+    }
+
+    auto stats = Explorer::build(pgnPath, indexPath, {});
+    ASSERT_EQ(stats.games, 1u);
+    ASSERT_EQ(stats.skipped, 1u);
+    ASSERT_EQ(stats.entries, 2u);
+
+    Explorer::Index index(indexPath);
+    Board board("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1");
+    auto moves = index.lookup(board);
+    ASSERT_EQ(moves.size(), 1u);
+    ASSERT_EQ(moveToString(moves[0].move, Side::W), "e2e4");
+    std::remove(pgnPath.c_str());
+    std::remove(indexPath.c_str());
+}
+
+TEST(OpeningExplorer, DropsGamesWithABadMove) {
+    std::string pgnPath = testing::TempDir() + "explorer_move_test.pgn";
+    std::string indexPath = testing::TempDir() + "explorer_move_test.aox";
+    {
+        std::ofstream pgn(pgnPath);
+        // The queen cannot reach h8 on the second move
+        const char *games[] = {"1. e4 e5 2. Qh8", "1. d4 d5"};
+        for (auto const *game : games) {
+            pgn << "[Event \"Test\"]\n[Result \"1-0\"]\n\n"
+                << game << " 1-0\n\n";
+        }
+    }
+
+    auto stats = Explorer::build(pgnPath, indexPath, {});
+    ASSERT_EQ(stats.games, 1u);
+    ASSERT_EQ(stats.skipped, 1u);
+    ASSERT_EQ(stats.entries, 2u);
+
+    Explorer::Index index(indexPath);
+    Board board;
+    auto moves = index.lookup(board);
+    ASSERT_EQ(moves.size(), 1u);
+    ASSERT_EQ(moveToString(moves[0].move, Side::W), "d2d4");
+    std::remove(pgnPath.c_str());
+    std::remove(indexPath.c_str());
+}
@@ -0,0 +1,121 @@
+#include "../src/moveGenerator.h"
+#include "../src/packedPosition.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+
+using namespace AdiChess;
+
+namespace {
+
+void expectSamePosition(Board const &lhs, Board const &rhs) {
+    for (int type = 0; type < Piece::Type::NUM_PIECES; ++type) {
+        for (Side side : {Side::W, Side::B}) {
+            ASSERT_EQ(lhs.getPositions(static_cast<Piece::Type>(type), side),
+                      rhs.getPositions(static_cast<Piece::Type>(type), side));
+        }
+    }
+    ASSERT_EQ(lhs.getCurrentPlayer(), rhs.getCurrentPlayer());
+    ASSERT_EQ(lhs.getCastlingRights(), rhs.getCastlingRights());
+    ASSERT_EQ(lhs.getEnPassantTarget(), rhs.getEnPassantTarget());
+    ASSERT_EQ(lhs.getHalfMoveClock(), rhs.getHalfMoveClock());
+    ASSERT_EQ(lhs.getFullMoveNumber(), rhs.getFullMoveNumber());
+}
+
+} // namespace
+
+TEST(PackedPosition, RoundTrip) {
+    for (auto fen :
+         {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+          "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 b - - 37 60",
+          "QQQQQQQQ/QQQQQQQQ/8/8/8/8/8/K6k w - - 0 1"}) {
+        Board board(fen);
+        Board unpacked;
+        unpack(pack(board), unpacked);
+        expectSamePosition(board, unpacked);
+    }
+}
+
+TEST(PackedPosition, UnpackedPositionPlays) {
+    Board board(
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    Board unpacked;
+    unpack(pack(board), unpacked);
+
+    auto legalMoves = [](Board &position) {
+        int count = 0;
+        MoveGeneration::MoveGenerator moveGenerator(position);
+        for (auto const &move : moveGenerator) {
+            count += position.legalMove(move);
+        }
+        return count;
+    };
+    ASSERT_EQ(legalMoves(unpacked), 48);
+    ASSERT_TRUE(unpacked.getAttackInfo().attacked[Side::B] ==
+                board.getAttackInfo().attacked[Side::B]);
+}
+
+TEST(PackedPosition, ScoreAndResult) {
+    Board board;
+    PackedPosition packed = pack(board);
+    ASSERT_FALSE(packed.hasScore());
+    packed.setScore(100000, -1);
+    ASSERT_TRUE(packed.hasScore());
+    ASSERT_EQ(packed.score, INT16_MAX);
+    ASSERT_EQ(packed.result, -1);
+}
+
+TEST(PackedStream, WriteAndRead) {
+    std::string path = testing::TempDir() + "packed_test.bin";
+    Board board;
+    MoveGeneration::MoveGenerator moveGenerator(board);
+    std::vector<PackedPosition> positions;
+    for (auto const &move : moveGenerator) {
+        board.makeMove(move);
+        positions.push_back(pack(board));
+        board.unmakeMove(move);
+    }
+
+    // More records than a single buffer holds
+    constexpr size_t RECORDS = 100000;
+    {
+        PackedWriter writer(path);
+        ASSERT_TRUE(writer.isOpen());
+        for (size_t i = 0; i < RECORDS; ++i) {
+            PackedPosition position = positions[i % positions.size()];
+            position.setScore(i % 1000, 0);
+            ASSERT_TRUE(writer.write(position));
+        }
+        ASSERT_EQ(writer.written(), RECORDS);
+    }
+
+    PackedReader reader(path);
+    ASSERT_TRUE(reader.isOpen());
+    PackedPosition position;
+    size_t count = 0;
+    while (reader.next(position)) {
+        ASSERT_EQ(position.occupied,
+                  positions[count % positions.size()].occupied);
+        ASSERT_EQ(position.score, static_cast<int16_t>(count % 1000));
+        ++count;
+    }
+    ASSERT_EQ(count, RECORDS);
+
+    PackedReader batches(path);
+    std::vector<PackedPosition> batch(30000);
+    size_t total = 0;
+    while (size_t read = batches.read(batch.data(), batch.size())) {
+        total += read;
+    }
+    ASSERT_EQ(total, RECORDS);
+    std::remove(path.c_str());
+}
+
+TEST(PackedStream, MissingFile) {
+    PackedReader reader("does_not_exist.bin");
+    ASSERT_FALSE(reader.isOpen());
+    PackedPosition position;
+    ASSERT_FALSE(reader.next(position));
+}
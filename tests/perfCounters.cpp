@@ -0,0 +1,33 @@
+#include "../src/perfCounters.h"
+#include "../src/perft.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+using namespace AdiChess;
+
+// Regions are entered whether or not the kernel provides hardware counters
+TEST(PerfCounters, CountsRegionsWhenBuiltIn) {
+    Profile::enable();
+    Board board;
+    perft(board, 3);
+    auto totals = Profile::totals();
+    Profile::disable();
+
+    if (PERF_COUNTERS) {
+        EXPECT_EQ(totals.entries[Profile::MOVE_GENERATION], 1 + 20 + 400);
+        EXPECT_EQ(totals.entries[Profile::MAKE_UNMAKE], 2 * (20 + 400));
+        EXPECT_EQ(totals.entries[Profile::LEGALITY], 20 + 400 + 8902);
+        EXPECT_EQ(totals.entries[Profile::SEARCH], 0);
+    } else {
+        EXPECT_EQ(totals.entries[Profile::MOVE_GENERATION], 0);
+    }
+}
+
+TEST(PerfCounters, ReportsOnlyWhenBuiltIn) {
+    Profile::enable();
+    std::ostringstream output;
+    Profile::report(output);
+    Profile::disable();
+    EXPECT_EQ(output.str().empty(), !PERF_COUNTERS);
+}
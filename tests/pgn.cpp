@@ -0,0 +1,118 @@
+#include "../src/perft.h"
+#include "../src/pgn.h"
+#include "gtest/gtest.h"
+
+#include <fstream>
+
+using namespace AdiChess;
+
+namespace {
+
+std::string san(Board &board, std::string const &text) {
+    auto move = Pgn::parseSan(board, text);
+    return move ? moveToString(*move, board.getCurrentPlayer()) : "";
+}
+
+const char *GAMES = R"([Event "First"]
+[Site "?"]
+[Result "1-0"]
+
+1. e4 e5 2. Nf3 {A comment with (parentheses)} Nc6 3. Bb5 a6 (3... Nf6 4. O-O
+(4. d3) Nxe4) 4. Ba4 $1 Nf6 5. O-O Be7 6. Re1 b5 7. Bb3 d6 8. c3 O-O 1-0
+
+[Event "Second"]
+[Result "1/2-1/2"]
+[FEN "4k3/P7/8/8/8/8/8/4K3 w - - 0 1"]
+[SetUp "1"]
+
+1.a8=Q+ Kd7 ; rest of line
+2.Qb7+ 1/2-1/2
+
+[Event "Unfinished"]
+[Result "*"]
+
+1. d4 d5 *
+)";
+
+} // namespace
+
+TEST(Pgn, San) {
+    Board board;
+    ASSERT_EQ(san(board, "e4"), "e2e4");
+    ASSERT_EQ(san(board, "Nf3"), "g1f3");
+    ASSERT_EQ(san(board, "e5"), "");
+    ASSERT_EQ(san(board, "Ke2"), "");
+
+    // Disambiguation by file and by rank, captures and checks
+    Board knights("4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1");
+    ASSERT_EQ(san(knights, "Nd2"), "");
+    ASSERT_EQ(san(knights, "Nbd2"), "b1d2");
+    ASSERT_EQ(san(knights, "Nfd2"), "f1d2");
+    Board rooks("4k3/8/8/R7/8/8/8/R3K3 w - - 0 1");
+    ASSERT_EQ(san(rooks, "R1a3"), "a1a3");
+    ASSERT_EQ(san(rooks, "R5a3+"), "a5a3");
+
+    Board enPassant("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1");
+    ASSERT_EQ(san(enPassant, "exd6"), "e5d6");
+
+    Board castles("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+    ASSERT_EQ(san(castles, "O-O"), "e1g1");
+    ASSERT_EQ(san(castles, "O-O-O"), "e1c1");
+    ASSERT_EQ(san(castles, "0-0-0"), "e1c1");
+
+    Board promotion("1n2k3/P7/8/8/8/8/8/4K3 w - - 0 1");
+    ASSERT_EQ(san(promotion, "a8=Q"), "a7a8q");
+    ASSERT_EQ(san(promotion, "axb8=N#"), "a7b8n");
+    ASSERT_EQ(san(promotion, "a8"), "");
+}
+
+TEST(Pgn, ReadGames) {
+    std::string path = testing::TempDir() + "pgn_test.pgn";
+    std::ofstream(path) << GAMES;
+    Pgn::Reader reader(path);
+    ASSERT_TRUE(reader.isOpen());
+
+    std::vector<Pgn::Game> games;
+    std::string_view text = reader.text();
+    Pgn::Game game;
+    while (Pgn::nextGame(text, game)) {
+        games.push_back(game);
+    }
+    ASSERT_EQ(games.size(), 3u);
+    ASSERT_EQ(Pgn::tag(games[0], "Event"), "First");
+    ASSERT_EQ(games[0].result, Pgn::WHITE_WINS);
+    ASSERT_EQ(games[1].result, Pgn::DRAW);
+    ASSERT_EQ(games[2].result, Pgn::UNKNOWN);
+
+    // Variations and comments are skipped
+    Board board;
+    int plies = 0;
+    ASSERT_TRUE(Pgn::replay(board, games[0].movetext, 1000,
+                            [&](Board const &, Move const &) { ++plies; }));
+    ASSERT_EQ(plies, 16);
+    ASSERT_EQ(board(MoveGeneration::g8).type, Piece::Type::K);
+
+    Board promotion(std::string(Pgn::tag(games[1], "FEN")));
+    ASSERT_TRUE(Pgn::replay(promotion, games[1].movetext, 1000, {}));
+    ASSERT_EQ(promotion(MoveGeneration::b7).type, Piece::Type::Q);
+
+    // Stops at the ply limit
+    Board limited;
+    ASSERT_TRUE(Pgn::replay(limited, games[0].movetext, 3, {}));
+    ASSERT_EQ(limited.getCurrentPlayer(), Side::B);
+    ASSERT_EQ(limited(MoveGeneration::f3).type, Piece::Type::N);
+
+    Board illegal;
+    ASSERT_FALSE(Pgn::replay(illegal, "1. e4 e4", 1000, {}));
+
+    // Every part of a split starts at a game
+    for (int count = 1; count <= 4; ++count) {
+        size_t total = 0;
+        for (auto part : reader.split(count)) {
+            ASSERT_EQ(part.substr(0, 7), "[Event ");
+            total += part.size();
+        }
+        ASSERT_EQ(total, reader.text().size());
+    }
+    std::remove(path.c_str());
+}
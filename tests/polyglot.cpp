@@ -0,0 +1,152 @@
+#include "../src/polyglot.h"
+#include "../src/search.h"
+#include "../src/uci.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <sstream>
+
+using namespace AdiChess;
+
+namespace {
+
+Move findMove(Board &board, uint64_t from, uint64_t to) {
+    MoveGeneration::MoveGenerator moveGenerator(board);
+    for (auto const &move : moveGenerator) {
+        if (move.getFrom() == from && move.getTo() == to) {
+            return move;
+        }
+    }
+    return NO_MOVE;
+}
+
+} // namespace
+
+// Test positions of the Polyglot book format specification
+TEST(PolyglotKey, MatchesPublishedKeys) {
+    const std::pair<const char *, uint64_t> lines[] = {
+        {"", 0x463b96181691fc9c},
+        {"e2e4", 0x823c9b50fd114196},
+        {"e2e4 d7d5", 0x0756b94461c50fb0},
+        {"e2e4 d7d5 e4e5", 0x662fafb965db29d4},
+        {"e2e4 d7d5 e4e5 f7f5", 0x22a48b5a8e47ff78},
+        {"e2e4 d7d5 e4e5 f7f5 e1e2", 0x652a607ca3f242c1},
+        {"e2e4 d7d5 e4e5 f7f5 e1e2 e8f7", 0x00fdd303c946bdd9},
+        {"a2a4 b7b5 h2h4 b5b4 c2c4", 0x3c8123ea7b067637},
+        {"a2a4 b7b5 h2h4 b5b4 c2c4 b4c3 a1a3", 0x5c3f9b829b279560},
+    };
+    for (auto const &[moves, key] : lines) {
+        std::istringstream arguments(std::string("startpos moves ") + moves);
+        auto board = UCI::parsePosition(arguments);
+        ASSERT_TRUE(board) << moves;
+        ASSERT_EQ(Polyglot::computeKey(*board), key) << moves;
+    }
+}
+
+TEST(PolyglotKey, SideToMoveChangesKey) {
+    Board white("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    Board black("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1");
+    ASSERT_NE(Polyglot::computeKey(white), Polyglot::computeKey(black));
+}
+
+TEST(PolyglotKey, TranspositionsShareKey) {
+    Board board;
+    uint64_t startKey = Polyglot::computeKey(board);
+    const uint64_t route[][2] = {{MoveGeneration::g1, MoveGeneration::f3},
+                                 {MoveGeneration::g8, MoveGeneration::f6},
+                                 {MoveGeneration::f3, MoveGeneration::g1},
+                                 {MoveGeneration::f6, MoveGeneration::g8}};
+    for (auto const &squares : route) {
+        board.makeMove(findMove(board, squares[0], squares[1]));
+    }
+    ASSERT_EQ(Polyglot::computeKey(board), startKey);
+}
+
+TEST(PolyglotKey, EnPassantOnlyWhenCapturable) {
+    // No black pawn can capture on e3
+    Board quiet("4k3/8/8/8/4P3/8/8/4K3 b - e3 0 1");
+    Board noTarget("4k3/8/8/8/4P3/8/8/4K3 b - - 0 1");
+    ASSERT_EQ(Polyglot::computeKey(quiet), Polyglot::computeKey(noTarget));
+
+    Board capturable("4k3/8/8/8/3pP3/8/8/4K3 b - e3 0 1");
+    Board notCapturable("4k3/8/8/8/3pP3/8/8/4K3 b - - 0 1");
+    ASSERT_NE(Polyglot::computeKey(capturable),
+              Polyglot::computeKey(notCapturable));
+}
+
+TEST(PolyglotMove, Encoding) {
+    // e2e4: to file 4 row 3, from file 4 row 1
+    Move e2e4(MoveGeneration::e2, MoveGeneration::e4, Move::DOUBLE_PAWN_PUSH);
+    ASSERT_EQ(Polyglot::encodeMove(e2e4, Side::W),
+              4 | (3 << 3) | (4 << 6) | (1 << 9));
+
+    // Castling is encoded as the king capturing its rook
+    Move castle(0, 0, Move::KING_CASTLE);
+    ASSERT_EQ(Polyglot::encodeMove(castle, Side::B),
+              7 | (7 << 3) | (4 << 6) | (7 << 9));
+
+    Move promotion(MoveGeneration::a7, MoveGeneration::a8,
+                   Move::QUEEN_PROMOTION);
+    ASSERT_EQ(Polyglot::encodeMove(promotion, Side::W) >> 12, 4);
+}
+
+TEST(PolyglotMove, DecodeRoundTrip) {
+    Board board(
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    MoveGeneration::MoveGenerator moveGenerator(board);
+    for (auto const &move : moveGenerator) {
+        if (!board.legalMove(move)) {
+            continue;
+        }
+        auto decoded = Polyglot::decodeMove(
+            Polyglot::encodeMove(move, board.getCurrentPlayer()), board);
+        ASSERT_TRUE(decoded);
+        ASSERT_TRUE(*decoded == move);
+    }
+}
+
+TEST(PolyglotBook, ProbeLocalBook) {
+    Board board;
+    uint64_t startKey = Polyglot::computeKey(board);
+    Move e2e4(MoveGeneration::e2, MoveGeneration::e4, Move::DOUBLE_PAWN_PUSH);
+    Move d2d4(MoveGeneration::d2, MoveGeneration::d4, Move::DOUBLE_PAWN_PUSH);
+
+    std::string path = testing::TempDir() + "polyglot_test.bin";
+    ASSERT_TRUE(Polyglot::writeBook(
+        path, {{startKey + 1, 0, 1, 0},
+               {startKey, Polyglot::encodeMove(d2d4, Side::W), 1, 0},
+               {startKey - 1, 0, 1, 0},
+               {startKey, Polyglot::encodeMove(e2e4, Side::W), 3, 0}}));
+
+    Polyglot::Book book(path);
+    ASSERT_TRUE(book.isOpen());
+    ASSERT_EQ(book.size(), 4);
+
+    auto entries = book.lookup(startKey);
+    ASSERT_EQ(entries.size(), 2);
+    ASSERT_EQ(entries[0].weight, 3);
+
+    for (int i = 0; i < 20; ++i) {
+        auto move = book.probe(board);
+        ASSERT_TRUE(move);
+        ASSERT_TRUE(*move == e2e4 || *move == d2d4);
+    }
+
+    // The search plays book moves without searching
+    Search search(board);
+    search.setBook(&book);
+    search.negamax(10);
+    Move principal = search.getPrincipalMove();
+    ASSERT_TRUE(principal == e2e4 || principal == d2d4);
+
+    board.makeMove(e2e4);
+    ASSERT_FALSE(book.probe(board));
+    std::remove(path.c_str());
+}
+
+TEST(PolyglotBook, MissingFile) {
+    Polyglot::Book book("does_not_exist.bin");
+    ASSERT_FALSE(book.isOpen());
+    Board board;
+    ASSERT_FALSE(book.probe(board));
+}
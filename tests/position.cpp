@@ -0,0 +1,121 @@
+#include "../src/board.h"
+#include "../src/moveGenerator.h"
+#include "../src/perft.h"
+#include "../src/position.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace AdiChess;
+
+namespace {
+
+const char *KIWIPETE =
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+
+std::vector<uint16_t> legalMoves(Board &board) {
+    std::vector<uint16_t> moves;
+    MoveGeneration::MoveGenerator moveGenerator(board);
+    for (auto const &move : moveGenerator) {
+        if (board.legalMove(move)) {
+            moves.push_back(move.raw());
+        }
+    }
+    std::sort(moves.begin(), moves.end());
+    return moves;
+}
+
+std::vector<uint16_t> legalMoves(Position const &position) {
+    std::vector<uint16_t> moves;
+    MoveList moveList;
+    position.generateMoves(moveList);
+    for (auto const &move : moveList) {
+        moves.push_back(move.raw());
+    }
+    std::sort(moves.begin(), moves.end());
+    return moves;
+}
+
+} // namespace
+
+TEST(Position, SpansTwoCacheLines) {
+    EXPECT_EQ(sizeof(Position), 128);
+    EXPECT_EQ(alignof(Position), 64);
+}
+
+TEST(Position, MatchesBoard) {
+    Board board(KIWIPETE);
+    Position position(board);
+    EXPECT_EQ(position.getKey(), board.getKey());
+    EXPECT_EQ(position.getCastlingRights(), board.getCastlingRights());
+    EXPECT_EQ(position.getCurrentPlayer(), Side::W);
+    for (int square = 0; square < 64; ++square) {
+        EXPECT_EQ(position(square).type, board(square).type);
+        if (board(square).type != Piece::Type::NONE) {
+            EXPECT_EQ(position(square).side, board(square).side);
+        }
+    }
+}
+
+TEST(Position, Perft) {
+    EXPECT_EQ(perft(Position(), 4), 197281);
+    EXPECT_EQ(perft(Position(KIWIPETE), 3), 97862);
+    EXPECT_EQ(perft(Position("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"), 5),
+              674624);
+    EXPECT_EQ(perft(Position("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/"
+                             "R2Q1RK1 w kq - 0 1"),
+                    4),
+              422333);
+    EXPECT_EQ(perft(Position("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R "
+                             "w KQ - 1 8"),
+                    3),
+              62379);
+    EXPECT_EQ(perft(Position("r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/"
+                             "1PP1QPPP/R4RK1 w - - 0 10"),
+                    3),
+              89890);
+}
+
+TEST(Position, DivideMatchesBoard) {
+    Board board(KIWIPETE);
+    auto expected = divide(board, 2);
+    auto counts = divide(Position(board), 2);
+    ASSERT_EQ(counts.size(), expected.size());
+    auto byMove = [](auto const &a, auto const &b) {
+        return a.first.raw() < b.first.raw();
+    };
+    std::sort(expected.begin(), expected.end(), byMove);
+    std::sort(counts.begin(), counts.end(), byMove);
+    for (size_t i = 0; i < counts.size(); ++i) {
+        EXPECT_EQ(counts[i].first, expected[i].first);
+        EXPECT_EQ(counts[i].second, expected[i].second);
+    }
+}
+
+// Random games played on both models keep the same moves, keys and state
+TEST(Position, RandomGamesMatchBoard) {
+    std::mt19937 random(7);
+    for (int game = 0; game < 20; ++game) {
+        Board board(KIWIPETE);
+        Position position(board);
+        for (int ply = 0; ply < 120; ++ply) {
+            auto moves = legalMoves(board);
+            ASSERT_EQ(legalMoves(position), moves);
+            if (moves.empty()) {
+                break;
+            }
+            uint16_t raw = moves[random() % moves.size()];
+            const Move move = Move::fromRaw(raw);
+            board.makeMove(move);
+            position.makeMove(move);
+            ASSERT_EQ(position.getKey(), board.getKey());
+            ASSERT_EQ(position.getEnPassantTarget(),
+                      board.getEnPassantTarget());
+            ASSERT_EQ(position.getCastlingRights(), board.getCastlingRights());
+            ASSERT_EQ(position.getFullMoveNumber(), board.getFullMoveNumber());
+            ASSERT_EQ(position.inCheck(),
+                      board.inCheck(board.getCurrentPlayer()));
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#include "../src/search.h"
+#include "gtest/gtest.h"
+
+using namespace AdiChess;
+
+TEST(MultiPV, DistinctRootMovesBestFirst) {
+    Board board("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    TranspositionTable table(1);
+    SearchLimits limits;
+    limits.depth = 4;
+
+    Search single(board);
+    single.setTranspositionTable(&table);
+    int best = single.search(limits);
+
+    table.clear();
+    Search search(board);
+    search.setTranspositionTable(&table);
+    search.setMultiPV(3);
+    std::vector<SearchInfo> reported;
+    ASSERT_EQ(search.search(limits, [&](SearchInfo const &info) {
+        reported.push_back(info);
+    }), best);
+
+    // Every iteration reports all lines in rank order
+    ASSERT_EQ(reported.size(), 3u * limits.depth);
+    for (size_t i = 0; i < reported.size(); ++i) {
+        ASSERT_EQ(reported[i].depth, static_cast<int>(i / 3) + 1);
+        ASSERT_EQ(reported[i].multiPV, static_cast<int>(i % 3) + 1);
+    }
+
+    auto const &lines = search.getLines();
+    ASSERT_EQ(lines.size(), 3u);
+    ASSERT_EQ(lines[0].score, best);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        ASSERT_FALSE(lines[i].principalVariation.empty());
+        if (i > 0) {
+            ASSERT_LE(lines[i].score, lines[i - 1].score);
+        }
+        for (size_t j = 0; j < i; ++j) {
+            ASSERT_NE(lines[i].principalVariation.front(),
+                      lines[j].principalVariation.front());
+        }
+    }
+    ASSERT_EQ(search.getPrincipalMove(), lines[0].principalVariation.front());
+}
+
+TEST(MultiPV, FewerLegalMovesThanLines) {
+    // The black king's only move is to b8
+    Board board("k7/8/1K6/8/8/8/8/8 b - - 0 1");
+    Search search(board);
+    search.setMultiPV(4);
+    SearchLimits limits;
+    limits.depth = 2;
+    search.search(limits);
+    ASSERT_EQ(search.getLines().size(), 1u);
+}
+
+TEST(PonderMove, HashMoveAfterOneMoveLine) {
+    Board board;
+    TranspositionTable table;
+    SearchLimits limits;
+    limits.depth = 4;
+    Search deep(board);
+    deep.setTranspositionTable(&table);
+    deep.search(limits);
+
+    // A one ply line names no reply, the table holds one from the deeper
+    // search
+    limits.depth = 1;
+    Search search(board);
+    search.search(limits);
+    ASSERT_EQ(search.getPrincipalVariation().size(), 1u);
+    ASSERT_EQ(search.getPonderMove(), NO_MOVE);
+
+    search.setTranspositionTable(&table);
+    search.search(limits);
+    ASSERT_EQ(search.getPrincipalVariation().size(), 1u);
+    const Move reply = search.getPonderMove();
+    ASSERT_NE(reply, NO_MOVE);
+
+    const uint64_t key = board.getKey();
+    board.makeMove(search.getPrincipalMove());
+    ASSERT_TRUE(board.legalMove(reply));
+    board.unmakeMove(search.getPrincipalMove());
+    ASSERT_EQ(board.getKey(), key);
+}
@@ -0,0 +1,75 @@
+#include "../src/search.h"
+#include "../src/searchTrace.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+using namespace AdiChess;
+
+TEST(SearchTrace, RecordsEveryNodeWithoutChangingTheSearch) {
+    const char *fen =
+        "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3";
+    std::string path = testing::TempDir() + "search_trace_test.atr";
+    SearchLimits limits;
+    limits.depth = 4;
+
+    Board board(fen);
+    TranspositionTable table(1);
+    Search plain(board);
+    plain.setTranspositionTable(&table);
+    int score = plain.search(limits);
+    uint64_t nodes = plain.getNodes();
+
+    {
+        // A small ring makes the search wait on the writer
+        Trace::Recorder recorder(path, 64);
+        ASSERT_TRUE(recorder.isOpen());
+        table.clear();
+        Search traced(board);
+        traced.setTranspositionTable(&table);
+        traced.setTrace(&recorder);
+        ASSERT_EQ(traced.search(limits), score);
+        ASSERT_EQ(traced.getNodes(), nodes);
+        ASSERT_EQ(traced.getPrincipalMove(), plain.getPrincipalMove());
+    }
+
+    std::vector<Trace::Record> records;
+    ASSERT_TRUE(Trace::read(path, records));
+    // Every node, a root record and a marker per iteration
+    ASSERT_EQ(records.size(), nodes + 2 * limits.depth);
+
+    auto summary = Trace::summarise(records, 5);
+    ASSERT_EQ(summary.iterations.size(), static_cast<size_t>(limits.depth));
+    uint64_t total = 0;
+    for (size_t i = 0; i < summary.iterations.size(); ++i) {
+        ASSERT_EQ(summary.iterations[i].first, static_cast<int>(i) + 1);
+        total += summary.iterations[i].second;
+    }
+    ASSERT_EQ(total, nodes);
+
+    uint64_t depthNodes = 0;
+    for (auto const &[depth, stats] : summary.depths) {
+        depthNodes += stats.nodes;
+        ASSERT_LE(stats.firstMoveFailHighs, stats.failHighs);
+        ASSERT_LE(stats.hashCutoffs, stats.hashHits);
+    }
+    ASSERT_EQ(depthNodes, nodes);
+
+    ASSERT_EQ(summary.heaviest.size(), 5u);
+    for (size_t i = 0; i < summary.heaviest.size(); ++i) {
+        auto const &subtree = summary.heaviest[i];
+        ASSERT_EQ(subtree.path.size(), subtree.record.ply);
+        if (i > 0) {
+            ASSERT_LE(subtree.record.nodes, summary.heaviest[i - 1].record.nodes);
+        }
+    }
+
+    std::ostringstream output;
+    Trace::report(summary, output);
+    ASSERT_NE(output.str().find("Heaviest subtrees"), std::string::npos);
+}
+
+TEST(SearchTrace, RejectsOtherFiles) {
+    std::vector<Trace::Record> records;
+    ASSERT_FALSE(Trace::read(testing::TempDir() + "missing.atr", records));
+}
@@ -0,0 +1,48 @@
+#include "../src/packedPosition.h"
+#include "../src/selfPlay.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+
+using namespace AdiChess;
+
+TEST(SelfPlay, WritesQuietScoredPositions) {
+    std::string path = testing::TempDir() + "selfplay_test.bin";
+    SelfPlay::Options options;
+    options.games = 3;
+    options.threads = 2;
+    options.depth = 2;
+    options.maxPlies = 40;
+    auto stats = SelfPlay::run(path, options);
+    ASSERT_EQ(stats.games, 3);
+    ASSERT_GT(stats.positions, 0);
+
+    PackedReader reader(path);
+    PackedPosition position;
+    uint64_t count = 0;
+    Board board;
+    while (reader.next(position)) {
+        ASSERT_TRUE(position.hasScore());
+        ASSERT_GE(position.result, -1);
+        ASSERT_LE(position.result, 1);
+        unpack(position, board);
+        ASSERT_FALSE(board.inCheck(board.getCurrentPlayer()));
+        ++count;
+    }
+    ASSERT_EQ(count, stats.positions);
+    std::remove(path.c_str());
+}
+
+TEST(SelfPlay, IndependentOfThreadCount) {
+    std::string path = testing::TempDir() + "selfplay_threads_test.bin";
+    SelfPlay::Options options;
+    options.games = 2;
+    options.depth = 1;
+    options.maxPlies = 30;
+    options.seed = 7;
+    auto single = SelfPlay::run(path, options);
+    options.threads = 2;
+    auto multiple = SelfPlay::run(path, options);
+    ASSERT_EQ(single.positions, multiple.positions);
+    std::remove(path.c_str());
+}
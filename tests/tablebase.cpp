@@ -0,0 +1,195 @@
+#include "../src/search.h"
+#include "../src/tablebase.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+
+using namespace AdiChess;
+
+namespace {
+
+// Generates the pawnless three piece tables once for the whole suite
+class Tablebases : public testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        generated = new Tablebase::Tablebases;
+        for (auto const &signature : {"KQK", "KRK", "KBK", "KNK"}) {
+            ASSERT_TRUE(
+                generated->generate(testing::TempDir(), signature, 2));
+        }
+    }
+
+    static void TearDownTestSuite() {
+        delete generated;
+        generated = nullptr;
+    }
+
+    static Tablebase::Tablebases *generated;
+};
+
+Tablebase::Tablebases *Tablebases::generated = nullptr;
+
+} // namespace
+
+TEST(TablebaseSignature, GenerationOrder) {
+    auto signatures = Tablebase::allSignatures(3);
+    ASSERT_EQ(signatures.size(), 5);
+    // Promotions lead into the pawnless tables
+    ASSERT_EQ(signatures.back(), "KPK");
+
+    auto fourPieces = Tablebase::allSignatures(4);
+    ASSERT_NE(std::find(fourPieces.begin(), fourPieces.end(), "KQKR"),
+              fourPieces.end());
+    ASSERT_EQ(std::find(fourPieces.begin(), fourPieces.end(), "KRKQ"),
+              fourPieces.end());
+    ASSERT_NE(std::find(fourPieces.begin(), fourPieces.end(), "KRKR"),
+              fourPieces.end());
+}
+
+TEST(TablebaseSignature, Dependencies) {
+    // Promoted pieces are listed in signature order
+    std::vector<std::string> expected = {"KPK",  "KRK",  "KQRK",
+                                         "KRRK", "KRBK", "KRNK"};
+    ASSERT_EQ(Tablebase::dependencies("KRPK"), expected);
+    auto bishop = Tablebase::dependencies("KBPK");
+    ASSERT_NE(std::find(bishop.begin(), bishop.end(), "KRBK"), bishop.end());
+
+    // Each table only depends on tables generated before it
+    auto signatures = Tablebase::allSignatures(4);
+    for (auto table = signatures.begin(); table != signatures.end(); ++table) {
+        for (auto const &dependency : Tablebase::dependencies(*table)) {
+            ASSERT_NE(std::find(signatures.begin(), table, dependency), table)
+                << *table << " needs " << dependency;
+        }
+    }
+}
+
+TEST(TablebaseSignature, FromBoard) {
+    Board board("8/8/3k4/8/8/2NR4/8/4K3 w - - 0 1");
+    ASSERT_EQ(Tablebase::signature(board), "KRNK");
+}
+
+TEST_F(Tablebases, Mates) {
+    Board mateInOne("k7/8/1K6/8/8/8/8/6Q1 w - - 0 1");
+    auto result = generated->probe(mateInOne);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->outcome, Tablebase::ProbeResult::WIN);
+    ASSERT_EQ(result->plies, 1);
+
+    Board mated("k7/1Q6/1K6/8/8/8/8/8 b - - 0 1");
+    result = generated->probe(mated);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->outcome, Tablebase::ProbeResult::LOSS);
+    ASSERT_EQ(result->plies, 0);
+
+    // Same position with colours reversed
+    Board flipped("K7/1q6/1k6/8/8/8/8/8 w - - 0 1");
+    result = generated->probe(flipped);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->outcome, Tablebase::ProbeResult::LOSS);
+    ASSERT_EQ(result->plies, 0);
+}
+
+TEST_F(Tablebases, Draws) {
+    Board stalemate("k7/8/1Q6/8/8/8/8/7K b - - 0 1");
+    Board bishop("8/8/3k4/8/8/2B5/8/4K3 w - - 0 1");
+    for (Board *board : {&stalemate, &bishop}) {
+        auto result = generated->probe(*board);
+        ASSERT_TRUE(result);
+        ASSERT_EQ(result->outcome, Tablebase::ProbeResult::DRAW);
+    }
+}
+
+TEST_F(Tablebases, PieceCountBounds) {
+    // Bare kings need no table, one piece more than the largest table misses
+    Board kings("8/8/3k4/8/8/8/8/4K3 w - - 0 1");
+    auto result = generated->probe(kings);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->outcome, Tablebase::ProbeResult::DRAW);
+    ASSERT_EQ(generated->maxPieces(), 3);
+    Board fourPieces("8/8/3k4/8/3n4/8/1R6/K7 w - - 0 1");
+    ASSERT_FALSE(generated->probe(fourPieces));
+}
+
+TEST_F(Tablebases, LongestMates) {
+    // Every legal king and queen or rook position, the longest mates are ten
+    // and sixteen moves
+    int longest[2] = {0, 0};
+    const Piece pieces[2] = {Piece(Piece::Type::Q, Side::W),
+                             Piece(Piece::Type::R, Side::W)};
+    for (int i = 0; i < 2; ++i) {
+        for (int whiteKing = 0; whiteKing < 64; ++whiteKing) {
+            for (int blackKing = 0; blackKing < 64; ++blackKing) {
+                for (int piece = 0; piece < 64; ++piece) {
+                    if (whiteKing == blackKing || whiteKing == piece ||
+                        blackKing == piece) {
+                        continue;
+                    }
+                    Board board;
+                    board.clear(Side::W);
+                    board(whiteKing, Piece(Piece::Type::K, Side::W));
+                    board(blackKing, Piece(Piece::Type::K, Side::B));
+                    board(piece, pieces[i]);
+                    if (auto result = generated->probe(board)) {
+                        longest[i] = std::max(longest[i], result->plies);
+                    }
+                }
+            }
+        }
+    }
+    ASSERT_EQ(longest[0], 19);
+    ASSERT_EQ(longest[1], 31);
+}
+
+TEST_F(Tablebases, MemoryMappedMatchesGenerated) {
+    Tablebase::Tablebases loaded(testing::TempDir());
+    ASSERT_GE(loaded.size(), 4);
+    ASSERT_EQ(loaded.maxPieces(), 3);
+
+    Board board("8/8/8/3k4/8/8/1R6/K7 b - - 0 1");
+    auto fromFile = loaded.probe(board);
+    auto fromMemory = generated->probe(board);
+    ASSERT_TRUE(fromFile && fromMemory);
+    ASSERT_EQ(fromFile->outcome, fromMemory->outcome);
+    ASSERT_EQ(fromFile->plies, fromMemory->plies);
+
+    // Unsupported material
+    Board start;
+    ASSERT_FALSE(loaded.probe(start));
+}
+
+TEST_F(Tablebases, SearchPlaysMate) {
+    Board board("k7/8/1K6/8/8/8/8/6Q1 w - - 0 1");
+    Search search(board);
+    search.setTablebases(generated);
+    ASSERT_EQ(search.negamax(2), MATE_SCORE - 1);
+
+    board.makeMove(search.getPrincipalMove());
+    auto result = generated->probe(board);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->plies, 0);
+}
+
+TEST(TablebaseGeneration, PawnEndings) {
+    Tablebase::Tablebases tablebases;
+    // Promotions need the pawnless tables first
+    ASSERT_FALSE(tablebases.generate(testing::TempDir(), "KPK", 2));
+    for (auto const &signature : Tablebase::allSignatures(3)) {
+        ASSERT_TRUE(tablebases.generate(testing::TempDir(), signature, 2));
+    }
+
+    // King on the sixth in front of its pawn wins with either side to move
+    Board white("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1");
+    Board black("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1");
+    auto result = tablebases.probe(white);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->outcome, Tablebase::ProbeResult::WIN);
+    result = tablebases.probe(black);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->outcome, Tablebase::ProbeResult::LOSS);
+
+    Board rookPawn("k7/8/K7/P7/8/8/8/8 w - - 0 1");
+    result = tablebases.probe(rookPawn);
+    ASSERT_TRUE(result);
+    ASSERT_EQ(result->outcome, Tablebase::ProbeResult::DRAW);
+}
@@ -0,0 +1,79 @@
+#include "../src/evaluation.h"
+#include "../src/tuner.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace AdiChess;
+
+namespace {
+
+const char *FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "4k3/8/8/8/8/8/8/2BQKB2 b - - 0 1"};
+
+} // namespace
+
+TEST(Tuning, FeaturesMatchEvaluation) {
+    Tuning::Dataset dataset;
+    Tuning::Parameters parameters = Tuning::currentParameters();
+    for (size_t i = 0; i < std::size(FENS); ++i) {
+        Board board(FENS[i]);
+        dataset.add(board, 0.5);
+        int expected = Evaluation::evaluate(board);
+        if (board.getCurrentPlayer() == Side::B) {
+            expected = -expected;
+        }
+        ASSERT_NEAR(Tuning::evaluate(dataset, i, parameters), expected, 1);
+    }
+}
+
+TEST(Tuning, ReducesLoss) {
+    // White wins the positions where it is ahead and loses the others
+    Tuning::Dataset dataset;
+    Board ahead("4k3/8/8/8/8/8/8/2BQKB2 w - - 0 1");
+    Board behind("2bqkb2/8/8/8/8/8/8/4K3 w - - 0 1");
+    Board level;
+    for (int i = 0; i < 1000; ++i) {
+        dataset.add(ahead, 1);
+        dataset.add(behind, 0);
+        dataset.add(level, 0.5);
+    }
+
+    Tuning::Parameters parameters = Tuning::currentParameters();
+    // Deliberately poor sigmoid scale so the weights have to move
+    double k = 1e-4;
+    double before = Tuning::loss(dataset, parameters, k, 2);
+    Tuning::Options options;
+    options.epochs = 20;
+    options.batchSize = 512;
+    options.threads = 2;
+    int reports = 0;
+    Tuning::Parameters tuned = Tuning::tune(
+        dataset, parameters, k, options, [&](int, double) { ++reports; });
+    ASSERT_EQ(reports, options.epochs);
+    ASSERT_LT(Tuning::loss(dataset, tuned, k, 2), before);
+}
+
+TEST(Tuning, WritesHeader) {
+    std::string path = testing::TempDir() + "tuning_test.h";
+    Tuning::Parameters parameters = Tuning::currentParameters();
+    // Opening queen value
+    parameters[Piece::Type::Q] = 2600.4;
+    ASSERT_TRUE(Tuning::writeHeader(path, parameters));
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    ASSERT_NE(contents.str().find("constexpr int MATERIAL_VALUES[2][6]"),
+              std::string::npos);
+    ASSERT_NE(contents.str().find("[Piece::Type::Q] = 2600"), std::string::npos);
+    ASSERT_NE(contents.str().find("BISHOP_PAIR_VALUES"), std::string::npos);
+    std::remove(path.c_str());
+}
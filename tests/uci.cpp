@@ -0,0 +1,43 @@
+#include "../src/uci.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+using namespace AdiChess;
+
+TEST(UCI, ParsePosition) {
+    std::istringstream arguments("startpos moves e2e4 e7e5 g1f3 b8c6 f1c4 "
+                                 "g8f6 e1g1");
+    auto board = UCI::parsePosition(arguments);
+    ASSERT_TRUE(board);
+    ASSERT_EQ(board->getCurrentPlayer(), Side::B);
+    ASSERT_EQ((*board)(MoveGeneration::g1).type, Piece::Type::K);
+    ASSERT_EQ((*board)(MoveGeneration::f1).type, Piece::Type::R);
+
+    std::istringstream fen("fen 8/P6k/8/8/8/8/8/K7 w - - 0 1 moves a7a8n");
+    board = UCI::parsePosition(fen);
+    ASSERT_TRUE(board);
+    ASSERT_EQ((*board)(MoveGeneration::a8).type, Piece::Type::N);
+}
+
+TEST(UCI, RejectsInvalidInput) {
+    std::istringstream illegalMove("startpos moves e2e5");
+    ASSERT_FALSE(UCI::parsePosition(illegalMove));
+    std::istringstream missingKing("fen 8/8/8/8/8/8/8/K7 w - - 0 1");
+    ASSERT_FALSE(UCI::parsePosition(missingKing));
+    std::istringstream shortRank("fen 7k/8/8/8/8/8/8/K6 w - - 0 1");
+    ASSERT_FALSE(UCI::parsePosition(shortRank));
+    // The side not to move is in check
+    std::istringstream check("fen k7/8/8/8/8/8/8/R6K b - - 0 1");
+    ASSERT_TRUE(UCI::parsePosition(check));
+    std::istringstream opponentInCheck("fen k7/8/8/8/8/8/8/R6K w - - 0 1");
+    ASSERT_FALSE(UCI::parsePosition(opponentInCheck));
+}
+
+TEST(UCI, FormatScore) {
+    ASSERT_EQ(UCI::formatScore(35), "cp 35");
+    ASSERT_EQ(UCI::formatScore(-120), "cp -120");
+    ASSERT_EQ(UCI::formatScore(MATE_SCORE - 1), "mate 1");
+    ASSERT_EQ(UCI::formatScore(MATE_SCORE - 3), "mate 2");
+    ASSERT_EQ(UCI::formatScore(-MATE_SCORE + 2), "mate -1");
+}
@@ -0,0 +1,147 @@
+#include "../src/uciEngine.h"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+using namespace AdiChess;
+
+namespace {
+
+// Lines written by the engine, read while its search thread runs
+class Output {
+public:
+    std::function<void(std::string const &)> writer() {
+        return [this](std::string const &line) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.push_back(line);
+        };
+    }
+
+    std::vector<std::string> get() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lines;
+    }
+
+    bool hasBestMove() {
+        auto current = get();
+        return !current.empty() && current.back().rfind("bestmove ", 0) == 0;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::string> lines;
+};
+
+void sleep(int milliseconds) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+} // namespace
+
+TEST(UCIEngine, Handshake) {
+    Output output;
+    UCI::Engine engine(output.writer());
+    ASSERT_TRUE(engine.command("uci"));
+    ASSERT_TRUE(engine.command("isready"));
+    ASSERT_FALSE(engine.command("quit"));
+    auto lines = output.get();
+    ASSERT_EQ(lines.front(), "id name AdiChess");
+    ASSERT_EQ(lines[lines.size() - 2], "uciok");
+    ASSERT_EQ(lines.back(), "readyok");
+}
+
+TEST(UCIEngine, BestMoveNamesPonderMove) {
+    Output output;
+    UCI::Engine engine(output.writer());
+    engine.command("position startpos moves e2e4");
+    engine.command("go depth 3");
+    engine.wait();
+    auto lines = output.get();
+    ASSERT_EQ(lines.size(), 4u);
+    ASSERT_NE(lines.back().find(" ponder "), std::string::npos);
+}
+
+TEST(UCIEngine, PonderHitContinuesTimedSearch) {
+    Output output;
+    UCI::Engine engine(output.writer());
+    engine.command("position startpos moves e2e4 e7e5");
+    engine.command("go ponder wtime 3000 btime 3000");
+    // Pondering ignores the clock and keeps deepening
+    sleep(300);
+    ASSERT_FALSE(output.hasBestMove());
+    size_t pondered = output.get().size();
+    ASSERT_GT(pondered, 0u);
+
+    auto hit = std::chrono::steady_clock::now();
+    engine.command("ponderhit");
+    engine.wait();
+    auto seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - hit)
+                       .count();
+    ASSERT_TRUE(output.hasBestMove());
+    // The search was not restarted, depths run on from the pondered ones
+    auto lines = output.get();
+    for (size_t i = 0; i + 1 < lines.size(); ++i) {
+        ASSERT_EQ(lines[i].rfind("info depth " + std::to_string(i + 1) + " ", 0),
+                  0u);
+    }
+    // A 3 s clock allots about a thirtieth of it
+    ASSERT_LT(seconds, 1.0);
+}
+
+TEST(UCIEngine, PonderMissIsDiscardedOnStop) {
+    Output output;
+    UCI::Engine engine(output.writer());
+    engine.command("position startpos moves e2e4 e7e5");
+    engine.command("go ponder depth 2");
+    // Finished the depth but waits for the opponent's move
+    sleep(100);
+    ASSERT_FALSE(output.hasBestMove());
+    engine.command("stop");
+    engine.wait();
+    ASSERT_TRUE(output.hasBestMove());
+
+    // The next search starts normally
+    engine.command("position startpos moves e2e4 c7c5");
+    engine.command("go depth 2");
+    engine.wait();
+    auto lines = output.get();
+    ASSERT_EQ(lines.back().rfind("bestmove ", 0), 0u);
+    ASSERT_EQ(lines[lines.size() - 3].rfind("info depth 1 ", 0), 0u);
+}
+
+TEST(UCIEngine, GoMateRunsProofNumberSearch) {
+    Output output;
+    UCI::Engine engine(output.writer());
+    engine.command("position fen r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/"
+                   "PPP2PPP/R2bK2R w KQkq - 1 1");
+    engine.command("go mate 3");
+    engine.wait();
+    auto lines = output.get();
+    ASSERT_EQ(lines.size(), 2u);
+    ASSERT_NE(lines[0].find("score mate 2 "), std::string::npos);
+    ASSERT_NE(lines[0].find(" pv d5f6 g7f6 c4f7"), std::string::npos);
+    ASSERT_EQ(lines[1], "bestmove d5f6 ponder g7f6");
+
+    engine.command("position startpos");
+    engine.command("go mate 2");
+    engine.wait();
+    lines = output.get();
+    ASSERT_EQ(lines.back(), "bestmove 0000");
+}
+
+TEST(UCIEngine, SearcherOptionSelectsMcts) {
+    Output output;
+    UCI::Engine engine(output.writer());
+    engine.command("setoption name Searcher value MCTS");
+    engine.command("setoption name Threads value 2");
+    engine.command("position fen 6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1");
+    engine.command("go nodes 5000");
+    engine.wait();
+    auto lines = output.get();
+    ASSERT_GE(lines.size(), 2u);
+    ASSERT_EQ(lines[lines.size() - 2].rfind("info depth ", 0), 0u);
+    ASSERT_EQ(lines.back().rfind("bestmove d1d8", 0), 0u);
+}
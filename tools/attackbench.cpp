@@ -0,0 +1,107 @@
+#include "../src/board.h"
+#include "../src/slidingAttacks.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace AdiChess;
+
+namespace {
+
+const std::vector<std::string> positions = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+struct SliderSet {
+    uint64_t rooks;
+    uint64_t bishops;
+    uint64_t queens;
+    uint64_t occupied;
+};
+
+// Attacks of all sliders, one piece at a time through the classical rays
+uint64_t perPieceAttacks(Board const &board, SliderSet const &sliders) {
+    uint64_t attacks = 0;
+    const Piece::Type types[] = {Piece::Type::R, Piece::Type::B,
+                                 Piece::Type::Q};
+    const uint64_t sets[] = {sliders.rooks, sliders.bishops, sliders.queens};
+    for (int i = 0; i < 3; ++i) {
+        uint64_t positions = sets[i];
+        while (positions) {
+            attacks |= board.getAttackMap(Utility::bitScanPop(positions),
+                                          types[i], 0, sliders.occupied,
+                                          Side::W);
+        }
+    }
+    return attacks;
+}
+
+uint64_t setWiseAttacks(SliderSet const &sliders) {
+    auto attacks = MoveGeneration::getSlidingAttacks(
+        sliders.rooks | sliders.queens, sliders.bishops | sliders.queens,
+        ~sliders.occupied);
+    return attacks.rookLike | attacks.bishopLike;
+}
+
+template <typename F> double timeIterations(int iterations, F const &f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        f();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 1000000;
+
+    std::vector<SliderSet> sliderSets;
+    std::vector<std::unique_ptr<Board>> boards;
+    for (auto const &fen : positions) {
+        boards.push_back(std::make_unique<Board>(fen));
+        Board const &board = *boards.back();
+        uint64_t occupied =
+            board.getPositions(Side::W) | board.getPositions(Side::B);
+        for (Side side : {Side::W, Side::B}) {
+            SliderSet sliders{board.getPositions(Piece::Type::R, side),
+                              board.getPositions(Piece::Type::B, side),
+                              board.getPositions(Piece::Type::Q, side),
+                              occupied};
+            if (perPieceAttacks(board, sliders) != setWiseAttacks(sliders)) {
+                std::cerr << "Mismatch on " << fen << '\n';
+                return 1;
+            }
+            sliderSets.push_back(sliders);
+        }
+    }
+
+    volatile uint64_t sink = 0;
+    Board const &board = *boards.front();
+    double perPiece = timeIterations(iterations, [&] {
+        for (auto const &sliders : sliderSets) {
+            sink = sink + perPieceAttacks(board, sliders);
+        }
+    });
+    double setWise = timeIterations(iterations, [&] {
+        for (auto const &sliders : sliderSets) {
+            sink = sink + setWiseAttacks(sliders);
+        }
+    });
+
+    double calls = static_cast<double>(iterations) * sliderSets.size();
+    std::cout << "Per piece loop: " << perPiece * 1e9 / calls << " ns/side\n"
+              << MoveGeneration::slidingAttacksImplementation() << ": "
+              << setWise * 1e9 / calls << " ns/side\n"
+              << "Speedup: " << perPiece / setWise << "x\n";
+    return 0;
+}
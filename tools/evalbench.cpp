@@ -0,0 +1,97 @@
+#include "../src/batchEvaluation.h"
+#include "../src/moveGenerator.h"
+#include "../src/packedPosition.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace AdiChess;
+
+namespace {
+
+template <typename F> double timeIterations(int iterations, F const &f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        f();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+
+// Positions along seeded random games from the start position
+std::vector<PackedPosition> randomPositions(size_t count) {
+    std::vector<PackedPosition> positions;
+    std::mt19937_64 random(0);
+    while (positions.size() < count) {
+        Board board;
+        for (int ply = 0; ply < 120 && positions.size() < count; ++ply) {
+            std::vector<Move> moves;
+            MoveGeneration::MoveGenerator moveGenerator(board);
+            for (auto const &move : moveGenerator) {
+                if (board.legalMove(move)) {
+                    moves.push_back(move);
+                }
+            }
+            if (moves.empty()) {
+                break;
+            }
+            board.makeMove(moves[random() % moves.size()]);
+            positions.push_back(pack(board));
+        }
+    }
+    return positions;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 100000;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 10;
+
+    std::vector<PackedPosition> positions = randomPositions(count);
+    Board board;
+    Evaluation::PositionBatch batch;
+    std::vector<int> expected;
+    for (auto const &position : positions) {
+        unpack(position, board);
+        batch.add(board);
+        expected.push_back(Evaluation::evaluate(board));
+    }
+    if (Evaluation::evaluate(batch) != expected) {
+        std::cerr << "Batch scores differ from evaluate\n";
+        return 1;
+    }
+
+    // Boards cache their attack maps, so every position is unpacked afresh
+    // and the unpacking is timed on its own to be subtracted
+    volatile int sink = 0;
+    double unpacking = timeIterations(iterations, [&] {
+        for (auto const &position : positions) {
+            unpack(position, board);
+            sink = sink + board.getCurrentPlayer();
+        }
+    });
+    double looped = timeIterations(iterations, [&] {
+        for (auto const &position : positions) {
+            unpack(position, board);
+            sink = sink + Evaluation::evaluate(board);
+        }
+    });
+    std::vector<int> scores(batch.size());
+    double batched = timeIterations(iterations, [&] {
+        Evaluation::evaluate(batch, scores.data());
+        sink = sink + scores.back();
+    });
+
+    double calls = static_cast<double>(iterations) * positions.size();
+    double perPosition = (looped - unpacking) * 1e9 / calls;
+    double perBatched = batched * 1e9 / calls;
+    std::cout << "Positions: " << positions.size() << "\nevaluate loop: "
+              << perPosition << " ns/position\n"
+              << Evaluation::batchEvaluationImplementation() << ": "
+              << perBatched << " ns/position\nSpeedup: "
+              << perPosition / perBatched << "x\n";
+    return 0;
+}
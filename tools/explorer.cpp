@@ -0,0 +1,83 @@
+#include "../src/openingExplorer.h"
+#include "../src/perft.h"
+#include "../src/uci.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace AdiChess;
+
+namespace {
+
+void usage() {
+    std::cerr << "Usage: explorer build <pgn> <index> [threads] [max plies]\n"
+                 "       explorer query <index> startpos|fen <fen> "
+                 "[moves <moves>]\n";
+}
+
+int build(int argc, char *argv[]) {
+    Explorer::BuildOptions options;
+    options.threads = argc > 4 ? std::stoi(argv[4])
+                               : std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 5) {
+        options.maxPlies = std::stoi(argv[5]);
+    }
+    auto stats = Explorer::build(argv[2], argv[3], options);
+    std::cout << "Games: " << stats.games << "\n"
+              << "Skipped: " << stats.skipped << "\n"
+              << "Entries: " << stats.entries << "\n"
+              << "Seconds: " << stats.seconds << "\n"
+              << "Games/s: " << static_cast<uint64_t>(stats.gamesPerSecond())
+              << std::endl;
+    return 0;
+}
+
+int query(int argc, char *argv[]) {
+    Explorer::Index index(argv[2]);
+    if (!index.isOpen()) {
+        std::cerr << "Cannot open " << argv[2] << "\n";
+        return 1;
+    }
+    std::string position;
+    for (int i = 3; i < argc; ++i) {
+        position += std::string(i > 3 ? " " : "") + argv[i];
+    }
+    std::istringstream arguments(position);
+    auto board = UCI::parsePosition(arguments);
+    if (!board) {
+        std::cerr << "Invalid position\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto moves = index.lookup(*board);
+    auto microseconds = std::chrono::duration<double, std::micro>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    const Side side = board->getCurrentPlayer();
+    for (auto const &stats : moves) {
+        std::cout << std::setw(6) << moveToString(stats.move, side)
+                  << std::setw(10) << stats.games() << std::setw(8)
+                  << std::fixed << std::setprecision(1)
+                  << 100 * stats.score(side) << "%\n";
+    }
+    std::cout << "Lookup: " << microseconds << " us" << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "build" && argc > 3) {
+        return build(argc, argv);
+    }
+    if (command == "query" && argc > 3) {
+        return query(argc, argv);
+    }
+    usage();
+    return 1;
+}
@@ -0,0 +1,120 @@
+#include "../src/mateSearch.h"
+#include "../src/perft.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace AdiChess;
+
+namespace {
+
+struct Puzzle {
+    const char *fen;
+    // Attacker moves the mate is looked for in
+    int moves;
+};
+
+const Puzzle PUZZLES[] = {
+    {"6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1", 1},
+    {"r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 1", 2},
+    {"r1b3kr/ppp1Bp1p/1b6/n2P4/2p3q1/2Q2N2/P4PPP/RN2R1K1 w - - 1 1", 3},
+    {"5r1k/6pp/8/4N3/2Q5/8/8/6K1 w - - 0 1", 4},
+    {"r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4", 1},
+    {"2r3k1/p4p2/3Rp2p/1p2P1pK/8/1P4P1/P3Q2P/1q6 b - - 0 1", 3},
+    {"r5rk/5p1p/5R2/4B3/8/8/7P/7K w - - 0 1", 3},
+    {"6k1/8/8/8/8/8/8/QR4K1 w - - 0 1", 8},
+    {"4k3/8/8/8/8/8/8/QR4K1 w - - 0 1", 8},
+};
+
+int64_t microsecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+void usage() {
+    std::cerr << "Usage: matebench [time limit ms]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc > 2) {
+        usage();
+        return 1;
+    }
+    SearchLimits limits;
+    limits.time = argc > 1 ? std::stoll(argv[1]) : 10000;
+
+    std::cout << std::left << std::setw(4) << "#" << std::right
+              << std::setw(8) << "df-pn" << std::setw(12) << "us"
+              << std::setw(12) << "nodes" << std::setw(8) << "Search"
+              << std::setw(12) << "us" << std::setw(12) << "nodes"
+              << "  Line\n";
+    int64_t totals[2] = {0, 0};
+    int found[2] = {0, 0};
+    int index = 0;
+    for (auto const &puzzle : PUZZLES) {
+        ++index;
+        Board board(puzzle.fen);
+        const Side side = board.getCurrentPlayer();
+
+        Mate::Table mateTable;
+        Mate::Solver solver(board, mateTable);
+        auto start = std::chrono::steady_clock::now();
+        auto result = solver.solve(puzzle.moves, limits);
+        const int64_t solverTime = microsecondsSince(start);
+
+        // Iterative deepening until the first iteration that reports a mate
+        TranspositionTable table;
+        Search search(board);
+        search.setTranspositionTable(&table);
+        SearchLimits searchLimits = limits;
+        // The mated side's node needs a ply of its own to see it has no moves
+        searchLimits.depth = 2 * puzzle.moves;
+        int searchMate = 0;
+        int64_t searchTime = 0;
+        uint64_t searchNodes = 0;
+        start = std::chrono::steady_clock::now();
+        search.search(searchLimits, [&](SearchInfo const &info) {
+            if (!searchMate && info.score > MATE_BOUND) {
+                searchMate = (MATE_SCORE - info.score + 1) / 2;
+                searchTime = microsecondsSince(start);
+                searchNodes = info.nodes;
+                search.stop();
+            }
+        });
+
+        std::cout << std::left << std::setw(4) << index << std::right
+                  << std::setw(8);
+        if (result.moves) {
+            ++found[0];
+            totals[0] += solverTime;
+            std::cout << result.moves << std::setw(12) << solverTime;
+        } else {
+            std::cout << "-" << std::setw(12) << "-";
+        }
+        std::cout << std::setw(12) << result.nodes << std::setw(8);
+        if (searchMate) {
+            ++found[1];
+            totals[1] += searchTime;
+            std::cout << searchMate << std::setw(12) << searchTime
+                      << std::setw(12) << searchNodes;
+        } else {
+            std::cout << "-" << std::setw(12) << "-" << std::setw(12)
+                      << search.getNodes();
+        }
+        std::cout << " ";
+        Side mover = side;
+        for (auto const &move : result.principalVariation) {
+            std::cout << " " << moveToString(move, mover);
+            mover = ~mover;
+        }
+        std::cout << "\n";
+    }
+    std::cout << "df-pn: " << found[0] << " mates in " << totals[0] << " us\n"
+              << "Search: " << found[1] << " mates in " << totals[1] << " us"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "../src/bench.h"
+#include "../src/mcts.h"
+#include "../src/perft.h"
+
+#include <iomanip>
+#include <iostream>
+
+using namespace AdiChess;
+
+namespace {
+
+// Depth of the searches that score the chosen moves
+constexpr int REFERENCE_DEPTH = 6;
+
+// Score of the position after move for the side playing it
+int referenceScore(Board &board, Move move) {
+    TranspositionTable table;
+    board.makeMove(move);
+    Search search(board);
+    search.setTranspositionTable(&table);
+    SearchLimits limits;
+    limits.depth = REFERENCE_DEPTH - 1;
+    const int score = -search.search(limits);
+    board.unmakeMove(move);
+    return score;
+}
+
+void usage() {
+    std::cerr << "Usage: mctsbench [time per move ms] [threads] "
+                 "[rollout depth]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc > 4) {
+        usage();
+        return 1;
+    }
+    SearchLimits limits;
+    limits.time = argc > 1 ? std::stoll(argv[1]) : 1000;
+    Mcts::Options options;
+    options.threads = argc > 2 ? std::stoi(argv[2]) : 1;
+    options.rolloutDepth = argc > 3 ? std::stoi(argv[3]) : 0;
+
+    std::cout << std::left << std::setw(4) << "#" << std::setw(8) << "Best"
+              << std::setw(8) << "Search" << std::right << std::setw(8)
+              << "loss" << std::setw(12) << "nodes" << "  " << std::left
+              << std::setw(8) << "MCTS" << std::right << std::setw(8)
+              << "loss" << std::setw(12) << "playouts" << "\n";
+    int agreements[2] = {0, 0};
+    int64_t losses[2] = {0, 0};
+    int index = 0;
+    for (auto fen : Bench::positions()) {
+        ++index;
+        Board board(fen);
+        const Side side = board.getCurrentPlayer();
+
+        TranspositionTable table;
+        Search reference(board);
+        reference.setTranspositionTable(&table);
+        SearchLimits referenceLimits;
+        referenceLimits.depth = REFERENCE_DEPTH;
+        const int best = reference.search(referenceLimits);
+        const Move bestMove = reference.getPrincipalMove();
+
+        table.clear();
+        Search search(board);
+        search.setTranspositionTable(&table);
+        search.search(limits);
+        const Move searchMove = search.getPrincipalMove();
+
+        Mcts::Searcher mcts(board, options);
+        mcts.search(limits);
+        const Move mctsMove = mcts.getPrincipalMove();
+
+        const Move moves[2] = {searchMove, mctsMove};
+        int loss[2];
+        for (int i = 0; i < 2; ++i) {
+            const bool agrees = moves[i] == bestMove;
+            agreements[i] += agrees;
+            loss[i] = agrees ? 0
+                             : std::max(best - referenceScore(board, moves[i]),
+                                        0);
+            losses[i] += loss[i];
+        }
+
+        std::cout << std::left << std::setw(4) << index << std::setw(8)
+                  << moveToString(bestMove, side) << std::setw(8)
+                  << moveToString(searchMove, side) << std::right
+                  << std::setw(8) << loss[0] << std::setw(12)
+                  << search.getNodes() << "  " << std::left << std::setw(8)
+                  << moveToString(mctsMove, side) << std::right << std::setw(8)
+                  << loss[1] << std::setw(12) << mcts.getNodes() << "\n";
+    }
+    std::cout << "Search: " << agreements[0] << "/" << index
+              << " best moves, " << losses[0] << " cp lost\n"
+              << "MCTS: " << agreements[1] << "/" << index << " best moves, "
+              << losses[1] << " cp lost" << std::endl;
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "../src/perfCounters.h"
+#include "../src/perft.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+
+using namespace AdiChess;
+
+namespace {
+
+struct PerftPosition {
+    const char *name;
+    const char *fen;
+    // Expected leaf counts indexed by depth - 1
+    std::vector<uint64_t> nodes;
+};
+
+// Reference positions from https://www.chessprogramming.org/Perft_Results
+const std::vector<PerftPosition> suite = {
+    {"Start position",
+     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     {20, 400, 8902, 197281, 4865609, 119060324}},
+    {"Kiwipete",
+     "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+     {48, 2039, 97862, 4085603, 193690690, 8031647685}},
+    {"Position 3",
+     "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+     {14, 191, 2812, 43238, 674624, 11030083, 178633661}},
+    {"Position 4",
+     "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+     {6, 264, 9467, 422333, 15833292, 706045033}},
+    {"Position 5",
+     "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+     {44, 1486, 62379, 2103487, 89941194, 3048196529}},
+    {"Position 6",
+     "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+     {46, 2079, 89890, 3894594, 164075551, 6923051137}},
+};
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(uint64_t nodes, double seconds) {
+    std::cout << "Nodes: " << nodes << "\nTime: " << seconds
+              << "s\nNodes/s: "
+              << static_cast<uint64_t>(seconds > 0 ? nodes / seconds : 0)
+              << '\n';
+    Profile::report(std::cout);
+}
+
+// Either model, Board making and unmaking moves or Position copy-make
+template <typename Model>
+int runPosition(std::string const &fen, int depth, bool showDivide) {
+    Model model(fen);
+    const Side side = model.getCurrentPlayer();
+    auto start = Clock::now();
+    uint64_t nodes = 0;
+
+    if (showDivide) {
+        for (auto const &entry : divide(model, depth)) {
+            std::cout << moveToString(entry.first, side) << ": "
+                      << entry.second << '\n';
+            nodes += entry.second;
+        }
+        std::cout << '\n';
+    } else {
+        nodes = perft(model, depth);
+    }
+
+    report(nodes, secondsSince(start));
+    return 0;
+}
+
+template <typename Model> int runSuite(int maxDepth) {
+    int failures = 0;
+    uint64_t totalNodes = 0;
+    auto start = Clock::now();
+
+    for (auto const &position : suite) {
+        Model model(position.fen);
+        int depthLimit = std::min<int>(maxDepth, position.nodes.size());
+        for (int depth = 1; depth <= depthLimit; ++depth) {
+            uint64_t nodes = perft(model, depth);
+            uint64_t expected = position.nodes[depth - 1];
+            bool ok = nodes == expected;
+            failures += !ok;
+            totalNodes += nodes;
+            std::cout << position.name << " depth " << depth << ": " << nodes
+                      << (ok ? "" : " FAILED, expected " +
+                                        std::to_string(expected))
+                      << '\n';
+        }
+    }
+
+    std::cout << '\n';
+    report(totalNodes, secondsSince(start));
+    std::cout << "Failures: " << failures << '\n';
+    return failures ? 1 : 0;
+}
+
+// Times both models over the suite at one depth
+int runCompare(int depth) {
+    double seconds[2] = {0, 0};
+    uint64_t totalNodes = 0;
+    for (auto const &position : suite) {
+        Board board(position.fen);
+        auto start = Clock::now();
+        uint64_t nodes = perft(board, depth);
+        seconds[0] += secondsSince(start);
+
+        Position copy(board);
+        start = Clock::now();
+        if (perft(copy, depth) != nodes) {
+            std::cout << position.name << ": node counts differ\n";
+            return 1;
+        }
+        seconds[1] += secondsSince(start);
+        totalNodes += nodes;
+    }
+
+    const char *names[] = {"Make/unmake", "Copy-make"};
+    for (int model = 0; model < 2; ++model) {
+        std::cout << names[model] << ": " << seconds[model] << "s, "
+                  << static_cast<uint64_t>(totalNodes / seconds[model])
+                  << " nodes/s\n";
+    }
+    std::cout << "Nodes: " << totalNodes << "\nSpeedup: "
+              << seconds[0] / seconds[1] << "x\n";
+    Profile::report(std::cout);
+    return 0;
+}
+
+void usage() {
+    std::cerr << "Usage: perft \"<fen>\" <depth> [divide] [copymake]\n"
+                 "       perft suite [max depth] [copymake]\n"
+                 "       perft compare [depth]\n";
+}
+
+bool hasOption(int argc, char *argv[], int first, std::string const &option) {
+    for (int i = first; i < argc; ++i) {
+        if (argv[i] == option) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    // Counted per region when built with USE_PERF_COUNTERS
+    Profile::enable();
+    std::string command = argv[1];
+    if (command == "compare") {
+        return runCompare(argc > 2 ? std::stoi(argv[2]) : 5);
+    }
+    if (command == "suite") {
+        int maxDepth = argc > 2 && std::isdigit(argv[2][0]) ? std::stoi(argv[2])
+                                                            : 7;
+        return hasOption(argc, argv, 2, "copymake") ? runSuite<Position>(maxDepth)
+                                                    : runSuite<Board>(maxDepth);
+    }
+
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+
+    int depth = std::stoi(argv[2]);
+    bool showDivide = hasOption(argc, argv, 3, "divide");
+    return hasOption(argc, argv, 3, "copymake")
+               ? runPosition<Position>(command, depth, showDivide)
+               : runPosition<Board>(command, depth, showDivide);
+}
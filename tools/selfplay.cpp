@@ -0,0 +1,45 @@
+#include "../src/selfPlay.h"
+
+#include <iostream>
+#include <thread>
+
+using namespace AdiChess;
+
+namespace {
+
+void usage() {
+    std::cerr << "Usage: selfplay <output> [games] [threads] [depth] [nodes] "
+                 "[random plies] [seed]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    SelfPlay::Options options;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 2)
+        options.games = std::stoi(argv[2]);
+    if (argc > 3)
+        options.threads = std::stoi(argv[3]);
+    if (argc > 4)
+        options.depth = std::stoi(argv[4]);
+    if (argc > 5)
+        options.nodes = std::stoull(argv[5]);
+    if (argc > 6)
+        options.randomPlies = std::stoi(argv[6]);
+    if (argc > 7)
+        options.seed = std::stoull(argv[7]);
+
+    auto stats = SelfPlay::run(argv[1], options);
+    std::cout << "Games: " << stats.games << "\nPositions: " << stats.positions
+              << "\nTime: " << stats.seconds << "s\nPositions/s: "
+              << static_cast<uint64_t>(
+                     stats.seconds > 0 ? stats.positions / stats.seconds : 0)
+              << '\n';
+    return 0;
+}
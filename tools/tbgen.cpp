@@ -0,0 +1,54 @@
+#include "../src/tablebase.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace AdiChess;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void usage() {
+    std::cerr << "Usage: tbgen <directory> [threads] [max pieces]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    std::string directory = argv[1];
+    int threads = argc > 2 ? std::stoi(argv[2])
+                           : std::max(1u, std::thread::hardware_concurrency());
+    int maxPieces = argc > 3 ? std::stoi(argv[3]) : 4;
+
+    // Tables already in the directory are reused for their dependants
+    Tablebase::Tablebases tablebases(directory);
+    auto start = Clock::now();
+
+    for (auto const &signature : Tablebase::allSignatures(maxPieces)) {
+        if (tablebases.contains(signature)) {
+            std::cout << signature << ": found\n";
+            continue;
+        }
+        auto tableStart = Clock::now();
+        if (!tablebases.generate(directory, signature, threads)) {
+            std::cerr << signature << ": generation failed\n";
+            return 1;
+        }
+        std::cout << signature << ": " << secondsSince(tableStart) << "s\n";
+    }
+
+    std::cout << "Tables: " << tablebases.size()
+              << "\nTime: " << secondsSince(start) << "s\n";
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "../src/search.h"
+#include "../src/searchTrace.h"
+#include "../src/uci.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+using namespace AdiChess;
+
+namespace {
+
+void usage() {
+    std::cerr << "Usage: trace record <file> <depth> startpos|fen <fen> "
+                 "[moves <moves>]\n"
+                 "       trace summary <file> [heaviest]\n";
+}
+
+int record(int argc, char *argv[]) {
+    std::string position;
+    for (int i = 4; i < argc; ++i) {
+        position += std::string(i > 4 ? " " : "") + argv[i];
+    }
+    std::istringstream arguments(position);
+    auto board = UCI::parsePosition(arguments);
+    if (!board) {
+        std::cerr << "Invalid position\n";
+        return 1;
+    }
+    Trace::Recorder recorder(argv[2]);
+    if (!recorder.isOpen()) {
+        std::cerr << "Cannot open " << argv[2] << "\n";
+        return 1;
+    }
+
+    TranspositionTable table;
+    Search search(*board);
+    search.setTranspositionTable(&table);
+    search.setTrace(&recorder);
+    SearchLimits limits;
+    limits.depth = std::stoi(argv[3]);
+    auto start = std::chrono::steady_clock::now();
+    int score = search.search(limits);
+    recorder.flush();
+    auto seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    std::cout << "Score: " << score << "\n"
+              << "Nodes: " << search.getNodes() << "\n"
+              << "Seconds: " << seconds << std::endl;
+    return 0;
+}
+
+int summary(int argc, char *argv[]) {
+    std::vector<Trace::Record> records;
+    if (!Trace::read(argv[2], records)) {
+        std::cerr << "Cannot read " << argv[2] << "\n";
+        return 1;
+    }
+    const size_t heaviest = argc > 3 ? std::stoul(argv[3]) : 10;
+    std::cout << "Records: " << records.size() << "\n\n";
+    Trace::report(Trace::summarise(records, heaviest), std::cout);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "record" && argc > 4) {
+        return record(argc, argv);
+    }
+    if (command == "summary" && argc > 2) {
+        return summary(argc, argv);
+    }
+    usage();
+    return 1;
+}
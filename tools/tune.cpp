@@ -0,0 +1,67 @@
+#include "../src/tuner.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace AdiChess;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void usage() {
+    std::cerr << "Usage: tune <positions> [epochs] [threads] [header] "
+                 "[learning rate]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    Tuning::Options options;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 2)
+        options.epochs = std::stoi(argv[2]);
+    if (argc > 3)
+        options.threads = std::stoi(argv[3]);
+    std::string header = argc > 4 ? argv[4] : "evaluationParameters.h";
+    if (argc > 5)
+        options.learningRate = std::stod(argv[5]);
+
+    auto start = Clock::now();
+    Tuning::Dataset dataset = Tuning::loadDataset(argv[1]);
+    std::cout << "Positions: " << dataset.size() << "\nLoad time: "
+              << secondsSince(start) << "s\n";
+    if (dataset.size() == 0) {
+        return 1;
+    }
+
+    Tuning::Parameters parameters = Tuning::currentParameters();
+    double k = Tuning::fitScale(dataset, parameters, options.threads);
+    std::cout << "K: " << k << "\nInitial loss: "
+              << Tuning::loss(dataset, parameters, k, options.threads) << '\n';
+
+    auto epochStart = Clock::now();
+    parameters = Tuning::tune(
+        dataset, parameters, k, options, [&](int epoch, double loss) {
+            std::cout << "Epoch " << epoch + 1 << ": loss " << loss << " ("
+                      << secondsSince(epochStart) << "s)\n";
+            epochStart = Clock::now();
+        });
+
+    if (!Tuning::writeHeader(header, parameters)) {
+        std::cerr << "Failed to write " << header << '\n';
+        return 1;
+    }
+    std::cout << "Written " << header << '\n';
+    return 0;
+}